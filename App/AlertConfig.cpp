@@ -0,0 +1,102 @@
+//
+//    AlertConfig.cpp: Band alert rules
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+
+#include "AlertConfig.h"
+
+using namespace SigDigger;
+
+AlertConfig::AlertConfig()
+{
+}
+
+AlertConfig::AlertConfig(Suscan::Object const &conf) : AlertConfig()
+{
+  this->deserialize(conf);
+}
+
+void
+AlertConfig::deserialize(Suscan::Object const &conf)
+{
+  this->rules.clear();
+
+  this->enabled = conf.get("enabled", this->enabled);
+  this->logPath = conf.get("logPath", this->logPath);
+  this->notify  = conf.get("notify", this->notify);
+  this->holdoff = conf.get("holdoff", this->holdoff);
+
+  try {
+    Suscan::Object set = conf.getField("rules");
+
+    for (unsigned int i = 0; i < set.length(); ++i) {
+      try {
+        Suscan::Object entry = set[i];
+        AlertRule rule;
+
+        rule.name      = entry.get("name", std::string());
+        rule.freq      = std::stoll(entry.get("freq", std::string("0")));
+        rule.bandwidth = std::stoll(entry.get("bandwidth", std::string("0")));
+        rule.threshold = entry.get("threshold", rule.threshold);
+        rule.relative  = entry.get("relative", rule.relative);
+        rule.duration  = entry.get("duration", rule.duration);
+        rule.record    = entry.get("record", rule.record);
+
+        if (rule.bandwidth > 0
+            && this->rules.size() < SIGDIGGER_ALERT_MAX_RULES)
+          this->rules.push_back(rule);
+      } catch (std::exception &) {
+      }
+    }
+  } catch (Suscan::Exception &) {
+    // No rules saved
+  }
+}
+
+Suscan::Object &&
+AlertConfig::serialize(void)
+{
+  Suscan::Object obj(SUSCAN_OBJECT_TYPE_OBJECT);
+  Suscan::Object set(SUSCAN_OBJECT_TYPE_SET);
+
+  obj.setClass("AlertConfig");
+
+  obj.set("enabled", this->enabled);
+  obj.set("logPath", this->logPath);
+  obj.set("notify", this->notify);
+  obj.set("holdoff", this->holdoff);
+
+  for (auto &rule : this->rules) {
+    Suscan::Object entry(SUSCAN_OBJECT_TYPE_OBJECT);
+
+    entry.setClass("AlertRule");
+    entry.set("name", rule.name);
+    entry.set("freq", std::to_string(rule.freq));
+    entry.set("bandwidth", std::to_string(rule.bandwidth));
+    entry.set("threshold", rule.threshold);
+    entry.set("relative", rule.relative);
+    entry.set("duration", rule.duration);
+    entry.set("record", rule.record);
+
+    set.append(entry);
+  }
+
+  obj.setField("rules", set);
+
+  return this->persist(obj);
+}
@@ -47,6 +47,8 @@ AppConfig::serialize(void)
   obj.setField("source", profileObj);
   obj.setField("analyzerParams", this->analyzerParams.serialize());
   obj.setField("colors", this->colors.serialize());
+  obj.setField("bandMeters", this->bandMeters.serialize());
+  obj.setField("alerts", this->alerts.serialize());
   obj.setField("sourcePanel", this->sourceConfig->serialize());
   obj.setField("fftPanel", this->fftConfig->serialize());
   obj.setField("audioPanel", this->audioConfig->serialize());
@@ -74,6 +76,8 @@ AppConfig::deserialize(Suscan::Object const &conf)
     TRYSILENT(this->profile = Suscan::Source::Config(conf.getField("source")));
     TRYSILENT(this->analyzerParams.deserialize(conf.getField("analyzerParams")));
     TRYSILENT(this->colors.deserialize(conf.getField("colors")));
+    TRYSILENT(this->bandMeters.deserialize(conf.getField("bandMeters")));
+    TRYSILENT(this->alerts.deserialize(conf.getField("alerts")));
     TRYSILENT(this->sourceConfig->deserialize(conf.getField("sourcePanel")));
     TRYSILENT(this->fftConfig->deserialize(conf.getField("fftPanel")));
     TRYSILENT(this->audioConfig->deserialize(conf.getField("audioPanel")));
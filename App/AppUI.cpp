@@ -34,6 +34,13 @@ AppUI::AppUI(QMainWindow *owner)
   this->audioPanel = new AudioPanel(owner);
   this->aboutDialog = new AboutDialog(owner);
   this->deviceDialog = new DeviceDialog(owner);
+  this->historyDialog = new WaterfallHistoryDialog(owner);
+  this->peakDialog = new PeakTrackerDialog(owner);
+  this->bandMeterDialog = new BandMeterDialog(owner);
+  this->occupancyDialog = new OccupancyDialog(owner);
+  this->referenceDialog = new ReferenceDialog(owner);
+  this->alertDialog = new AlertDialog(owner);
+  this->bookmarkDialog = new BookmarkDialog(owner);
 }
 
 void
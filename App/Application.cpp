@@ -19,6 +19,8 @@
 
 #include <Suscan/Library.h>
 #include <fcntl.h>
+#include <cstdlib>
+#include <iostream>
 
 #include "Application.h"
 
@@ -51,6 +53,9 @@ Application::Application(QWidget *parent) : QMainWindow(parent), ui(this)
   this->deviceDetectWorker = new DeviceDetectWorker();
   this->deviceDetectWorker->moveToThread(this->deviceDetectThread);
   this->deviceDetectThread->start();
+
+  this->audioHealthTimer = new QTimer(this);
+  this->audioHealthTimer->setInterval(SIGDIGGER_AUDIO_HEALTH_INTERVAL_MS);
 }
 
 Suscan::Object &&
@@ -65,6 +70,21 @@ Application::refreshConfig(void)
   this->mediator->saveGeometry();
 }
 
+//
+// The warm-up may still be measuring. It is stopped first, so the file
+// is not written by two threads at once.
+//
+void
+Application::saveWisdom(void)
+{
+  this->wisdom.stop();
+
+  if (!FftwWisdom::save())
+    std::cerr << "Cannot save FFTW wisdom to "
+              << FftwWisdom::getPath().toStdString()
+              << std::endl;
+}
+
 void
 Application::updateRecent(void)
 {
@@ -89,6 +109,8 @@ Application::run(Suscan::Object const &config)
   this->updateRecent();
 
   this->show();
+
+  this->wisdom.warmUp(this->mediator->getFftSizes());
 }
 
 FileDataSaver *
@@ -161,6 +183,60 @@ Application::installDataSaver(int fd)
   }
 }
 
+void
+Application::connectAudioSaver(void)
+{
+  this->connect(
+        this->audioSaver.get(),
+        SIGNAL(stopped()),
+        this,
+        SLOT(onAudioSaveError()));
+
+  this->connect(
+        this->audioSaver.get(),
+        SIGNAL(swamped()),
+        this,
+        SLOT(onAudioSaveSwamped()));
+
+  this->connect(
+        this->audioSaver.get(),
+        SIGNAL(dataRate(qreal)),
+        this,
+        SLOT(onAudioSaveRate(qreal)));
+
+  this->connect(
+        this->audioSaver.get(),
+        SIGNAL(commit()),
+        this,
+        SLOT(onAudioCommit()));
+}
+
+void
+Application::installAudioSaver(void)
+{
+  if (this->audioSaver.get() == nullptr && this->playBack != nullptr) {
+    SUFREQ freq =
+        this->mediator->getProfile()->getFreq() + this->getAudioInspectorLo();
+    std::string prefix =
+        AudioPanel::demodToStr(this->ui.audioPanel->getDemod())
+        + "-"
+        + std::to_string(static_cast<qint64>(freq));
+
+    this->audioSaver = std::make_unique<AudioFileSaver>(
+          this->ui.audioPanel->getRecordSavePath(),
+          prefix,
+          this->audioSampleRate,
+          this);
+    this->connectAudioSaver();
+  }
+}
+
+void
+Application::uninstallAudioSaver(void)
+{
+  this->audioSaver = nullptr;
+}
+
 void
 Application::setAudioInspectorParams(
     unsigned int rate,
@@ -168,14 +244,22 @@ Application::setAudioInspectorParams(
     SUFLOAT volume,
     unsigned int demod)
 {
+  // Gain is applied by the output stage, right before clipping. This way
+  // volume changes do not need a round trip to the analyzer.
+  if (this->playBack != nullptr)
+    this->playBack->setVolume(volume / 20);
+
   if (this->audioConfigured) {
     Suscan::Config cfg(this->audioCfgTemplate);
     cfg.set("audio.cutoff", cutOff);
-    cfg.set("audio.volume", volume / 20);
+    cfg.set("audio.volume", static_cast<SUFLOAT>(1));
     cfg.set("audio.sample-rate", static_cast<uint64_t>(rate));
     cfg.set("audio.demodulator", static_cast<uint64_t>(demod));
     this->analyzer->setInspectorConfig(this->audioInspHandle, cfg, 0);
     this->assertAudioInspectorLo();
+
+    for (unsigned int i = 0; i < this->audioChannels.size(); ++i)
+      this->configureAudioChannel(i);
   } else {
     this->delayedRate    = rate;
     this->delayedCutOff  = cutOff;
@@ -194,11 +278,18 @@ Application::openAudio(unsigned int rate)
       try {
         Suscan::Channel ch;
         SUFREQ bw = SIGDIGGER_AUDIO_INSPECTOR_BANDWIDTH;
+        std::string dev = this->ui.audioPanel->getDevice();
+        const char *envDev = getenv("SIGDIGGER_AUDIO_DEVICE");
+
+        // Environment takes precedence, so headless boxes can redirect
+        // audio to a file sink without touching the saved config.
+        if (envDev != nullptr && *envDev != '\0')
+          dev = envDev;
 
         if (rate > bw)
           rate = static_cast<unsigned int>(floor(bw));
 
-        this->playBack = std::make_unique<AudioPlayback>("default", rate);
+        this->playBack = std::make_unique<AudioPlayback>(dev, rate);
         this->audioSampleRate = this->playBack->getSampleRate();
         this->lastAudioLo = this->getAudioInspectorLo();
 
@@ -218,12 +309,20 @@ Application::openAudio(unsigned int rate)
               ch,
               SIGDIGGER_AUDIO_INSPECTOR_REQID);
 
+        this->openAudioChannels();
+        this->updateAudioMix();
+
         this->setAudioInspectorParams(
               this->audioSampleRate,
               this->ui.audioPanel->getCutOff(),
               this->ui.audioPanel->getVolume(),
               this->ui.audioPanel->getDemod() + 1);
         opened = true;
+
+        if (this->ui.audioPanel->getRecordState())
+          this->installAudioSaver();
+
+        this->audioHealthTimer->start();
       } catch (Suscan::Exception const &e) {
         QMessageBox::critical(
                   this,
@@ -246,19 +345,265 @@ Application::openAudio(unsigned int rate)
   return opened;
 }
 
+void
+Application::openAudioChannels(void)
+{
+  auto const &channels = this->ui.audioPanel->getChannels();
+  SUFREQ center = this->mediator->getProfile()->getFreq();
+
+  this->audioChannels.clear();
+  this->audioChannels.resize(channels.size());
+  this->audioChannelGeneration =
+      (this->audioChannelGeneration + 1) % SIGDIGGER_AUDIO_CHANNEL_GENERATIONS;
+
+  for (unsigned int i = 0; i < channels.size(); ++i) {
+    Suscan::Channel ch;
+
+    ch.bw    = this->maxAudioBw;
+    ch.ft    = 0;
+    ch.fc    = static_cast<SUFREQ>(channels[i].freq) - center;
+    ch.fLow  = -.5 * ch.bw;
+    ch.fHigh = .5 * ch.bw;
+
+    this->analyzer->openPrecise(
+          "audio",
+          ch,
+          SIGDIGGER_AUDIO_CHANNEL_REQID(this->audioChannelGeneration, i + 1));
+  }
+}
+
+void
+Application::closeAudioChannels(void)
+{
+  if (this->mediator->getState() == UIMediator::RUNNING)
+    for (auto &ch : this->audioChannels)
+      if (ch.opened)
+        this->analyzer->closeInspector(ch.handle, 0);
+
+  // Inspectors whose open reply has not arrived yet are closed as soon
+  // as it does: the next open bumps the generation, and replies to
+  // requests of an older one are dropped by audioChannelOpened().
+  this->audioChannels.clear();
+}
+
+void
+Application::reopenAudioChannels(void)
+{
+  if (this->playBack != nullptr
+      && this->mediator->getState() == UIMediator::RUNNING) {
+    this->closeAudioChannels();
+    this->openAudioChannels();
+    this->updateAudioMix();
+  }
+}
+
+void
+Application::configureAudioChannel(unsigned int index)
+{
+  auto const &channels = this->ui.audioPanel->getChannels();
+
+  if (index < this->audioChannels.size()
+      && index < channels.size()
+      && this->audioChannels[index].opened
+      && this->audioCfgTemplate != nullptr) {
+    Suscan::Config cfg(this->audioCfgTemplate);
+    cfg.set("audio.cutoff", this->ui.audioPanel->getCutOff());
+    cfg.set("audio.volume", static_cast<SUFLOAT>(1));
+    cfg.set("audio.sample-rate", static_cast<uint64_t>(this->audioSampleRate));
+    cfg.set("audio.demodulator", static_cast<uint64_t>(channels[index].demod + 1));
+    this->analyzer->setInspectorConfig(this->audioChannels[index].handle, cfg, 0);
+  }
+}
+
+void
+Application::assertAudioChannelsLo(void)
+{
+  auto const &channels = this->ui.audioPanel->getChannels();
+  SUFREQ center = this->mediator->getProfile()->getFreq();
+
+  for (unsigned int i = 0; i < this->audioChannels.size(); ++i)
+    if (this->audioChannels[i].opened && i < channels.size())
+      this->analyzer->setInspectorFreq(
+            this->audioChannels[i].handle,
+            static_cast<SUFREQ>(channels[i].freq) - center,
+            0);
+}
+
+void
+Application::updateAudioMix(void)
+{
+  auto const &channels = this->ui.audioPanel->getChannels();
+
+  if (this->playBack != nullptr) {
+    this->playBack->setChannelCount(
+          static_cast<unsigned int>(this->audioChannels.size() + 1));
+
+    this->playBack->setChannelMix(0, 1, 0);
+
+    for (unsigned int i = 0; i < this->audioChannels.size(); ++i)
+      if (i < channels.size())
+        this->playBack->setChannelMix(
+              i + 1,
+              channels[i].volume / 50,
+              channels[i].pan / 100);
+  }
+}
+
+void
+Application::audioChannelOpened(const Suscan::InspectorMessage &msg)
+{
+  auto const &channels = this->ui.audioPanel->getChannels();
+  SUFREQ center = this->mediator->getProfile()->getFreq();
+  unsigned int generation = SIGDIGGER_AUDIO_CHANNEL_REQID_GEN(msg.getRequestId());
+  unsigned int index = SIGDIGGER_AUDIO_CHANNEL_REQID_INDEX(msg.getRequestId()) - 1;
+
+  // Stale reply: requested for a set of channels that was since closed,
+  // or for a channel that is gone or already open
+  if (generation != this->audioChannelGeneration
+      || index >= this->audioChannels.size()
+      || index >= channels.size()
+      || this->audioChannels[index].opened) {
+    this->analyzer->closeInspector(msg.getHandle(), 0);
+    return;
+  }
+
+  this->audioChannels[index].handle = msg.getHandle();
+  this->audioChannels[index].opened = true;
+
+  // The channel may have been retuned while the request was in flight
+  this->analyzer->setInspectorFreq(
+        msg.getHandle(),
+        static_cast<SUFREQ>(channels[index].freq) - center,
+        0);
+
+  this->analyzer->setInspectorId(
+        msg.getHandle(),
+        SIGDIGGER_AUDIO_CHANNEL_MAGIC_ID(index + 1),
+        0);
+  this->analyzer->setInspectorWatermark(
+        msg.getHandle(),
+        SIGDIGGER_AUDIO_BUFFER_SIZE / 2,
+        0);
+  this->analyzer->setInspectorBandwidth(
+        msg.getHandle(),
+        static_cast<SUFREQ>(channels[index].bw),
+        0);
+
+  if (this->audioCfgTemplate == nullptr)
+    SU_ATTEMPT(this->audioCfgTemplate = suscan_config_dup(msg.getCConfig()));
+
+  this->configureAudioChannel(index);
+}
+
 void
 Application::closeAudio(void)
 {
+  this->closeAudioChannels();
+
   if (this->mediator->getState() == UIMediator::RUNNING
       && this->audioInspectorOpened)
     this->analyzer->closeInspector(this->audioInspHandle, 0);
   this->audioInspectorOpened = false;
   this->audioSampleRate = 0;
   this->audioInspHandle = 0;
+  this->uninstallAudioSaver();
+  this->audioHealthTimer->stop();
+  this->ui.audioPanel->setHealth(nullptr);
   this->playBack = nullptr;
   this->audioConfigured = false;
 }
 
+//
+// The zoom spectrum is the spectrum of an inspector channel centered on
+// the tuner frequency and as wide as the visible span. The analyzer
+// channelizer mixes it down and decimates it, so the inspector FFT only
+// covers what is on screen. Spans change with the zoom level, and the
+// decimation is fixed when the channel is opened, so every span gets
+// its own channel. There is no channel per pan: the spectrum keeps the
+// view centered on the tuner while zoom frames are painted.
+//
+void
+Application::updateZoomInspector(void)
+{
+  unsigned int span = this->mediator->getZoomSpectrumSpan();
+
+  if (this->mediator->getState() != UIMediator::RUNNING
+      || this->zoomUnavailable)
+    return;
+
+  // Checked again once the reply arrives
+  if (this->zoomRequestedSpan != 0)
+    return;
+
+  if (this->zoomInspectorOpened) {
+    if (this->zoomOpenSpan == span)
+      return;
+
+    this->analyzer->closeInspector(this->zoomInspHandle, 0);
+    this->zoomInspectorOpened = false;
+    this->zoomOpenSpan = 0;
+  }
+
+  if (span > 0) {
+    Suscan::Channel ch;
+
+    ch.bw    = span;
+    ch.ft    = 0;
+    ch.fc    = 0;
+    ch.fLow  = -.5 * ch.bw;
+    ch.fHigh = .5 * ch.bw;
+
+    this->analyzer->openPrecise(
+          SIGDIGGER_ZOOM_INSPECTOR_CLASS,
+          ch,
+          SIGDIGGER_ZOOM_INSPECTOR_REQID);
+    this->zoomRequestedSpan = span;
+  }
+}
+
+void
+Application::zoomInspectorReady(const Suscan::InspectorMessage &msg)
+{
+  auto const &sources = msg.getSpectrumSources();
+  unsigned int source;
+
+  this->zoomInspHandle = msg.getHandle();
+  this->zoomInspectorOpened = true;
+  this->zoomOpenSpan = this->zoomRequestedSpan;
+  this->zoomRequestedSpan = 0;
+
+  for (source = 0; source < sources.size(); ++source)
+    if (sources[source].name == SIGDIGGER_ZOOM_INSPECTOR_SOURCE)
+      break;
+
+  // Do not try again with every zoom change
+  if (source == sources.size()) {
+    this->analyzer->closeInspector(msg.getHandle(), 0);
+    this->zoomInspectorOpened = false;
+    this->zoomUnavailable = true;
+    return;
+  }
+
+  this->analyzer->setInspectorId(
+        msg.getHandle(),
+        SIGDIGGER_ZOOM_INSPECTOR_MAGIC_ID,
+        0);
+  this->analyzer->setSpectrumSource(msg.getHandle(), source, 0);
+
+  // The span may have changed while the channel was being opened
+  this->updateZoomInspector();
+}
+
+void
+Application::resetZoomInspector(void)
+{
+  this->zoomInspHandle = 0;
+  this->zoomInspectorOpened = false;
+  this->zoomUnavailable = false;
+  this->zoomRequestedSpan = 0;
+  this->zoomOpenSpan = 0;
+}
+
 SUFREQ
 Application::getAudioInspectorBandwidth(void) const
 {
@@ -380,6 +725,36 @@ Application::connectUI(void)
         this,
         SLOT(onAudioChanged(void)));
 
+  connect(
+        this->mediator,
+        SIGNAL(toggleAudioRecord(void)),
+        this,
+        SLOT(onToggleAudioRecord(void)));
+
+  connect(
+        this->mediator,
+        SIGNAL(pinAudioChannel(void)),
+        this,
+        SLOT(onPinAudioChannel(void)));
+
+  connect(
+        this->mediator,
+        SIGNAL(audioChannelsChanged(void)),
+        this,
+        SLOT(onAudioChannelsChanged(void)));
+
+  connect(
+        this->mediator,
+        SIGNAL(audioMixChanged(void)),
+        this,
+        SLOT(onAudioMixChanged(void)));
+
+  connect(
+        this->mediator,
+        SIGNAL(zoomSpectrumChanged(void)),
+        this,
+        SLOT(onZoomSpectrumChanged(void)));
+
   connect(
         this->mediator,
         SIGNAL(bandwidthChanged(void)),
@@ -409,6 +784,12 @@ Application::connectUI(void)
         SIGNAL(recentCleared(void)),
         this,
         SLOT(onRecentCleared(void)));
+
+  connect(
+        this->audioHealthTimer,
+        SIGNAL(timeout(void)),
+        this,
+        SLOT(onAudioHealthTimer(void)));
 }
 
 void
@@ -548,7 +929,7 @@ Application::startCapture(void)
       }
 
       analyzer = std::make_unique<Suscan::Analyzer>(
-            *this->mediator->getAnalyzerParams(),
+            *this->mediator->getEffectiveParams(),
             *this->mediator->getProfile());
 
       // Enable throttling, if requested
@@ -618,6 +999,7 @@ Application::onAnalyzerHalted(void)
   this->mediator->setState(UIMediator::HALTED);
   this->mediator->detachAllInspectors();
   this->closeAudio();
+  this->resetZoomInspector();
 
   if (restart)
     this->startCapture();
@@ -638,6 +1020,7 @@ Application::onAnalyzerEos(void)
   this->mediator->detachAllInspectors();
   this->analyzer = nullptr;
   this->closeAudio();
+  this->resetZoomInspector();
   this->uninstallDataSaver();
 }
 
@@ -646,7 +1029,14 @@ Application::onPSDMessage(const Suscan::PSDMessage &msg)
 {
   this->mediator->setProcessRate(
         static_cast<unsigned int>(this->analyzer->getMeasuredSampleRate()));
+  this->mediator->setMessageBacklog(this->analyzer->getPendingMessages());
   this->mediator->feedPSD(msg);
+
+  // Picked up by the next PSD. Cheap enough to refresh on every update,
+  // and it follows window resizes for free.
+  this->analyzer->setPSDDecimation(
+        this->ui.spectrum->getDisplayBins(),
+        this->ui.fftPanel->getDetector());
 }
 
 void
@@ -657,6 +1047,16 @@ Application::onInspectorSamples(const Suscan::SamplesMessage &msg)
   if (this->playBack != nullptr
       && msg.getInspectorId() == SIGDIGGER_AUDIO_INSPECTOR_MAGIC_ID) {
     this->playBack->write(msg.getSamples(), msg.getCount());
+    if (this->audioSaver != nullptr)
+      this->audioSaver->write(msg.getSamples(), msg.getCount());
+  } else if (this->playBack != nullptr
+      && msg.getInspectorId() >= SIGDIGGER_AUDIO_CHANNEL_MAGIC_ID(1)
+      && msg.getInspectorId() <= SIGDIGGER_AUDIO_CHANNEL_MAGIC_ID(
+        SIGDIGGER_AUDIO_MAX_EXTRA_CHANNELS)) {
+    this->playBack->feed(
+          msg.getInspectorId() - SIGDIGGER_AUDIO_INSPECTOR_MAGIC_ID,
+          msg.getSamples(),
+          msg.getCount());
   } else if ((insp = this->mediator->lookupInspector(msg.getInspectorId())) != nullptr)
     insp->feed(msg.getSamples(), msg.getCount());
 }
@@ -700,6 +1100,13 @@ Application::onInspectorMessage(const Suscan::InspectorMessage &msg)
               this->delayedCutOff,
               this->delayedVolume,
               this->delayedDemod);
+      } else if (msg.getRequestId() > SIGDIGGER_AUDIO_CHANNEL_REQID(0, 0)
+                 && msg.getRequestId() <= SIGDIGGER_AUDIO_CHANNEL_REQID(
+                   SIGDIGGER_AUDIO_CHANNEL_GENERATIONS - 1,
+                   SIGDIGGER_AUDIO_MAX_EXTRA_CHANNELS)) {
+        this->audioChannelOpened(msg);
+      } else if (msg.getRequestId() == SIGDIGGER_ZOOM_INSPECTOR_REQID) {
+        this->zoomInspectorReady(msg);
       } else {
         insp = this->mediator->addInspectorTab(msg, oId);
         insp->setAnalyzer(this->analyzer.get());
@@ -708,7 +1115,13 @@ Application::onInspectorMessage(const Suscan::InspectorMessage &msg)
       break;
 
     case SUSCAN_ANALYZER_INSPECTOR_MSGKIND_SPECTRUM:
-       if ((insp = this->mediator->lookupInspector(msg.getInspectorId())) != nullptr) {
+       if (msg.getInspectorId() == SIGDIGGER_ZOOM_INSPECTOR_MAGIC_ID) {
+         // Converted by the mediator, into a buffer it keeps
+         this->mediator->feedZoomSpectrum(
+               msg.getSpectrumData(),
+               msg.getSpectrumLength(),
+               static_cast<unsigned int>(msg.getSpectrumRate()));
+       } else if ((insp = this->mediator->lookupInspector(msg.getInspectorId())) != nullptr) {
          data = msg.getSpectrumData();
          len = msg.getSpectrumLength();
          p = len / 2;
@@ -762,6 +1175,7 @@ Application::onAnalyzerReadError(void)
         QMessageBox::Ok);
   this->mediator->setState(UIMediator::HALTED);
   this->analyzer = nullptr;
+  this->resetZoomInspector();
   this->uninstallDataSaver();
 }
 
@@ -833,8 +1247,12 @@ Application::onFrequencyChanged(qint64 freq, qint64 lnb)
   this->mediator->getProfile()->setFreq(freq);
   this->mediator->getProfile()->setLnbFreq(lnb);
 
-  if (this->mediator->getState() == UIMediator::RUNNING)
+  if (this->mediator->getState() == UIMediator::RUNNING) {
     this->analyzer->setFrequency(freq, lnb);
+
+    // Pinned channels stay on their absolute frequency
+    this->assertAudioChannelsLo();
+  }
 }
 
 void
@@ -862,7 +1280,7 @@ void
 Application::onParamsChanged(void)
 {
   if (this->mediator->getState() == UIMediator::RUNNING)
-    this->analyzer->setParams(*this->mediator->getAnalyzerParams());
+    this->analyzer->setParams(*this->mediator->getEffectiveParams());
 }
 
 void
@@ -987,6 +1405,106 @@ Application::onCommit(void)
   this->mediator->setCaptureSize(this->dataSaver->getSize());
 }
 
+void
+Application::onToggleAudioRecord(void)
+{
+  if (this->ui.audioPanel->getRecordState()) {
+    if (this->playBack != nullptr)
+      this->installAudioSaver();
+  } else {
+    this->uninstallAudioSaver();
+    this->ui.audioPanel->setCaptureSize(0);
+  }
+}
+
+void
+Application::onPinAudioChannel(void)
+{
+  AudioChannelConfig ch;
+
+  ch.freq  = static_cast<qint64>(
+        this->mediator->getProfile()->getFreq() + this->getAudioInspectorLo());
+  ch.bw    = static_cast<SUFLOAT>(this->getAudioInspectorBandwidth());
+  ch.demod = this->ui.audioPanel->getDemod();
+
+  if (this->ui.audioPanel->addChannel(ch))
+    this->reopenAudioChannels();
+}
+
+void
+Application::onAudioChannelsChanged(void)
+{
+  this->reopenAudioChannels();
+}
+
+void
+Application::onAudioMixChanged(void)
+{
+  this->updateAudioMix();
+}
+
+void
+Application::onZoomSpectrumChanged(void)
+{
+  this->updateZoomInspector();
+}
+
+void
+Application::onAudioHealthTimer(void)
+{
+  if (this->playBack != nullptr) {
+    AudioHealth health = this->playBack->getHealth();
+    this->ui.audioPanel->setHealth(&health);
+  }
+}
+
+void
+Application::onAudioSaveError(void)
+{
+  if (this->audioSaver.get() != nullptr) {
+    QString error = this->audioSaver->getLastError();
+    this->uninstallAudioSaver();
+
+    QMessageBox::warning(
+              this,
+              "SigDigger error",
+              "Audio recording interrupted due to errors. " + error,
+              QMessageBox::Ok);
+
+    this->ui.audioPanel->setRecordState(false);
+  }
+}
+
+void
+Application::onAudioSaveSwamped(void)
+{
+  if (this->audioSaver.get() != nullptr) {
+    this->uninstallAudioSaver();
+
+    QMessageBox::warning(
+          this,
+          "SigDigger error",
+          "Audio recording thread swamped. Maybe your storage device is too slow",
+          QMessageBox::Ok);
+
+    this->ui.audioPanel->setRecordState(false);
+  }
+}
+
+void
+Application::onAudioSaveRate(qreal rate)
+{
+  this->ui.audioPanel->setIORate(rate);
+}
+
+void
+Application::onAudioCommit(void)
+{
+  // DataSaverUI counts complex float samples, audio is stored as int16
+  this->ui.audioPanel->setCaptureSize(
+        this->audioSaver->getSize() * sizeof(int16_t) / sizeof(SUCOMPLEX));
+}
+
 void
 Application::onLoChanged(qint64)
 {
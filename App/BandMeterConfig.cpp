@@ -0,0 +1,84 @@
+//
+//    BandMeterConfig.cpp: Band power meter definitions
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+#include "BandMeterConfig.h"
+
+using namespace SigDigger;
+
+BandMeterConfig::BandMeterConfig()
+{
+}
+
+BandMeterConfig::BandMeterConfig(Suscan::Object const &conf) : BandMeterConfig()
+{
+  this->deserialize(conf);
+}
+
+void
+BandMeterConfig::deserialize(Suscan::Object const &conf)
+{
+  this->bands.clear();
+
+  try {
+    Suscan::Object set = conf.getField("bands");
+
+    for (unsigned int i = 0; i < set.length(); ++i) {
+      try {
+        Suscan::Object entry = set[i];
+        BandMeterBand band;
+
+        // Frequencies do not fit in a SUFLOAT without losing precision
+        band.name      = entry.get("name", std::string());
+        band.freq      = std::stoll(entry.get("freq", std::string("0")));
+        band.bandwidth = std::stoll(entry.get("bandwidth", std::string("0")));
+
+        if (band.bandwidth > 0
+            && this->bands.size() < SIGDIGGER_BAND_METER_MAX_BANDS)
+          this->bands.push_back(band);
+      } catch (std::exception &) {
+      }
+    }
+  } catch (Suscan::Exception &) {
+    // No meters saved
+  }
+}
+
+Suscan::Object &&
+BandMeterConfig::serialize(void)
+{
+  Suscan::Object obj(SUSCAN_OBJECT_TYPE_OBJECT);
+  Suscan::Object set(SUSCAN_OBJECT_TYPE_SET);
+
+  obj.setClass("BandMeterConfig");
+
+  for (auto &band : this->bands) {
+    Suscan::Object entry(SUSCAN_OBJECT_TYPE_OBJECT);
+
+    entry.setClass("BandMeter");
+    entry.set("name", band.name);
+    entry.set("freq", std::to_string(band.freq));
+    entry.set("bandwidth", std::to_string(band.bandwidth));
+
+    set.append(entry);
+  }
+
+  obj.setField("bands", set);
+
+  return this->persist(obj);
+}
@@ -23,6 +23,7 @@
 #include <QMessageBox>
 
 #include <Loader.h>
+#include "FftwWisdom.h"
 
 using namespace SigDigger;
 
@@ -35,6 +36,11 @@ InitThread::run()
   Suscan::Singleton *sing = Suscan::Singleton::get_instance();
 
   try {
+    // Before anything gets to plan an FFT
+    emit change("Loading FFT wisdom");
+    if (!FftwWisdom::load())
+      std::cerr << "Cannot read FFTW wisdom, sizes will be measured again"
+                << std::endl;
     emit change("Loading signal sources");
     sing->init_sources();
     emit change("Loading spectrum sources");
@@ -212,6 +218,8 @@ Loader::saveConfig(void)
           + QString::fromStdString(e.what()) + "</pre>",
           QMessageBox::Close);
   }
+
+  this->app->saveWisdom();
 }
 
 void
@@ -0,0 +1,167 @@
+//
+//    AlsaAudioBackend.cpp: ALSA audio output
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+#include "AudioBackend.h"
+#include "AudioPlayback.h"
+#include <stdexcept>
+
+using namespace SigDigger;
+
+#ifdef SIGDIGGER_HAVE_ALSA
+
+#define ATTEMPT(expr, what) \
+  if ((err = expr) < 0)  \
+    throw std::runtime_error("Failed to " + std::string(what) + ": " + std::string(snd_strerror(err)))
+
+//
+// Hardware devices are asked for the formats they take natively (their
+// own format mask), widest integer first: handing them anything else
+// would just move the conversion into alsa-lib, sample by sample. Plug
+// devices (plug, default, pulse...) accept every format and convert
+// anyway, so they get S16, which halves the data that goes through it.
+//
+void
+AlsaAudioBackend::negotiateFormat(snd_pcm_hw_params_t *params)
+{
+  static const struct {
+    snd_pcm_format_t alsa;
+    AudioFormat format;
+  } hwOrder[] = {
+    {SND_PCM_FORMAT_S32_LE,   AUDIO_FORMAT_S32},
+    {SND_PCM_FORMAT_S16_LE,   AUDIO_FORMAT_S16},
+    {SND_PCM_FORMAT_FLOAT_LE, AUDIO_FORMAT_FLOAT32}
+  }, plugOrder[] = {
+    {SND_PCM_FORMAT_S16_LE,   AUDIO_FORMAT_S16},
+    {SND_PCM_FORMAT_S32_LE,   AUDIO_FORMAT_S32},
+    {SND_PCM_FORMAT_FLOAT_LE, AUDIO_FORMAT_FLOAT32}
+  };
+  snd_pcm_format_mask_t *mask = nullptr;
+  bool hw = snd_pcm_type(this->pcm) == SND_PCM_TYPE_HW;
+  int err;
+
+  snd_pcm_format_mask_alloca(&mask);
+  snd_pcm_hw_params_get_format_mask(params, mask);
+
+  for (unsigned int i = 0; i < sizeof(hwOrder) / sizeof(hwOrder[0]); ++i) {
+    auto const &f = hw ? hwOrder[i] : plugOrder[i];
+
+    if (snd_pcm_format_mask_test(mask, f.alsa)) {
+      this->format = f.format;
+      ATTEMPT(
+            snd_pcm_hw_params_set_format(this->pcm, params, f.alsa),
+            "set sample format to "
+            + std::string(snd_pcm_format_name(f.alsa)));
+      return;
+    }
+  }
+
+  throw std::runtime_error(
+        "Audio device supports none of S16_LE, S32_LE and FLOAT_LE");
+}
+
+AlsaAudioBackend::AlsaAudioBackend(
+    std::string const &dev,
+    unsigned int rate,
+    unsigned int channels)
+{
+  int err;
+  snd_pcm_hw_params_t *params = nullptr;
+
+  ATTEMPT(
+        snd_pcm_open(&this->pcm, dev.c_str(), SND_PCM_STREAM_PLAYBACK, 0),
+        "open audio device " + dev);
+
+  // The destructor does not run if the constructor throws: close the
+  // device here, or it stays busy for whatever backend is tried next
+  try {
+    snd_pcm_hw_params_alloca(&params);
+    snd_pcm_hw_params_any(pcm, params);
+
+    ATTEMPT(
+          snd_pcm_hw_params_set_access(
+            this->pcm,
+            params,
+            SND_PCM_ACCESS_RW_INTERLEAVED),
+          "set interleaved access for audio device");
+
+    this->negotiateFormat(params);
+
+    ATTEMPT(
+          snd_pcm_hw_params_set_buffer_size(
+            this->pcm,
+            params,
+            SIGDIGGER_AUDIO_BUFFER_SIZE),
+          "set buffer size");
+
+    ATTEMPT(
+          snd_pcm_hw_params_set_channels(this->pcm, params, channels),
+          "set number of output channels");
+
+    ATTEMPT(
+          snd_pcm_hw_params_set_rate_near(this->pcm, params, &rate, nullptr),
+          "set sample rate");
+
+    ATTEMPT(snd_pcm_hw_params(this->pcm, params), "set device params");
+  } catch (std::runtime_error &) {
+    snd_pcm_close(this->pcm);
+    this->pcm = nullptr;
+    throw;
+  }
+
+  this->sampRate = rate;
+  this->channels = channels;
+}
+
+bool
+AlsaAudioBackend::write(const void *data, size_t frames)
+{
+  snd_pcm_sframes_t err;
+
+  err = snd_pcm_writei(this->pcm, data, frames);
+
+  if (err == -EPIPE) {
+    ++this->xruns;
+    snd_pcm_prepare(this->pcm);
+    err = snd_pcm_writei(this->pcm, data, frames);
+  }
+
+  if (err < 0) {
+    this->lastError = snd_strerror(static_cast<int>(err));
+    return false;
+  }
+
+  return true;
+}
+
+void
+AlsaAudioBackend::drain(void)
+{
+  if (this->pcm != nullptr)
+    snd_pcm_drain(this->pcm);
+}
+
+AlsaAudioBackend::~AlsaAudioBackend()
+{
+  if (this->pcm != nullptr) {
+    snd_pcm_drain(this->pcm);
+    snd_pcm_close(this->pcm);
+  }
+}
+
+#endif // SIGDIGGER_HAVE_ALSA
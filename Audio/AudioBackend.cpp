@@ -0,0 +1,103 @@
+//
+//    AudioBackend.cpp: Audio backend factory
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+#include "AudioBackend.h"
+#include <stdexcept>
+
+using namespace SigDigger;
+
+AudioBackend::AudioBackend() : xruns(0)
+{
+}
+
+void
+AudioBackend::drain(void)
+{
+  // Nothing to flush by default
+}
+
+AudioBackend::~AudioBackend()
+{
+}
+
+static bool
+specMatches(std::string const &spec, std::string const &prefix, std::string &arg)
+{
+  if (spec == prefix) {
+    arg = "";
+    return true;
+  }
+
+  if (spec.compare(0, prefix.size() + 1, prefix + ":") == 0) {
+    arg = spec.substr(prefix.size() + 1);
+    return true;
+  }
+
+  return false;
+}
+
+AudioBackend *
+AudioBackend::make(
+    std::string const &dev,
+    unsigned int rate,
+    unsigned int channels)
+{
+  std::string arg;
+
+  if (specMatches(dev, "wav", arg))
+    return new FileAudioBackend(arg, rate, channels, false);
+
+  if (specMatches(dev, "wav+clock", arg))
+    return new FileAudioBackend(arg, rate, channels, true);
+
+  if (specMatches(dev, "alsa", arg)) {
+#ifdef SIGDIGGER_HAVE_ALSA
+    return new AlsaAudioBackend(arg.empty() ? "default" : arg, rate, channels);
+#else
+    throw std::runtime_error("ALSA support disabled at compile time");
+#endif // SIGDIGGER_HAVE_ALSA
+  }
+
+  if (specMatches(dev, "pulse", arg)) {
+#ifdef SIGDIGGER_HAVE_PULSEAUDIO
+    return new PulseAudioBackend(arg, rate, channels);
+#else
+    throw std::runtime_error("PulseAudio support disabled at compile time");
+#endif // SIGDIGGER_HAVE_PULSEAUDIO
+  }
+
+  if (dev.empty() || dev == "default") {
+#if defined(SIGDIGGER_HAVE_ALSA)
+    return new AlsaAudioBackend("default", rate, channels);
+#elif defined(SIGDIGGER_HAVE_PULSEAUDIO)
+    return new PulseAudioBackend("", rate, channels);
+#else
+    throw std::runtime_error(
+        "No soundcard backend available (both ALSA and PulseAudio support "
+        "were disabled at compile time). Use a wav: device instead.");
+#endif
+  }
+
+  // Anything else is assumed to be an ALSA PCM name, as before.
+#ifdef SIGDIGGER_HAVE_ALSA
+  return new AlsaAudioBackend(dev, rate, channels);
+#else
+  throw std::runtime_error("Unrecognized audio device `" + dev + "'");
+#endif // SIGDIGGER_HAVE_ALSA
+}
@@ -0,0 +1,180 @@
+//
+//    AudioMixer.cpp: Mix several audio channels into a stereo stream
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+#include "AudioMixer.h"
+#include <cmath>
+#include <cstring>
+
+using namespace SigDigger;
+
+//
+// Mixing is done in planar L / R buffers and interleaved at the end: every
+// loop below is then a plain streaming loop the compiler can vectorize.
+//
+
+AudioMixer::AudioMixer(SUSCOUNT maxLag)
+{
+  this->maxLag = maxLag;
+  this->setChannelCount(1);
+}
+
+void
+AudioMixer::assertSize(SUSCOUNT len)
+{
+  if (this->left.size() < len) {
+    this->left.resize(len);
+    this->right.resize(len);
+    this->output.resize(2 * len);
+  }
+}
+
+void
+AudioMixer::setChannelCount(unsigned int count)
+{
+  if (count < 1)
+    count = 1;
+
+  // Channel indices are reassigned when the count changes: whatever was
+  // queued belongs to a different channel now.
+  if (count != this->channels.size()) {
+    this->channels.resize(count);
+
+    for (auto &ch : this->channels)
+      ch.avail = 0;
+  }
+}
+
+void
+AudioMixer::setMix(unsigned int channel, SUFLOAT volume, SUFLOAT pan)
+{
+  SUFLOAT theta;
+
+  if (channel >= this->channels.size())
+    return;
+
+  if (pan < -1)
+    pan = -1;
+  else if (pan > 1)
+    pan = 1;
+
+  // Constant power pan law. Centered channels get 1/sqrt(2) on each side,
+  // so we compensate to keep the centered gain at unity.
+  theta = static_cast<SUFLOAT>(M_PI / 4) * (pan + 1);
+
+  this->channels[channel].gainL = volume * static_cast<SUFLOAT>(M_SQRT2) * cosf(theta);
+  this->channels[channel].gainR = volume * static_cast<SUFLOAT>(M_SQRT2) * sinf(theta);
+}
+
+void
+AudioMixer::feed(unsigned int channel, const SUCOMPLEX *samples, SUSCOUNT len)
+{
+  const SUFLOAT *__restrict__ in = reinterpret_cast<const SUFLOAT *>(samples);
+  SUFLOAT *__restrict__ q;
+  Channel *ch;
+  SUSCOUNT i;
+
+  // Channel 0 is fed through mix()
+  if (channel == 0 || channel >= this->channels.size())
+    return;
+
+  ch = &this->channels[channel];
+
+  // Keep at most maxLag samples, dropping the oldest ones
+  if (len > this->maxLag) {
+    in  += 2 * (len - this->maxLag);
+    len  = this->maxLag;
+  }
+
+  if (ch->avail + len > this->maxLag) {
+    SUSCOUNT drop = ch->avail + len - this->maxLag;
+    memmove(
+          ch->queue.data(),
+          ch->queue.data() + drop,
+          (ch->avail - drop) * sizeof(SUFLOAT));
+    ch->avail -= drop;
+  }
+
+  if (ch->queue.size() < ch->avail + len)
+    ch->queue.resize(ch->avail + len);
+
+  q = ch->queue.data() + ch->avail;
+
+#pragma omp simd
+  for (i = 0; i < len; ++i)
+    q[i] = in[2 * i];
+
+  ch->avail += len;
+}
+
+const SUFLOAT *
+AudioMixer::mix(const SUCOMPLEX *master, SUSCOUNT len)
+{
+  const SUFLOAT *__restrict__ in = reinterpret_cast<const SUFLOAT *>(master);
+  SUFLOAT *__restrict__ l;
+  SUFLOAT *__restrict__ r;
+  SUFLOAT *__restrict__ out;
+  SUFLOAT gainL, gainR;
+  SUSCOUNT i;
+
+  this->assertSize(len);
+
+  l   = this->left.data();
+  r   = this->right.data();
+  out = this->output.data();
+
+  gainL = this->channels[0].gainL;
+  gainR = this->channels[0].gainR;
+
+#pragma omp simd
+  for (i = 0; i < len; ++i) {
+    SUFLOAT s = in[2 * i];
+    l[i] = s * gainL;
+    r[i] = s * gainR;
+  }
+
+  for (auto p = this->channels.begin() + 1; p != this->channels.end(); ++p) {
+    const SUFLOAT *__restrict__ q = p->queue.data();
+    SUSCOUNT n = p->avail < len ? p->avail : len;
+
+    gainL = p->gainL;
+    gainR = p->gainR;
+
+    // Missing samples are silence: nothing to add
+#pragma omp simd
+    for (i = 0; i < n; ++i) {
+      l[i] += q[i] * gainL;
+      r[i] += q[i] * gainR;
+    }
+
+    if (n < p->avail)
+      memmove(
+            p->queue.data(),
+            p->queue.data() + n,
+            (p->avail - n) * sizeof(SUFLOAT));
+    p->avail -= n;
+  }
+
+#pragma omp simd
+  for (i = 0; i < len; ++i) {
+    out[2 * i]     = l[i];
+    out[2 * i + 1] = r[i];
+  }
+
+  return out;
+}
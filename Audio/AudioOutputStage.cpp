@@ -0,0 +1,192 @@
+//
+//    AudioOutputStage.cpp: Final conversion stage before the soundcard
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+#include "AudioOutputStage.h"
+#include <cstdint>
+
+using namespace SigDigger;
+
+//
+// The loops below are written so that the compiler can vectorize them
+// (no calls, no branches other than selects, restrict-qualified pointers).
+// Keep it that way: std::min / std::max in the clamp are enough to make
+// GCC give up.
+//
+
+template<typename T> static inline T convertSample(SUFLOAT x);
+
+template<> inline float
+convertSample<float>(SUFLOAT x)
+{
+  return x;
+}
+
+template<> inline int16_t
+convertSample<int16_t>(SUFLOAT x)
+{
+  return static_cast<int16_t>(x * 32767.f);
+}
+
+template<> inline int32_t
+convertSample<int32_t>(SUFLOAT x)
+{
+  // Largest float below 2^31 that is still exactly representable
+  return static_cast<int32_t>(x * 2147483520.f);
+}
+
+AudioOutputStage::AudioOutputStage(AudioFormat format)
+{
+  this->setFormat(format);
+}
+
+void
+AudioOutputStage::setFormat(AudioFormat format)
+{
+  this->format = format;
+}
+
+void
+AudioOutputStage::setGain(SUFLOAT gain)
+{
+  this->gain = gain;
+}
+
+void
+AudioOutputStage::setChannels(unsigned int channels)
+{
+  // Only mono and interleaved stereo are supported
+  this->channels = channels > 1 ? 2 : 1;
+  this->reset();
+}
+
+void
+AudioOutputStage::setDcBlock(bool enabled)
+{
+  this->dcBlock = enabled;
+  this->reset();
+}
+
+void
+AudioOutputStage::setSoftClip(bool enabled)
+{
+  this->softClip = enabled;
+}
+
+void
+AudioOutputStage::reset(void)
+{
+  this->dc[0] = this->dc[1] = 0;
+}
+
+template<typename T, unsigned int Stride> void
+AudioOutputStage::process(
+    T *__restrict__ out,
+    const SUFLOAT *__restrict__ in,
+    SUSCOUNT len)
+{
+  SUFLOAT dc0 = this->dcBlock ? this->dc[0] : 0;
+  SUFLOAT dc1 = this->dcBlock ? this->dc[1] : 0;
+  SUFLOAT gain = this->gain;
+  SUFLOAT knee = SIGDIGGER_AUDIO_CLIP_KNEE;
+  SUFLOAT headroom = 1.f - knee;
+  SUFLOAT scale = 1.f / headroom;
+  bool soft = this->softClip;
+  SUFLOAT sum0 = 0, sum1 = 0;
+  SUSCOUNT mask = this->channels - 1;
+  SUSCOUNT n0, n1;
+  SUSCOUNT i;
+
+  // Exactly linear up to the knee. Above it, the excess u (relative to
+  // the headroom left) is squashed as u / (1 + u), which matches the
+  // linear part in value and slope and approaches full scale without
+  // reaching it. With soft clipping off, samples are only clamped to
+  // full scale. Each interleaved channel has its own DC estimate.
+#pragma omp simd reduction(+:sum0,sum1)
+  for (i = 0; i < len; ++i) {
+    SUFLOAT s = in[i * Stride];
+    bool odd = (i & mask) != 0;
+    SUFLOAT x = (s - (odd ? dc1 : dc0)) * gain;
+    SUFLOAT a = x < 0.f ? -x : x;
+    SUFLOAT u = a > knee ? (a - knee) * scale : 0.f;
+    SUFLOAT y;
+
+    sum0 += odd ? 0.f : s;
+    sum1 += odd ? s : 0.f;
+
+    y = soft ? (a < knee ? a : knee) + headroom * u / (1.f + u) : a;
+    y = y > 1.f ? 1.f : y;
+
+    out[i] = convertSample<T>(x < 0.f ? -y : y);
+  }
+
+  // DC estimates are updated once per block. A one-pole tracker at the
+  // sample rate would carry a dependency across iterations.
+  if (this->dcBlock) {
+    n1 = mask ? len / 2 : 0;
+    n0 = len - n1;
+
+    this->updateDc(this->dc[0], sum0, n0);
+    this->updateDc(this->dc[1], sum1, n1);
+  }
+}
+
+void
+AudioOutputStage::updateDc(SUFLOAT &dc, SUFLOAT sum, SUSCOUNT len)
+{
+  SUFLOAT alpha;
+
+  if (len > 0) {
+    alpha = static_cast<SUFLOAT>(len) / SIGDIGGER_AUDIO_DC_TAU;
+
+    if (alpha > 1)
+      alpha = 1;
+
+    dc += alpha * (sum / static_cast<SUFLOAT>(len) - dc);
+  }
+}
+
+template<unsigned int Stride> void
+AudioOutputStage::dispatch(void *out, const SUFLOAT *in, SUSCOUNT len)
+{
+  switch (this->format) {
+    case AUDIO_FORMAT_S16:
+      this->process<int16_t, Stride>(static_cast<int16_t *>(out), in, len);
+      break;
+
+    case AUDIO_FORMAT_S32:
+      this->process<int32_t, Stride>(static_cast<int32_t *>(out), in, len);
+      break;
+
+    default:
+      this->process<float, Stride>(static_cast<float *>(out), in, len);
+  }
+}
+
+void
+AudioOutputStage::write(void *out, const SUCOMPLEX *samples, SUSCOUNT len)
+{
+  // Complex samples are laid out as (re, im) pairs of SUFLOAT
+  this->dispatch<2>(out, reinterpret_cast<const SUFLOAT *>(samples), len);
+}
+
+void
+AudioOutputStage::writeReal(void *out, const SUFLOAT *samples, SUSCOUNT len)
+{
+  this->dispatch<1>(out, samples, len);
+}
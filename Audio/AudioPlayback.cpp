@@ -18,43 +18,61 @@
 //
 
 #include <iostream>
+#include <cstdlib>
 #include "AudioPlayback.h"
 #include <stdexcept>
 #include <sys/mman.h>
+#include <sys/time.h>
 
 using namespace SigDigger;
 
-#define ATTEMPT(expr, what) \
-  if ((err = expr) < 0)  \
-    throw std::runtime_error("Failed to " + std::string(what) + ": " + std::string(snd_strerror(err)))
-
-#ifdef SIGDIGGER_HAVE_ALSA
-
 ///////////////////////////// Playback worker /////////////////////////////////
-PlaybackWorker::PlaybackWorker(AudioBufferList *instance, snd_pcm_t *pcm)
+PlaybackWorker::PlaybackWorker(
+    AudioBufferList *instance,
+    AudioBackend *backend,
+    AudioHealthCounters *health,
+    size_t frames)
 {
-  this->pcm      = pcm;
+  this->backend  = backend;
   this->instance = instance;
+  this->health   = health;
+  this->frames   = frames;
 }
 
 void
 PlaybackWorker::play(void)
 {
-  float *buffer;
+  uint8_t *buffer;
+  struct timeval last, now, sub;
+  bool haveLast = false;
+  int64_t period = static_cast<int64_t>(
+        this->frames * 1000000ull / this->backend->getSampleRate());
 
   while (!this->halting && (buffer = this->instance->next()) != nullptr) {
-    long err;
-    err = snd_pcm_writei(this->pcm, buffer, SIGDIGGER_AUDIO_BUFFER_SIZE);
-
-    if (err == -EPIPE) {
-      snd_pcm_prepare(this->pcm);
-      err = snd_pcm_writei(this->pcm, buffer, SIGDIGGER_AUDIO_BUFFER_SIZE);
+    bool ok;
+
+    this->health->updateFill(this->instance->getPlayListLen());
+
+    // A blocking device write returns as soon as there is room for one
+    // more buffer, so the time between writes should be one buffer long.
+    // The first write after (re)starting is not paced, skip it.
+    gettimeofday(&now, nullptr);
+    if (haveLast) {
+      int64_t elapsed;
+      timersub(&now, &last, &sub);
+      elapsed = sub.tv_sec * 1000000ll + sub.tv_usec;
+      this->health->updateJitter(
+            static_cast<uint64_t>(std::llabs(elapsed - period)));
     }
+    last = now;
+    haveLast = true;
+
+    ok = this->backend->write(buffer, this->frames);
 
     // Done with this buffer, mark as free.
     this->instance->release();
 
-    if (err < 0)
+    if (!ok)
       emit error();
   }
 
@@ -73,16 +91,16 @@ PlaybackWorker::halt(void)
 ////////////////////////////////// Audio buffer ///////////////////////////////
 AudioBuffer::AudioBuffer()
 {
-  float *buf;
+  uint8_t *buf;
 
   // Ladies and gentlemen, behold the COBOL
-  if ((buf = static_cast<float *>(mmap(
+  if ((buf = static_cast<uint8_t *>(mmap(
          nullptr,
          SIGDIGGER_AUDIO_BUFFER_ALLOC,
          PROT_READ | PROT_WRITE,
          MAP_PRIVATE | MAP_ANONYMOUS,
          0,
-         0))) == reinterpret_cast<float *>(-1)) {
+         0))) == reinterpret_cast<uint8_t *>(-1)) {
     throw std::runtime_error(
           "Failed to allocate "
           + std::to_string(SIGDIGGER_AUDIO_BUFFER_ALLOC)
@@ -148,7 +166,7 @@ AudioBufferList::reset(void)
   this->playListLen = 0;
 }
 
-float *
+uint8_t *
 AudioBufferList::reserve(void)
 {
   QMutexLocker(&this->listMutex);
@@ -194,7 +212,7 @@ AudioBufferList::commit(void)
   }
 }
 
-float *
+uint8_t *
 AudioBufferList::next(void)
 {
   QMutexLocker(&this->listMutex);
@@ -238,65 +256,16 @@ AudioBufferList::release(void)
 
 //////////////////////////////// AudioBuffer ///////////////////////////////////
 AudioPlayback::AudioPlayback(std::string const &dev, unsigned int rate)
-  : bufferList(SIGDIGGER_AUDIO_BUFFER_NUM)
+  : bufferList(SIGDIGGER_AUDIO_BUFFER_NUM),
+    mixer(SIGDIGGER_AUDIO_BUFFER_MIN * SIGDIGGER_AUDIO_BUFFER_SIZE)
 {
-  int err;
-  snd_pcm_hw_params_t *params = nullptr;
-  float *buf;
-
-  // Ladies and gentlemen, behold the COBOL
-  if ((buf = static_cast<float *>(mmap(
-         nullptr,
-         SIGDIGGER_AUDIO_BUFFER_ALLOC,
-         PROT_READ | PROT_WRITE,
-         MAP_PRIVATE | MAP_ANONYMOUS,
-         0,
-         0))) == reinterpret_cast<float *>(-1)) {
-    throw std::runtime_error(
-          "Failed to allocate "
-          + std::to_string(SIGDIGGER_AUDIO_BUFFER_ALLOC)
-          + " of buffer bytes for soundcard.");
-  }
-
-  ATTEMPT(
-        snd_pcm_open(&this->pcm, dev.c_str(), SND_PCM_STREAM_PLAYBACK, 0),
-        "open audio device " + dev);
-
-  snd_pcm_hw_params_alloca(&params);
-  snd_pcm_hw_params_any(pcm, params);
-
-  ATTEMPT(
-        snd_pcm_hw_params_set_access(
-          this->pcm,
-          params,
-          SND_PCM_ACCESS_RW_INTERLEAVED),
-        "set interleaved access for audio device");
-
-  ATTEMPT(
-        snd_pcm_hw_params_set_format(
-          this->pcm,
-          params,
-          SND_PCM_FORMAT_FLOAT_LE),
-        "set sample format");
-
-  ATTEMPT(
-        snd_pcm_hw_params_set_buffer_size(
-          this->pcm,
-          params,
-          SIGDIGGER_AUDIO_BUFFER_SIZE),
-        "set buffer size");
-
-  ATTEMPT(
-        snd_pcm_hw_params_set_channels(this->pcm, params, 1),
-        "set output to mono");
-
-  ATTEMPT(
-        snd_pcm_hw_params_set_rate_near(this->pcm, params, &rate, nullptr),
-        "set sample rate");
-
-  ATTEMPT(snd_pcm_hw_params(this->pcm, params), "set device params");
-
-  this->sampRate = rate;
+  this->backend = std::unique_ptr<AudioBackend>(
+        AudioBackend::make(dev, rate, SIGDIGGER_AUDIO_CHANNELS));
+  this->sampRate = this->backend->getSampleRate();
+  this->frameSize = this->backend->getFrameSize();
+  this->bufferFrames = SIGDIGGER_AUDIO_BUFFER_SIZE / SIGDIGGER_AUDIO_CHANNELS;
+  this->stage.setFormat(this->backend->getFormat());
+  this->stage.setChannels(SIGDIGGER_AUDIO_CHANNELS);
 
   this->startWorker();
 }
@@ -304,7 +273,11 @@ AudioPlayback::AudioPlayback(std::string const &dev, unsigned int rate)
 void
 AudioPlayback::startWorker()
 {
-  this->worker = new PlaybackWorker(&this->bufferList, this->pcm);
+  this->worker = new PlaybackWorker(
+        &this->bufferList,
+        this->backend.get(),
+        &this->health,
+        this->bufferFrames);
   this->workerThread = new QThread();
 
   this->worker->moveToThread(this->workerThread);
@@ -370,6 +343,7 @@ AudioPlayback::onStarving(void)
   if (this->bufferList.getPlayListLen() < SIGDIGGER_AUDIO_BUFFERING_WATERMARK) {
     this->completed = 0;
     this->buffering = true;
+    ++this->health.rebuffers;
     std::cout << "AudioPlayback: reached watermark, buffering again..." << std::endl;
   } else {
     emit restart();
@@ -389,10 +363,8 @@ AudioPlayback::~AudioPlayback()
   if (this->worker != nullptr)
     delete this->worker;
 
-  if (this->pcm != nullptr) {
-    snd_pcm_drain(this->pcm);
-    snd_pcm_close(this->pcm);
-  }
+  if (this->backend != nullptr)
+    this->backend->drain();
 }
 
 unsigned int
@@ -401,39 +373,86 @@ AudioPlayback::getSampleRate(void) const
   return this->sampRate;
 }
 
+AudioHealth
+AudioPlayback::getHealth(void)
+{
+  AudioHealth health;
+  unsigned int fill = this->bufferList.getPlayListLen();
+
+  health.xruns     = this->backend->getXruns();
+  health.dropped   = this->health.dropped;
+  health.rebuffers = this->health.rebuffers;
+  health.minFill   = this->health.minFill.exchange(UINT_MAX);
+  health.maxFill   = this->health.maxFill.exchange(0);
+  health.jitter    = 1e-3 * this->health.jitterUsec.exchange(0);
+
+  // Nothing happened since the last snapshot: report the current fill
+  if (health.minFill == UINT_MAX) {
+    health.minFill = fill;
+    health.maxFill = fill;
+  }
+
+  return health;
+}
+
+void
+AudioPlayback::setVolume(SUFLOAT volume)
+{
+  this->stage.setGain(volume);
+}
+
+void
+AudioPlayback::setChannelCount(unsigned int count)
+{
+  this->mixer.setChannelCount(count);
+}
+
+void
+AudioPlayback::setChannelMix(unsigned int channel, SUFLOAT volume, SUFLOAT pan)
+{
+  this->mixer.setMix(channel, volume, pan);
+}
+
+void
+AudioPlayback::feed(unsigned int channel, const SUCOMPLEX *samples, SUSCOUNT size)
+{
+  if (!this->failed)
+    this->mixer.feed(channel, samples, size);
+}
+
 void
 AudioPlayback::write(const SUCOMPLEX *samples, SUSCOUNT size)
 {
   while (size > 0 && !failed) {
     SUSCOUNT chunk = size;
-    SUSCOUNT remaining;
-    float *start;
 
     // No current buffer, try to allocate
     if (this->current_buffer == nullptr) {
       this->ptr = 0;
       if ((this->current_buffer = this->bufferList.reserve()) == nullptr) {
         // Somehow the playback thread is slow...
+        this->health.dropped += size;
         return;
       }
     }
 
-    start = this->current_buffer + this->ptr;
+    if (chunk > this->bufferFrames - this->ptr)
+      chunk = this->bufferFrames - this->ptr;
 
-    if (chunk > SIGDIGGER_AUDIO_BUFFER_SIZE - this->ptr)
-      chunk = SIGDIGGER_AUDIO_BUFFER_SIZE - this->ptr;
-    remaining = chunk;
-
-    while (remaining-- > 0)
-      *start++ = SU_C_REAL(*samples++);
+    this->stage.writeReal(
+          this->current_buffer + this->ptr * this->frameSize,
+          this->mixer.mix(samples, chunk),
+          SIGDIGGER_AUDIO_CHANNELS * chunk);
 
+    samples   += chunk;
     this->ptr += chunk;
     size -= chunk;
 
     // Buffer full, send to playback thread.
-    if (this->ptr == SIGDIGGER_AUDIO_BUFFER_SIZE) {
+    if (this->ptr == this->bufferFrames) {
       this->current_buffer = nullptr;
       this->bufferList.commit();
+      this->health.updateFill(this->bufferList.getPlayListLen());
 
       // If buffering, we wait until we have SIGDIGGER_AUDIO_BUFFER_MIN
       // buffers full. When that happens, we restart the thread.
@@ -446,23 +465,3 @@ AudioPlayback::write(const SUCOMPLEX *samples, SUSCOUNT size)
     }
   }
 }
-
-#else
-AudioPlayback::AudioPlayback(std::string const &, unsigned int)
-{
-
-    throw std::runtime_error(
-        "Cannot create audio playback object: ALSA support disabled at compile time");
-}
-
-void AudioPlayback::onError(void) { }
-
-void AudioPlayback::onStarving(void) { }
-
-AudioPlayback::~AudioPlayback() { }
-
-unsigned int AudioPlayback::getSampleRate(void) const { return 0; }
-
-void AudioPlayback::write(const SUCOMPLEX *, SUSCOUNT) { }
-
-#endif // SIGDIGGER_HAVE_ALSA
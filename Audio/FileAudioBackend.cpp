@@ -0,0 +1,178 @@
+//
+//    FileAudioBackend.cpp: WAV file / pipe audio sink
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+#include "AudioBackend.h"
+#include <stdexcept>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+
+using namespace SigDigger;
+
+#define WAVE_FORMAT_PCM        1
+#define WAVE_FORMAT_IEEE_FLOAT 3
+
+static void
+putLE32(uint8_t *p, uint32_t val)
+{
+  p[0] = static_cast<uint8_t>(val);
+  p[1] = static_cast<uint8_t>(val >> 8);
+  p[2] = static_cast<uint8_t>(val >> 16);
+  p[3] = static_cast<uint8_t>(val >> 24);
+}
+
+static void
+putLE16(uint8_t *p, uint16_t val)
+{
+  p[0] = static_cast<uint8_t>(val);
+  p[1] = static_cast<uint8_t>(val >> 8);
+}
+
+void
+SigDigger::composeWavHeader(
+    uint8_t *hdr,
+    unsigned int rate,
+    unsigned int channels,
+    AudioFormat format,
+    uint32_t dataLen)
+{
+  unsigned int sampSize = static_cast<unsigned int>(
+        AudioBackend::formatSize(format));
+  uint32_t riffLen = dataLen;
+
+  if (dataLen != SIGDIGGER_WAV_UNKNOWN_LENGTH)
+    riffLen = dataLen + SIGDIGGER_WAV_HEADER_SIZE - 8;
+
+  memcpy(hdr, "RIFF", 4);
+  putLE32(hdr + 4, riffLen);
+  memcpy(hdr + 8, "WAVEfmt ", 8);
+  putLE32(hdr + 16, 16);
+  putLE16(
+        hdr + 20,
+        format == AUDIO_FORMAT_FLOAT32 ? WAVE_FORMAT_IEEE_FLOAT : WAVE_FORMAT_PCM);
+  putLE16(hdr + 22, static_cast<uint16_t>(channels));
+  putLE32(hdr + 24, rate);
+  putLE32(hdr + 28, rate * channels * sampSize);
+  putLE16(hdr + 32, static_cast<uint16_t>(channels * sampSize));
+  putLE16(hdr + 34, static_cast<uint16_t>(8 * sampSize));
+  memcpy(hdr + 36, "data", 4);
+  putLE32(hdr + 40, dataLen);
+}
+
+FileAudioBackend::FileAudioBackend(
+    std::string const &path,
+    unsigned int rate,
+    unsigned int channels,
+    bool throttle)
+{
+  if (path.empty())
+    throw std::runtime_error("No output file given for WAV audio sink");
+
+  if (path == "-") {
+    this->fp = stdout;
+  } else if ((this->fp = fopen(path.c_str(), "wb")) == nullptr) {
+    throw std::runtime_error(
+        "Cannot open " + path + " for writing: " + std::string(strerror(errno)));
+  }
+
+  this->seekable = this->fp != stdout && ftell(this->fp) != -1;
+  this->throttle = throttle;
+  this->sampRate = rate;
+  this->channels = channels;
+
+  // No destructor if we throw from here on
+  if (!this->writeHeader()) {
+    if (this->fp != stdout)
+      fclose(this->fp);
+    this->fp = nullptr;
+    throw std::runtime_error("Failed to write WAV header: " + this->lastError);
+  }
+
+  gettimeofday(&this->start, nullptr);
+}
+
+bool
+FileAudioBackend::writeHeader(void)
+{
+  uint8_t hdr[SIGDIGGER_WAV_HEADER_SIZE];
+  uint32_t dataLen = SIGDIGGER_WAV_UNKNOWN_LENGTH;
+
+  // Pipes never get their header fixed, so we mark lengths as unknown
+  if (this->seekable)
+    dataLen = static_cast<uint32_t>(this->written * this->getFrameSize());
+
+  composeWavHeader(hdr, this->sampRate, this->channels, this->format, dataLen);
+
+  if (fwrite(hdr, sizeof(hdr), 1, this->fp) != 1) {
+    this->lastError = strerror(errno);
+    return false;
+  }
+
+  return true;
+}
+
+bool
+FileAudioBackend::write(const void *data, size_t frames)
+{
+  if (fwrite(data, this->getFrameSize(), frames, this->fp) != frames) {
+    this->lastError = strerror(errno);
+    return false;
+  }
+
+  this->written += frames;
+
+  if (this->throttle) {
+    struct timeval now, sub;
+    uint64_t elapsed, expected;
+
+    gettimeofday(&now, nullptr);
+    timersub(&now, &this->start, &sub);
+
+    elapsed  = static_cast<uint64_t>(sub.tv_sec) * 1000000ull
+        + static_cast<uint64_t>(sub.tv_usec);
+    expected = this->written * 1000000ull / this->sampRate;
+
+    // Behave like a soundcard: block until the device would have
+    // consumed what we just wrote.
+    if (expected > elapsed)
+      usleep(static_cast<useconds_t>(expected - elapsed));
+  }
+
+  return true;
+}
+
+void
+FileAudioBackend::drain(void)
+{
+  if (this->fp != nullptr)
+    fflush(this->fp);
+}
+
+FileAudioBackend::~FileAudioBackend()
+{
+  if (this->fp != nullptr) {
+    if (this->seekable && fseek(this->fp, 0, SEEK_SET) == 0)
+      (void) this->writeHeader();
+
+    if (this->fp != stdout)
+      fclose(this->fp);
+    else
+      fflush(this->fp);
+  }
+}
@@ -0,0 +1,100 @@
+//
+//    PulseAudioBackend.cpp: PulseAudio (and PipeWire) audio output
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+#include "AudioBackend.h"
+#include "AudioPlayback.h"
+#include <stdexcept>
+
+using namespace SigDigger;
+
+#ifdef SIGDIGGER_HAVE_PULSEAUDIO
+#include <pulse/error.h>
+
+PulseAudioBackend::PulseAudioBackend(
+    std::string const &sink,
+    unsigned int rate,
+    unsigned int channels)
+{
+  pa_sample_spec spec;
+  pa_buffer_attr attr;
+  int error;
+
+  // The output stage converts to S16 for us, so the server does not have
+  // to resample formats on top of rates.
+  spec.format   = PA_SAMPLE_S16LE;
+  spec.rate     = rate;
+  spec.channels = static_cast<uint8_t>(channels);
+
+  // Keep server-side latency in the same ballpark as the ALSA buffer
+  attr.maxlength = static_cast<uint32_t>(-1);
+  attr.tlength   = static_cast<uint32_t>(
+        SIGDIGGER_AUDIO_BUFFER_SIZE * channels * sizeof(int16_t));
+  attr.prebuf    = static_cast<uint32_t>(-1);
+  attr.minreq    = static_cast<uint32_t>(-1);
+  attr.fragsize  = static_cast<uint32_t>(-1);
+
+  this->stream = pa_simple_new(
+        nullptr,
+        "SigDigger",
+        PA_STREAM_PLAYBACK,
+        sink.empty() ? nullptr : sink.c_str(),
+        "Audio preview",
+        &spec,
+        nullptr,
+        &attr,
+        &error);
+
+  if (this->stream == nullptr)
+    throw std::runtime_error(
+        "Failed to open PulseAudio stream: " + std::string(pa_strerror(error)));
+
+  this->sampRate = rate;
+  this->channels = channels;
+  this->format   = AUDIO_FORMAT_S16;
+}
+
+bool
+PulseAudioBackend::write(const void *data, size_t frames)
+{
+  int error;
+
+  if (pa_simple_write(this->stream, data, frames * this->getFrameSize(), &error) < 0) {
+    this->lastError = pa_strerror(error);
+    return false;
+  }
+
+  return true;
+}
+
+void
+PulseAudioBackend::drain(void)
+{
+  if (this->stream != nullptr)
+    pa_simple_drain(this->stream, nullptr);
+}
+
+PulseAudioBackend::~PulseAudioBackend()
+{
+  if (this->stream != nullptr) {
+    pa_simple_drain(this->stream, nullptr);
+    pa_simple_free(this->stream);
+  }
+}
+
+#endif // SIGDIGGER_HAVE_PULSEAUDIO
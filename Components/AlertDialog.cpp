@@ -0,0 +1,404 @@
+//
+//    AlertDialog.cpp: Band alert rules and recent alerts
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+
+#include "AlertDialog.h"
+#include "ui_AlertDialog.h"
+#include <QFileDialog>
+#include <algorithm>
+#include <cmath>
+
+using namespace SigDigger;
+
+enum AlertColumn {
+  ALERT_COLUMN_NAME,
+  ALERT_COLUMN_FREQUENCY,
+  ALERT_COLUMN_BANDWIDTH,
+  ALERT_COLUMN_THRESHOLD,
+  ALERT_COLUMN_RELATIVE,
+  ALERT_COLUMN_DURATION,
+  ALERT_COLUMN_RECORD,
+  ALERT_COLUMN_LEVEL,
+  ALERT_COLUMN_COUNT
+};
+
+static QTableWidgetItem *
+makeCheckItem(bool checked)
+{
+  QTableWidgetItem *item = new QTableWidgetItem();
+
+  item->setFlags(
+        (item->flags() | Qt::ItemIsUserCheckable) & ~Qt::ItemIsEditable);
+  item->setCheckState(checked ? Qt::Checked : Qt::Unchecked);
+
+  return item;
+}
+
+AlertDialog::AlertDialog(QWidget *parent) :
+  QDialog(parent),
+  ui(new Ui::AlertDialog)
+{
+  ui->setupUi(this);
+
+  this->refreshTimer = new QTimer(this);
+  this->refreshTimer->setInterval(SIGDIGGER_ALERT_DIALOG_REFRESH_MS);
+
+  this->ui->eventList->setMaximumBlockCount(SIGDIGGER_ALERT_DIALOG_HISTORY);
+
+  this->connectAll();
+  this->refreshUi();
+
+  this->refreshTimer->start();
+}
+
+AlertDialog::~AlertDialog()
+{
+  delete ui;
+}
+
+void
+AlertDialog::connectAll(void)
+{
+  connect(
+        this->refreshTimer,
+        SIGNAL(timeout(void)),
+        this,
+        SLOT(onRefresh(void)));
+
+  connect(
+        this->ui->ruleTable,
+        SIGNAL(itemChanged(QTableWidgetItem *)),
+        this,
+        SLOT(onItemChanged(void)));
+
+  connect(
+        this->ui->ruleTable,
+        SIGNAL(itemSelectionChanged(void)),
+        this,
+        SLOT(onSelectionChanged(void)));
+
+  connect(
+        this->ui->addButton,
+        SIGNAL(clicked(bool)),
+        this,
+        SLOT(onAdd(void)));
+
+  connect(
+        this->ui->removeButton,
+        SIGNAL(clicked(bool)),
+        this,
+        SLOT(onRemove(void)));
+
+  connect(
+        this->ui->browseLogButton,
+        SIGNAL(clicked(bool)),
+        this,
+        SLOT(onBrowseLog(void)));
+
+  connect(
+        this->ui->enabledCheck,
+        SIGNAL(stateChanged(int)),
+        this,
+        SLOT(onSettingsChanged(void)));
+
+  connect(
+        this->ui->logEdit,
+        SIGNAL(editingFinished(void)),
+        this,
+        SLOT(onSettingsChanged(void)));
+
+  connect(
+        this->ui->notifyEdit,
+        SIGNAL(editingFinished(void)),
+        this,
+        SLOT(onSettingsChanged(void)));
+
+  connect(
+        this->ui->holdoffSpin,
+        SIGNAL(valueChanged(int)),
+        this,
+        SLOT(onSettingsChanged(void)));
+}
+
+void
+AlertDialog::refreshUi(void)
+{
+  int rows = this->ui->ruleTable->rowCount();
+
+  this->ui->addButton->setEnabled(rows < SIGDIGGER_ALERT_MAX_RULES);
+  this->ui->removeButton->setEnabled(
+        !this->ui->ruleTable->selectedItems().isEmpty());
+}
+
+void
+AlertDialog::setEngine(const AlertEngine *engine)
+{
+  this->engine = engine;
+}
+
+void
+AlertDialog::setRules(std::vector<AlertRule> const &rules)
+{
+  QTableWidget *table = this->ui->ruleTable;
+  int row = 0;
+
+  // Avoid onItemChanged() while we fill the table
+  table->blockSignals(true);
+  table->setRowCount(static_cast<int>(rules.size()));
+
+  for (auto const &rule : rules) {
+    QTableWidgetItem *level = new QTableWidgetItem();
+
+    level->setFlags(level->flags() & ~Qt::ItemIsEditable);
+
+    table->setItem(
+          row,
+          ALERT_COLUMN_NAME,
+          new QTableWidgetItem(QString::fromStdString(rule.name)));
+    table->setItem(
+          row,
+          ALERT_COLUMN_FREQUENCY,
+          new QTableWidgetItem(QString::number(rule.freq)));
+    table->setItem(
+          row,
+          ALERT_COLUMN_BANDWIDTH,
+          new QTableWidgetItem(QString::number(rule.bandwidth)));
+    table->setItem(
+          row,
+          ALERT_COLUMN_THRESHOLD,
+          new QTableWidgetItem(
+            QString::number(static_cast<double>(rule.threshold))));
+    table->setItem(row, ALERT_COLUMN_RELATIVE, makeCheckItem(rule.relative));
+    table->setItem(
+          row,
+          ALERT_COLUMN_DURATION,
+          new QTableWidgetItem(QString::number(rule.duration)));
+    table->setItem(row, ALERT_COLUMN_RECORD, makeCheckItem(rule.record));
+    table->setItem(row, ALERT_COLUMN_LEVEL, level);
+    ++row;
+  }
+
+  table->blockSignals(false);
+
+  this->refreshUi();
+}
+
+// Rows with unreadable numbers or no bandwidth are skipped
+std::vector<AlertRule>
+AlertDialog::getRules(void) const
+{
+  QTableWidget *table = this->ui->ruleTable;
+  std::vector<AlertRule> rules;
+
+  for (int row = 0; row < table->rowCount(); ++row) {
+    QTableWidgetItem *items[ALERT_COLUMN_COUNT];
+    AlertRule rule;
+    bool ok[4];
+    bool complete = true;
+
+    for (int col = 0; col < ALERT_COLUMN_COUNT; ++col)
+      complete = complete && (items[col] = table->item(row, col)) != nullptr;
+
+    if (!complete)
+      continue;
+
+    rule.name      = items[ALERT_COLUMN_NAME]->text().toStdString();
+    rule.freq      = items[ALERT_COLUMN_FREQUENCY]->text().toLongLong(&ok[0]);
+    rule.bandwidth = items[ALERT_COLUMN_BANDWIDTH]->text().toLongLong(&ok[1]);
+    rule.threshold = items[ALERT_COLUMN_THRESHOLD]->text().toFloat(&ok[2]);
+    rule.duration  = items[ALERT_COLUMN_DURATION]->text().toUInt(&ok[3]);
+    rule.relative  =
+        items[ALERT_COLUMN_RELATIVE]->checkState() == Qt::Checked;
+    rule.record    =
+        items[ALERT_COLUMN_RECORD]->checkState() == Qt::Checked;
+
+    if (ok[0] && ok[1] && ok[2] && ok[3] && rule.bandwidth > 0)
+      rules.push_back(rule);
+  }
+
+  return rules;
+}
+
+void
+AlertDialog::setAlertsEnabled(bool enabled)
+{
+  this->ui->enabledCheck->blockSignals(true);
+  this->ui->enabledCheck->setChecked(enabled);
+  this->ui->enabledCheck->blockSignals(false);
+}
+
+void
+AlertDialog::setLogPath(QString const &path)
+{
+  this->ui->logEdit->setText(path);
+}
+
+void
+AlertDialog::setNotifyTarget(QString const &target)
+{
+  this->ui->notifyEdit->setText(target);
+}
+
+void
+AlertDialog::setHoldoff(unsigned int seconds)
+{
+  this->ui->holdoffSpin->blockSignals(true);
+  this->ui->holdoffSpin->setValue(static_cast<int>(seconds));
+  this->ui->holdoffSpin->blockSignals(false);
+}
+
+void
+AlertDialog::setError(QString const &error)
+{
+  this->ui->errorLabel->setText(error);
+}
+
+void
+AlertDialog::addEvent(QString const &line)
+{
+  this->ui->eventList->appendPlainText(line);
+}
+
+bool
+AlertDialog::getAlertsEnabled(void) const
+{
+  return this->ui->enabledCheck->isChecked();
+}
+
+QString
+AlertDialog::getLogPath(void) const
+{
+  return this->ui->logEdit->text().trimmed();
+}
+
+QString
+AlertDialog::getNotifyTarget(void) const
+{
+  return this->ui->notifyEdit->text().trimmed();
+}
+
+unsigned int
+AlertDialog::getHoldoff(void) const
+{
+  return static_cast<unsigned int>(this->ui->holdoffSpin->value());
+}
+
+void
+AlertDialog::onRefresh(void)
+{
+  QTableWidget *table = this->ui->ruleTable;
+  int rows;
+
+  if (this->engine == nullptr || !this->isVisible())
+    return;
+
+  // Levels follow the engine's rules, which may lag behind an edit
+  rows = std::min(
+        table->rowCount(),
+        static_cast<int>(this->engine->getRules().size()));
+
+  table->blockSignals(true);
+
+  for (int row = 0; row < rows; ++row) {
+    size_t rule = static_cast<size_t>(row);
+    QTableWidgetItem *item = table->item(row, ALERT_COLUMN_LEVEL);
+    float level = this->engine->getLevel(rule);
+
+    if (item == nullptr)
+      continue;
+
+    if (!this->engine->isInSpan(rule))
+      item->setText("Out of span");
+    else if (!std::isfinite(level))
+      item->setText(QString());
+    else
+      item->setText(
+            QString::number(static_cast<double>(level), 'f', 1)
+            + (this->engine->isRaised(rule) ? " (raised)" : ""));
+  }
+
+  table->blockSignals(false);
+
+  this->ui->suppressedLabel->setText(
+        "Rate limited: "
+        + QString::number(this->engine->getSuppressed()));
+
+  this->refreshUi();
+}
+
+// Edits that leave a row unreadable are reverted to what the engine has
+void
+AlertDialog::onItemChanged(void)
+{
+  if (static_cast<int>(this->getRules().size())
+      != this->ui->ruleTable->rowCount()) {
+    if (this->engine != nullptr)
+      this->setRules(this->engine->getRules());
+    return;
+  }
+
+  emit rulesChanged();
+}
+
+void
+AlertDialog::onSelectionChanged(void)
+{
+  this->refreshUi();
+}
+
+void
+AlertDialog::onAdd(void)
+{
+  emit addRule();
+}
+
+void
+AlertDialog::onRemove(void)
+{
+  int row = this->ui->ruleTable->currentRow();
+
+  if (row >= 0) {
+    this->ui->ruleTable->removeRow(row);
+    this->refreshUi();
+    emit rulesChanged();
+  }
+}
+
+void
+AlertDialog::onBrowseLog(void)
+{
+  QString path = QFileDialog::getSaveFileName(
+        this,
+        "Alert log file",
+        this->getLogPath(),
+        "Log files (*.log);;All files (*)",
+        nullptr,
+        QFileDialog::DontConfirmOverwrite);
+
+  if (!path.isEmpty()) {
+    this->ui->logEdit->setText(path);
+    emit settingsChanged();
+  }
+}
+
+void
+AlertDialog::onSettingsChanged(void)
+{
+  emit settingsChanged();
+}
@@ -18,6 +18,9 @@
 //
 #include "AudioPanel.h"
 #include "ui_AudioPanel.h"
+#include "AudioPlayback.h"
+#include <QDir>
+#include <QTableWidgetItem>
 
 using namespace SigDigger;
 
@@ -33,6 +36,11 @@ static const unsigned int supportedRates[] = {
 #define STORE(field) obj.set(STRINGFY(field), this->field)
 #define LOAD(field) this->field = conf.get(STRINGFY(field), this->field)
 
+#define SIGDIGGER_AUDIO_CHANNEL_COL_FREQ   0
+#define SIGDIGGER_AUDIO_CHANNEL_COL_DEMOD  1
+#define SIGDIGGER_AUDIO_CHANNEL_COL_VOLUME 2
+#define SIGDIGGER_AUDIO_CHANNEL_COL_PAN    3
+
 void
 AudioPanelConfig::deserialize(Suscan::Object const &conf)
 {
@@ -41,6 +49,34 @@ AudioPanelConfig::deserialize(Suscan::Object const &conf)
   LOAD(rate);
   LOAD(cutOff);
   LOAD(volume);
+  LOAD(device);
+  LOAD(savePath);
+
+  this->channels.clear();
+
+  try {
+    Suscan::Object set = conf.getField("channels");
+
+    for (unsigned int i = 0; i < set.length(); ++i) {
+      try {
+        Suscan::Object entry = set[i];
+        AudioChannelConfig ch;
+
+        // Frequencies do not fit in a SUFLOAT without losing precision
+        ch.freq   = std::stoll(entry.get("freq", std::string("0")));
+        ch.bw     = entry.get("bw", ch.bw);
+        ch.demod  = AudioPanel::strToDemod(entry.get("demod", std::string("AM")));
+        ch.volume = entry.get("volume", ch.volume);
+        ch.pan    = entry.get("pan", ch.pan);
+
+        if (this->channels.size() < SIGDIGGER_AUDIO_MAX_EXTRA_CHANNELS)
+          this->channels.push_back(ch);
+      } catch (std::exception &) {
+      }
+    }
+  } catch (Suscan::Exception &) {
+    // No pinned channels saved
+  }
 }
 
 Suscan::Object &&
@@ -55,6 +91,25 @@ AudioPanelConfig::serialize(void)
   STORE(rate);
   STORE(cutOff);
   STORE(volume);
+  STORE(device);
+  STORE(savePath);
+
+  Suscan::Object set(SUSCAN_OBJECT_TYPE_SET);
+
+  for (auto &ch : this->channels) {
+    Suscan::Object entry(SUSCAN_OBJECT_TYPE_OBJECT);
+
+    entry.setClass("AudioChannel");
+    entry.set("freq", std::to_string(ch.freq));
+    entry.set("bw", ch.bw);
+    entry.set("demod", AudioPanel::demodToStr(ch.demod));
+    entry.set("volume", ch.volume);
+    entry.set("pan", ch.pan);
+
+    set.append(entry);
+  }
+
+  obj.setField("channels", set);
 
   return this->persist(obj);
 }
@@ -127,6 +182,36 @@ AudioPanel::connectAll(void)
       SIGNAL(valueChanged(int)),
       this,
       SLOT(onVolumeChanged(void)));
+
+  connect(
+      this->ui->pinButton,
+      SIGNAL(clicked(bool)),
+      this,
+      SLOT(onPinChannel(void)));
+
+  connect(
+      this->ui->removeButton,
+      SIGNAL(clicked(bool)),
+      this,
+      SLOT(onRemoveChannel(void)));
+
+  connect(
+      this->ui->channelTable,
+      SIGNAL(itemChanged(QTableWidgetItem *)),
+      this,
+      SLOT(onChannelItemChanged(QTableWidgetItem *)));
+
+  connect(
+      this->saverUI,
+      SIGNAL(recordSavePathChanged(QString)),
+      this,
+      SLOT(onChangeSavePath(void)));
+
+  connect(
+      this->saverUI,
+      SIGNAL(recordStateChanged(bool)),
+      this,
+      SLOT(onRecordStartStop(void)));
 }
 
 void
@@ -145,6 +230,47 @@ AudioPanel::populateRates(void)
   }
 }
 
+void
+AudioPanel::populateChannels(void)
+{
+  QTableWidget *table = this->ui->channelTable;
+  int row = 0;
+
+  // Avoid onChannelItemChanged() while we fill the table
+  table->blockSignals(true);
+  table->setRowCount(static_cast<int>(this->panelConfig->channels.size()));
+
+  for (auto &ch : this->panelConfig->channels) {
+    QTableWidgetItem *freq = new QTableWidgetItem(
+          QString::number(static_cast<qreal>(ch.freq) * 1e-6, 'f', 6) + " MHz");
+    QTableWidgetItem *demod = new QTableWidgetItem(
+          QString::fromStdString(AudioPanel::demodToStr(ch.demod)));
+
+    freq->setFlags(freq->flags() & ~Qt::ItemIsEditable);
+    demod->setFlags(demod->flags() & ~Qt::ItemIsEditable);
+
+    table->setItem(row, SIGDIGGER_AUDIO_CHANNEL_COL_FREQ, freq);
+    table->setItem(row, SIGDIGGER_AUDIO_CHANNEL_COL_DEMOD, demod);
+    table->setItem(
+          row,
+          SIGDIGGER_AUDIO_CHANNEL_COL_VOLUME,
+          new QTableWidgetItem(QString::number(static_cast<int>(ch.volume))));
+    table->setItem(
+          row,
+          SIGDIGGER_AUDIO_CHANNEL_COL_PAN,
+          new QTableWidgetItem(QString::number(static_cast<int>(ch.pan))));
+    ++row;
+  }
+
+  table->resizeColumnsToContents();
+  table->blockSignals(false);
+
+  this->ui->pinButton->setEnabled(
+        this->getEnabled()
+        && this->panelConfig->channels.size() < SIGDIGGER_AUDIO_MAX_EXTRA_CHANNELS);
+  this->ui->removeButton->setEnabled(this->panelConfig->channels.size() > 0);
+}
+
 void
 AudioPanel::refreshUi(void)
 {
@@ -154,12 +280,19 @@ AudioPanel::refreshUi(void)
     this->ui->demodCombo->setEnabled(false);
     this->ui->sampleRateCombo->setEnabled(false);
     this->ui->cutoffSlider->setEnabled(false);
+    this->ui->pinButton->setEnabled(false);
+    this->saverUI->setEnabled(false);
   } else {
     bool enabled = this->getEnabled();
     this->ui->audioPreviewCheck->setEnabled(true);
     this->ui->demodCombo->setEnabled(enabled);
     this->ui->sampleRateCombo->setEnabled(enabled);
     this->ui->cutoffSlider->setEnabled(enabled);
+    this->ui->pinButton->setEnabled(
+          enabled
+          && this->panelConfig->channels.size()
+          < SIGDIGGER_AUDIO_MAX_EXTRA_CHANNELS);
+    this->saverUI->setEnabled(enabled);
 
     this->setCutOff(this->panelConfig->cutOff);
     this->setVolume(this->panelConfig->volume);
@@ -172,6 +305,13 @@ AudioPanel::AudioPanel(QWidget *parent) :
 {
   ui->setupUi(this);
 
+  this->ui->channelTable->setColumnCount(4);
+  this->ui->channelTable->setHorizontalHeaderLabels(
+        QStringList() << "Frequency" << "Demod" << "Vol (%)" << "Pan (%)");
+
+  this->saverUI = new DataSaverUI(this);
+  this->ui->dataSaverGrid->addWidget(this->saverUI);
+
   this->assertConfig();
   this->populateRates();
   this->connectAll();
@@ -249,6 +389,60 @@ AudioPanel::setVolume(SUFLOAT volume)
         QString::number(this->ui->volumeSlider->value()) + "%");
 }
 
+void
+AudioPanel::setCaptureSize(quint64 size)
+{
+  this->saverUI->setCaptureSize(size);
+}
+
+void
+AudioPanel::setIORate(qreal rate)
+{
+  this->saverUI->setIORate(rate);
+}
+
+void
+AudioPanel::setRecordState(bool state)
+{
+  this->saverUI->setRecordState(state);
+}
+
+void
+AudioPanel::setHealth(AudioHealth const *health)
+{
+  if (health == nullptr) {
+    this->ui->healthLabel->setText("N/A");
+    return;
+  }
+
+  this->ui->healthLabel->setText(
+        QString::number(health->minFill)
+        + "-"
+        + QString::number(health->maxFill)
+        + "/"
+        + QString::number(health->buffers)
+        + " buf, "
+        + QString::number(health->xruns)
+        + " xrun, "
+        + QString::number(health->rebuffers)
+        + " rebuf, "
+        + QString::number(health->dropped)
+        + " drop, ±"
+        + QString::number(health->jitter, 'f', 1)
+        + " ms");
+}
+
+bool
+AudioPanel::addChannel(AudioChannelConfig const &ch)
+{
+  if (this->panelConfig->channels.size() >= SIGDIGGER_AUDIO_MAX_EXTRA_CHANNELS)
+    return false;
+
+  this->panelConfig->channels.push_back(ch);
+  this->populateChannels();
+
+  return true;
+}
 
 // Getters
 SUFLOAT
@@ -290,6 +484,30 @@ AudioPanel::getVolume(void) const
   return this->ui->volumeSlider->value();
 }
 
+std::string
+AudioPanel::getDevice(void) const
+{
+  return this->panelConfig->device;
+}
+
+bool
+AudioPanel::getRecordState(void) const
+{
+  return this->saverUI->getRecordState();
+}
+
+std::string
+AudioPanel::getRecordSavePath(void) const
+{
+  return this->panelConfig->savePath;
+}
+
+std::vector<AudioChannelConfig> const &
+AudioPanel::getChannels(void) const
+{
+  return this->panelConfig->channels;
+}
+
 // Overriden methods
 Suscan::Serializable *
 AudioPanel::allocConfig(void)
@@ -305,6 +523,11 @@ AudioPanel::applyConfig(void)
   this->setVolume(this->panelConfig->volume);
   this->setDemod(strToDemod(this->panelConfig->demod));
   this->setEnabled(this->panelConfig->enabled);
+
+  if (this->panelConfig->savePath.size() == 0)
+    this->panelConfig->savePath = QDir::currentPath().toStdString();
+  this->saverUI->setRecordSavePath(this->panelConfig->savePath);
+  this->populateChannels();
 }
 
 //////////////////////////////// Slots ////////////////////////////////////////
@@ -347,3 +570,69 @@ AudioPanel::onEnabledChanged(void)
 
   emit changed();
 }
+
+void
+AudioPanel::onChangeSavePath(void)
+{
+  this->panelConfig->savePath = this->saverUI->getRecordSavePath();
+}
+
+void
+AudioPanel::onRecordStartStop(void)
+{
+  emit toggleRecord();
+}
+
+void
+AudioPanel::onPinChannel(void)
+{
+  emit pinChannel();
+}
+
+void
+AudioPanel::onRemoveChannel(void)
+{
+  int row = this->ui->channelTable->currentRow();
+
+  if (row >= 0
+      && row < static_cast<int>(this->panelConfig->channels.size())) {
+    this->panelConfig->channels.erase(
+          this->panelConfig->channels.begin() + row);
+    this->populateChannels();
+
+    emit channelsChanged();
+  }
+}
+
+void
+AudioPanel::onChannelItemChanged(QTableWidgetItem *item)
+{
+  int row = item->row();
+  bool ok;
+  int value = item->text().toInt(&ok);
+  AudioChannelConfig *ch;
+
+  if (row < 0 || row >= static_cast<int>(this->panelConfig->channels.size()))
+    return;
+
+  ch = &this->panelConfig->channels[static_cast<size_t>(row)];
+
+  if (item->column() == SIGDIGGER_AUDIO_CHANNEL_COL_VOLUME) {
+    if (ok && value >= 0 && value <= 100)
+      ch->volume = value;
+    value = static_cast<int>(ch->volume);
+  } else if (item->column() == SIGDIGGER_AUDIO_CHANNEL_COL_PAN) {
+    if (ok && value >= -100 && value <= 100)
+      ch->pan = value;
+    value = static_cast<int>(ch->pan);
+  } else {
+    return;
+  }
+
+  // Rejected values go back to what was stored
+  this->ui->channelTable->blockSignals(true);
+  item->setText(QString::number(value));
+  this->ui->channelTable->blockSignals(false);
+
+  emit mixChanged();
+}
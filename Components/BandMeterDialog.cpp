@@ -0,0 +1,346 @@
+//
+//    BandMeterDialog.cpp: Band power meter list
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+#include "BandMeterDialog.h"
+#include "ui_BandMeterDialog.h"
+#include <QDateTime>
+#include <QFile>
+#include <QFileDialog>
+#include <QMessageBox>
+#include <QTextStream>
+#include <algorithm>
+#include <cmath>
+
+using namespace SigDigger;
+
+enum BandMeterColumn {
+  BAND_METER_COLUMN_NAME,
+  BAND_METER_COLUMN_FREQUENCY,
+  BAND_METER_COLUMN_BANDWIDTH,
+  BAND_METER_COLUMN_POWER,
+  BAND_METER_COLUMN_COUNT
+};
+
+static QString
+csvQuote(QString const &field)
+{
+  QString copy = field;
+
+  if (!field.contains(',') && !field.contains('"'))
+    return field;
+
+  return "\"" + copy.replace("\"", "\"\"") + "\"";
+}
+
+BandMeterDialog::BandMeterDialog(QWidget *parent) :
+  QDialog(parent),
+  ui(new Ui::BandMeterDialog)
+{
+  ui->setupUi(this);
+
+  this->refreshTimer = new QTimer(this);
+  this->refreshTimer->setInterval(SIGDIGGER_BAND_METER_DIALOG_REFRESH_MS);
+
+  this->connectAll();
+  this->refreshUi();
+
+  this->refreshTimer->start();
+}
+
+BandMeterDialog::~BandMeterDialog()
+{
+  delete ui;
+}
+
+void
+BandMeterDialog::connectAll(void)
+{
+  connect(
+        this->refreshTimer,
+        SIGNAL(timeout(void)),
+        this,
+        SLOT(onRefresh(void)));
+
+  connect(
+        this->ui->bandTable,
+        SIGNAL(itemChanged(QTableWidgetItem *)),
+        this,
+        SLOT(onItemChanged(void)));
+
+  connect(
+        this->ui->bandTable,
+        SIGNAL(itemSelectionChanged(void)),
+        this,
+        SLOT(onSelectionChanged(void)));
+
+  connect(
+        this->ui->addButton,
+        SIGNAL(clicked(bool)),
+        this,
+        SLOT(onAdd(void)));
+
+  connect(
+        this->ui->removeButton,
+        SIGNAL(clicked(bool)),
+        this,
+        SLOT(onRemove(void)));
+
+  connect(
+        this->ui->exportButton,
+        SIGNAL(clicked(bool)),
+        this,
+        SLOT(onExport(void)));
+
+  connect(
+        this->ui->clearButton,
+        SIGNAL(clicked(bool)),
+        this,
+        SLOT(onClearLog(void)));
+}
+
+void
+BandMeterDialog::refreshUi(void)
+{
+  int rows = this->ui->bandTable->rowCount();
+
+  this->ui->addButton->setEnabled(rows < SIGDIGGER_BAND_METER_MAX_BANDS);
+  this->ui->removeButton->setEnabled(
+        !this->ui->bandTable->selectedItems().isEmpty());
+  this->ui->exportButton->setEnabled(
+        this->meter != nullptr && this->meter->getLogLength() > 0);
+  this->ui->clearButton->setEnabled(this->meter != nullptr);
+}
+
+void
+BandMeterDialog::setMeter(BandMeter *meter)
+{
+  this->meter = meter;
+  this->refreshUi();
+}
+
+void
+BandMeterDialog::setBands(std::vector<BandMeterBand> const &bands)
+{
+  QTableWidget *table = this->ui->bandTable;
+  int row = 0;
+
+  // Avoid onItemChanged() while we fill the table
+  table->blockSignals(true);
+  table->setRowCount(static_cast<int>(bands.size()));
+
+  for (auto const &band : bands) {
+    QTableWidgetItem *power = new QTableWidgetItem();
+
+    power->setFlags(power->flags() & ~Qt::ItemIsEditable);
+
+    table->setItem(
+          row,
+          BAND_METER_COLUMN_NAME,
+          new QTableWidgetItem(QString::fromStdString(band.name)));
+    table->setItem(
+          row,
+          BAND_METER_COLUMN_FREQUENCY,
+          new QTableWidgetItem(QString::number(band.freq)));
+    table->setItem(
+          row,
+          BAND_METER_COLUMN_BANDWIDTH,
+          new QTableWidgetItem(QString::number(band.bandwidth)));
+    table->setItem(row, BAND_METER_COLUMN_POWER, power);
+    ++row;
+  }
+
+  table->blockSignals(false);
+
+  this->refreshUi();
+}
+
+// Rows with unreadable numbers or no bandwidth are skipped
+std::vector<BandMeterBand>
+BandMeterDialog::getBands(void) const
+{
+  QTableWidget *table = this->ui->bandTable;
+  std::vector<BandMeterBand> bands;
+
+  for (int row = 0; row < table->rowCount(); ++row) {
+    QTableWidgetItem *name = table->item(row, BAND_METER_COLUMN_NAME);
+    QTableWidgetItem *freq = table->item(row, BAND_METER_COLUMN_FREQUENCY);
+    QTableWidgetItem *bw   = table->item(row, BAND_METER_COLUMN_BANDWIDTH);
+    BandMeterBand band;
+    bool freqOk, bwOk;
+
+    if (name == nullptr || freq == nullptr || bw == nullptr)
+      continue;
+
+    band.name      = name->text().toStdString();
+    band.freq      = freq->text().toLongLong(&freqOk);
+    band.bandwidth = bw->text().toLongLong(&bwOk);
+
+    if (freqOk && bwOk && band.bandwidth > 0)
+      bands.push_back(band);
+  }
+
+  return bands;
+}
+
+void
+BandMeterDialog::onRefresh(void)
+{
+  QTableWidget *table = this->ui->bandTable;
+  int rows;
+
+  if (this->meter == nullptr || !this->isVisible())
+    return;
+
+  // Readings follow the meter's bands, which may lag behind an edit
+  rows = std::min(
+        table->rowCount(),
+        static_cast<int>(this->meter->getReadings().size()));
+
+  table->blockSignals(true);
+
+  for (int row = 0; row < rows; ++row) {
+    BandMeterReading const &r =
+        this->meter->getReadings()[static_cast<size_t>(row)];
+    QTableWidgetItem *item = table->item(row, BAND_METER_COLUMN_POWER);
+
+    if (item != nullptr)
+      item->setText(
+            r.valid
+            ? QString::number(static_cast<double>(r.power), 'f', 1)
+            : "Out of span");
+  }
+
+  table->blockSignals(false);
+
+  this->ui->logLabel->setText(
+        "Log: "
+        + QString::number(this->meter->getLogLength())
+        + " s");
+
+  this->refreshUi();
+}
+
+// Edits that leave a row unreadable are reverted to what the meter has
+void
+BandMeterDialog::onItemChanged(void)
+{
+  if (static_cast<int>(this->getBands().size())
+      != this->ui->bandTable->rowCount()) {
+    if (this->meter != nullptr)
+      this->setBands(this->meter->getBands());
+    return;
+  }
+
+  emit bandsChanged();
+}
+
+void
+BandMeterDialog::onSelectionChanged(void)
+{
+  this->refreshUi();
+}
+
+void
+BandMeterDialog::onAdd(void)
+{
+  emit addBand();
+}
+
+void
+BandMeterDialog::onRemove(void)
+{
+  int row = this->ui->bandTable->currentRow();
+
+  if (row >= 0) {
+    this->ui->bandTable->removeRow(row);
+    this->refreshUi();
+    emit bandsChanged();
+  }
+}
+
+bool
+BandMeterDialog::exportLog(QString const &path) const
+{
+  QFile file(path);
+  std::vector<BandMeterBand> const &bands = this->meter->getBands();
+
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+    return false;
+
+  QTextStream out(&file);
+
+  out << "time";
+  for (auto const &band : bands)
+    out << ","
+        << csvQuote(
+             QString::fromStdString(band.name)
+             + " (" + QString::number(band.freq) + " Hz)");
+  out << "\n";
+
+  // Bands out of span are left empty
+  for (size_t i = 0; i < this->meter->getLogLength(); ++i) {
+    out << QDateTime::fromMSecsSinceEpoch(
+             this->meter->getLogTime(i)).toString(Qt::ISODate);
+
+    for (size_t b = 0; b < bands.size(); ++b) {
+      float power = this->meter->getLogPower(i, b);
+
+      out << ",";
+      if (!std::isnan(power))
+        out << QString::number(static_cast<double>(power), 'f', 2);
+    }
+
+    out << "\n";
+  }
+
+  out.flush();
+
+  return file.error() == QFile::NoError;
+}
+
+void
+BandMeterDialog::onExport(void)
+{
+  QString path;
+
+  if (this->meter == nullptr)
+    return;
+
+  path = QFileDialog::getSaveFileName(
+        this,
+        "Export band meter log",
+        QString(),
+        "CSV files (*.csv)");
+
+  if (!path.isEmpty() && !this->exportLog(path))
+    QMessageBox::critical(
+          this,
+          "Cannot save file",
+          "Band meter log could not be written to " + path,
+          QMessageBox::Ok);
+}
+
+void
+BandMeterDialog::onClearLog(void)
+{
+  if (this->meter != nullptr) {
+    this->meter->clearLog();
+    this->refreshUi();
+  }
+}
@@ -0,0 +1,123 @@
+//
+//    BandMeterView.cpp: Band power meter strip
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+#include "BandMeterView.h"
+#include <QPainter>
+#include <cmath>
+
+using namespace SigDigger;
+
+BandMeterView::BandMeterView(QWidget *parent) : QFrame(parent)
+{
+  this->setMinimumHeight(SIGDIGGER_BAND_METER_VIEW_HEIGHT);
+  this->setMaximumHeight(SIGDIGGER_BAND_METER_VIEW_HEIGHT);
+}
+
+void
+BandMeterView::setMeter(const BandMeter *meter)
+{
+  this->meter = meter;
+  this->update();
+}
+
+void
+BandMeterView::setCenterFreq(qint64 freq)
+{
+  this->centerFreq = freq;
+  this->update();
+}
+
+void
+BandMeterView::setSampleRate(qint64 rate)
+{
+  this->sampleRate = rate;
+  this->update();
+}
+
+void
+BandMeterView::setRange(float min, float max)
+{
+  this->min = min;
+  this->max = max;
+  this->update();
+}
+
+void
+BandMeterView::paintEvent(QPaintEvent *)
+{
+  QPainter painter(this);
+  qreal scale, height = this->height() - 1;
+  int baseline = this->height() - 1;
+
+  painter.fillRect(this->rect(), Qt::black);
+
+  if (this->meter == nullptr || this->sampleRate <= 0 || this->max <= this->min)
+    return;
+
+  scale = static_cast<qreal>(this->width()) / this->sampleRate;
+
+  for (size_t b = 0; b < this->meter->getBands().size(); ++b) {
+    BandMeterBand const &band = this->meter->getBands()[b];
+    BandMeterReading const &r = this->meter->getReadings()[b];
+    qreal x0 = (band.freq - band.bandwidth / 2 - this->centerFreq
+                + this->sampleRate / 2) * scale;
+    qreal x1 = (band.freq + band.bandwidth / 2 - this->centerFreq
+                + this->sampleRate / 2) * scale;
+    qreal fill, x;
+    QString text;
+    int textWidth;
+
+    if (!r.valid)
+      continue;
+
+    // At least two pixels wide, so narrow bands remain visible
+    if (x1 - x0 < 2) {
+      qreal center = .5 * (x0 + x1);
+      x0 = center - 1;
+      x1 = center + 1;
+    }
+
+    fill = static_cast<qreal>((r.level - this->min) / (this->max - this->min));
+    fill = std::min(std::max(fill, 0.), 1.) * height;
+
+    painter.fillRect(
+          QRectF(x0, baseline - fill, x1 - x0, fill),
+          QColor(0, 255, 0, 96));
+
+    // Bracket
+    painter.setPen(QColor(0, 255, 0, 192));
+    painter.drawLine(QPointF(x0, 0), QPointF(x0, baseline));
+    painter.drawLine(QPointF(x1, 0), QPointF(x1, baseline));
+    painter.drawLine(QPointF(x0, baseline), QPointF(x1, baseline));
+
+    text = QString::fromStdString(band.name);
+    if (!text.isEmpty())
+      text += ": ";
+    text += QString::number(static_cast<double>(r.power), 'f', 1) + " dB";
+
+    // Right of the band, unless that falls off the strip
+    textWidth = painter.fontMetrics().width(text);
+    x = x1 + 3;
+    if (x + textWidth > this->width())
+      x = x0 - 3 - textWidth;
+
+    painter.setPen(Qt::white);
+    painter.drawText(QPointF(x, painter.fontMetrics().ascent()), text);
+  }
+}
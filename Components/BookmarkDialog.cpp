@@ -0,0 +1,287 @@
+//
+//    BookmarkDialog.cpp: Bookmark and band plan list
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+
+#include "BookmarkDialog.h"
+#include "ui_BookmarkDialog.h"
+#include <QFileDialog>
+#include <QMessageBox>
+
+using namespace SigDigger;
+
+enum BookmarkColumn {
+  BOOKMARK_COLUMN_NAME,
+  BOOKMARK_COLUMN_FREQUENCY,
+  BOOKMARK_COLUMN_UPPER,
+  BOOKMARK_COLUMN_COUNT
+};
+
+BookmarkDialog::BookmarkDialog(QWidget *parent) :
+  QDialog(parent),
+  ui(new Ui::BookmarkDialog)
+{
+  ui->setupUi(this);
+
+  this->connectAll();
+  this->refreshUi();
+}
+
+BookmarkDialog::~BookmarkDialog()
+{
+  delete ui;
+}
+
+void
+BookmarkDialog::connectAll(void)
+{
+  connect(
+        this->ui->filterEdit,
+        SIGNAL(textChanged(QString)),
+        this,
+        SLOT(refresh(void)));
+
+  connect(
+        this->ui->bookmarkTable,
+        SIGNAL(itemSelectionChanged(void)),
+        this,
+        SLOT(onSelectionChanged(void)));
+
+  connect(
+        this->ui->bookmarkTable,
+        SIGNAL(cellDoubleClicked(int, int)),
+        this,
+        SLOT(onDoubleClicked(int, int)));
+
+  connect(
+        this->ui->addButton,
+        SIGNAL(clicked(bool)),
+        this,
+        SLOT(onAdd(void)));
+
+  connect(
+        this->ui->nameEdit,
+        SIGNAL(returnPressed(void)),
+        this,
+        SLOT(onAdd(void)));
+
+  connect(
+        this->ui->removeButton,
+        SIGNAL(clicked(bool)),
+        this,
+        SLOT(onRemove(void)));
+
+  connect(
+        this->ui->importButton,
+        SIGNAL(clicked(bool)),
+        this,
+        SLOT(onImport(void)));
+
+  connect(
+        this->ui->clearButton,
+        SIGNAL(clicked(bool)),
+        this,
+        SLOT(onClear(void)));
+}
+
+void
+BookmarkDialog::refreshUi(void)
+{
+  bool haveStore = this->store != nullptr;
+
+  this->ui->addButton->setEnabled(haveStore);
+  this->ui->importButton->setEnabled(haveStore);
+  this->ui->clearButton->setEnabled(haveStore && this->store->size() > 0);
+  this->ui->removeButton->setEnabled(
+        !this->ui->bookmarkTable->selectedItems().isEmpty());
+}
+
+void
+BookmarkDialog::setStore(BookmarkStore *store)
+{
+  this->store = store;
+  this->refresh();
+}
+
+//
+// Rows keep the index of their entry in the store, which is only valid
+// until the store changes: every change ends up calling this again.
+//
+void
+BookmarkDialog::refresh(void)
+{
+  QTableWidget *table = this->ui->bookmarkTable;
+  QString filter = this->ui->filterEdit->text().trimmed();
+  size_t matches = 0;
+  int row = 0;
+
+  table->setSortingEnabled(false);
+  table->setRowCount(0);
+
+  if (this->store != nullptr) {
+    for (size_t i = 0; i < this->store->size(); ++i) {
+      Bookmark const &b = (*this->store)[i];
+      QString name = QString::fromStdString(b.name);
+      QTableWidgetItem *item;
+
+      if (!filter.isEmpty() && !name.contains(filter, Qt::CaseInsensitive))
+        continue;
+
+      if (matches++ >= SIGDIGGER_BOOKMARK_DIALOG_MAX_ROWS)
+        continue;
+
+      table->insertRow(row);
+
+      item = new QTableWidgetItem(name);
+      item->setData(Qt::UserRole, static_cast<qulonglong>(i));
+      table->setItem(row, BOOKMARK_COLUMN_NAME, item);
+
+      item = new QTableWidgetItem();
+      item->setData(Qt::DisplayRole, b.lo);
+      table->setItem(row, BOOKMARK_COLUMN_FREQUENCY, item);
+
+      item = new QTableWidgetItem();
+      if (b.hi != b.lo)
+        item->setData(Qt::DisplayRole, b.hi);
+      table->setItem(row, BOOKMARK_COLUMN_UPPER, item);
+
+      ++row;
+    }
+  }
+
+  table->setSortingEnabled(true);
+
+  if (matches > SIGDIGGER_BOOKMARK_DIALOG_MAX_ROWS)
+    this->ui->countLabel->setText(
+          QString::number(SIGDIGGER_BOOKMARK_DIALOG_MAX_ROWS)
+          + " of "
+          + QString::number(matches)
+          + " shown");
+  else
+    this->ui->countLabel->setText(QString::number(matches) + " entries");
+
+  this->refreshUi();
+}
+
+void
+BookmarkDialog::onSelectionChanged(void)
+{
+  this->refreshUi();
+}
+
+void
+BookmarkDialog::onAdd(void)
+{
+  QString name = this->ui->nameEdit->text().trimmed();
+
+  if (this->store == nullptr)
+    return;
+
+  if (name.isEmpty())
+    name = "Bookmark " + QString::number(this->store->size() + 1);
+
+  this->ui->nameEdit->clear();
+
+  emit addBookmark(name);
+}
+
+void
+BookmarkDialog::onRemove(void)
+{
+  QTableWidget *table = this->ui->bookmarkTable;
+  int row = table->currentRow();
+  QTableWidgetItem *item;
+
+  if (this->store == nullptr || row < 0)
+    return;
+
+  item = table->item(row, BOOKMARK_COLUMN_NAME);
+  if (item != nullptr) {
+    this->store->remove(
+          static_cast<size_t>(item->data(Qt::UserRole).toULongLong()));
+    emit bookmarksChanged();
+  }
+}
+
+void
+BookmarkDialog::onImport(void)
+{
+  QString path;
+  QString error;
+  size_t added = 0;
+
+  if (this->store == nullptr)
+    return;
+
+  path = QFileDialog::getOpenFileName(
+        this,
+        "Import band plan",
+        QString(),
+        "CSV files (*.csv);;All files (*)");
+
+  if (path.isEmpty())
+    return;
+
+  if (!this->store->importCsv(path, added, error)) {
+    QMessageBox::critical(
+          this,
+          "Cannot import file",
+          "Bookmarks could not be imported from " + path + ": " + error,
+          QMessageBox::Ok);
+    return;
+  }
+
+  emit bookmarksChanged();
+}
+
+void
+BookmarkDialog::onClear(void)
+{
+  if (this->store == nullptr)
+    return;
+
+  if (QMessageBox::question(
+        this,
+        "Remove all bookmarks",
+        "Remove all "
+        + QString::number(this->store->size())
+        + " bookmarks and band plan entries?",
+        QMessageBox::Yes | QMessageBox::No) != QMessageBox::Yes)
+    return;
+
+  this->store->clear();
+  emit bookmarksChanged();
+}
+
+void
+BookmarkDialog::onDoubleClicked(int row, int)
+{
+  QTableWidgetItem *item = this->ui->bookmarkTable->item(
+        row,
+        BOOKMARK_COLUMN_NAME);
+  size_t index;
+
+  if (this->store == nullptr || item == nullptr)
+    return;
+
+  index = static_cast<size_t>(item->data(Qt::UserRole).toULongLong());
+  if (index < this->store->size()) {
+    Bookmark const &b = (*this->store)[index];
+    emit tune((b.lo + b.hi) / 2);
+  }
+}
@@ -0,0 +1,142 @@
+//
+//    BookmarkView.cpp: Bookmarks of the visible span
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+
+#include "BookmarkView.h"
+#include <QMouseEvent>
+#include <QPainter>
+#include <algorithm>
+#include <cmath>
+
+using namespace SigDigger;
+
+BookmarkView::BookmarkView(QWidget *parent) : QFrame(parent)
+{
+  this->setMinimumHeight(SIGDIGGER_BOOKMARK_VIEW_HEIGHT);
+  this->setMaximumHeight(SIGDIGGER_BOOKMARK_VIEW_HEIGHT);
+}
+
+void
+BookmarkView::setStore(const BookmarkStore *store)
+{
+  this->store = store;
+  this->update();
+}
+
+void
+BookmarkView::setCenterFreq(qint64 freq)
+{
+  this->centerFreq = freq;
+  this->update();
+}
+
+void
+BookmarkView::setSpan(qint64 span)
+{
+  this->span = span;
+  this->update();
+}
+
+void
+BookmarkView::paintEvent(QPaintEvent *)
+{
+  QPainter painter(this);
+  qint64 from = this->centerFreq - this->span / 2;
+  qreal scale;
+  qreal lastLabel = -INFINITY;
+  int half = this->height() / 2;
+  int ascent = painter.fontMetrics().ascent();
+
+  painter.fillRect(this->rect(), Qt::black);
+  this->marks.clear();
+
+  if (this->store == nullptr || this->span <= 0)
+    return;
+
+  scale = static_cast<qreal>(this->width()) / this->span;
+
+  this->store->query(
+        from,
+        from + this->span,
+        this->visible,
+        SIGDIGGER_BOOKMARK_VIEW_MAX);
+
+  for (auto i : this->visible) {
+    Bookmark const &b = (*this->store)[i];
+    QColor color = b.color.isValid() ? b.color : QColor(Qt::yellow);
+    QString text = QString::fromStdString(b.name);
+    qreal x0 = (b.lo - from) * scale;
+    qreal x1 = (b.hi - from) * scale;
+    int textWidth = painter.fontMetrics().width(text);
+
+    if (b.hi > b.lo) {
+      // Band plan entry: a bar over the top half, named inside if it fits
+      QRectF bar(x0, 0, std::max(x1 - x0, 1.), half - 1);
+
+      color.setAlpha(96);
+      painter.fillRect(bar, color);
+      color.setAlpha(255);
+      painter.setPen(color);
+      painter.drawRect(bar);
+
+      if (x1 - x0 > textWidth + 4) {
+        painter.setPen(Qt::white);
+        painter.drawText(
+              QPointF(std::max(x0, 0.) + 2, ascent),
+              text);
+      }
+
+      this->marks.push_back({x0, x1, (b.lo + b.hi) / 2});
+    } else {
+      painter.setPen(color);
+      painter.drawLine(QPointF(x0, half), QPointF(x0, this->height()));
+
+      if (x0 + 3 > lastLabel) {
+        painter.drawText(QPointF(x0 + 3, half + ascent), text);
+        lastLabel = x0 + 3 + textWidth + 6;
+      }
+
+      this->marks.push_back({x0, x0, b.lo});
+    }
+  }
+}
+
+void
+BookmarkView::mousePressEvent(QMouseEvent *event)
+{
+  qreal best = SIGDIGGER_BOOKMARK_VIEW_CLICK_DIST;
+  qint64 freq = 0;
+  bool found = false;
+
+  // Anywhere over a band counts as distance zero
+  for (auto const &mark : this->marks) {
+    qreal dist = std::max(
+          std::max(mark.x0 - event->x(), event->x() - mark.x1),
+          0.);
+
+    if (dist <= best) {
+      best  = dist;
+      freq  = mark.freq;
+      found = true;
+    }
+  }
+
+  if (found)
+    emit bookmarkSelected(freq);
+}
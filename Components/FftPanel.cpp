@@ -20,6 +20,7 @@
 #include "DefaultGradient.h"
 #include "FftPanel.h"
 #include "ui_FftPanel.h"
+#include <QDir>
 
 using namespace SigDigger;
 
@@ -41,8 +42,27 @@ FftPanelConfig::deserialize(Suscan::Object const &conf)
   LOAD(wfRangeMax);
   LOAD(palette);
   LOAD(zoom);
+  LOAD(zoomSpectrum);
+  LOAD(autoFft);
+  LOAD(cpuTarget);
   LOAD(rangeLock);
   LOAD(timeSpan);
+  LOAD(detector);
+  LOAD(averager);
+  LOAD(averagerWindow);
+  LOAD(averagerDecay);
+  LOAD(averagerLinear);
+  LOAD(persistence);
+  LOAD(persistenceTime);
+  LOAD(historyEnabled);
+  LOAD(historyPath);
+  LOAD(historySize);
+  LOAD(spectrumLogFolder);
+  LOAD(spectrumLogInterval);
+  LOAD(spectrumLogMax);
+  LOAD(spectrumLogBits);
+  LOAD(spectrumLogWidth);
+  LOAD(replaySpeed);
 }
 
 Suscan::Object &&
@@ -62,8 +82,27 @@ FftPanelConfig::serialize(void)
   STORE(wfRangeMax);
   STORE(palette);
   STORE(zoom);
+  STORE(zoomSpectrum);
+  STORE(autoFft);
+  STORE(cpuTarget);
   STORE(rangeLock);
   STORE(timeSpan);
+  STORE(detector);
+  STORE(averager);
+  STORE(averagerWindow);
+  STORE(averagerDecay);
+  STORE(averagerLinear);
+  STORE(persistence);
+  STORE(persistenceTime);
+  STORE(historyEnabled);
+  STORE(historyPath);
+  STORE(historySize);
+  STORE(spectrumLogFolder);
+  STORE(spectrumLogInterval);
+  STORE(spectrumLogMax);
+  STORE(spectrumLogBits);
+  STORE(spectrumLogWidth);
+  STORE(replaySpeed);
 
   return this->persist(obj);
 }
@@ -89,10 +128,52 @@ FftPanel::applyConfig(void)
   this->setWfRangeMin(savedConfig.wfRangeMin);
   this->setPalette(savedConfig.palette);
   this->setFreqZoom(savedConfig.zoom);
+  this->setZoomSpectrum(savedConfig.zoomSpectrum);
   this->setPeakHold(savedConfig.peakHold);
   this->setPeakDetect(savedConfig.peakDetect);
   this->setRangeLock(savedConfig.rangeLock);
   this->setTimeSpan(savedConfig.timeSpan);
+  this->setCpuTarget(savedConfig.cpuTarget);
+  this->setAutoFft(savedConfig.autoFft);
+
+  if (savedConfig.detector == "mean")
+    this->setDetector(Suscan::PSDMessage::DETECTOR_MEAN);
+  else if (savedConfig.detector == "min")
+    this->setDetector(Suscan::PSDMessage::DETECTOR_MIN);
+  else
+    this->setDetector(Suscan::PSDMessage::DETECTOR_PEAK);
+
+  this->setAveragerWindow(savedConfig.averagerWindow);
+  this->setAveragerDecay(savedConfig.averagerDecay);
+  this->setAveragerLinear(savedConfig.averagerLinear);
+
+  if (savedConfig.averager == "window")
+    this->setAveragerMode(Averager::MODE_WINDOW);
+  else if (savedConfig.averager == "max")
+    this->setAveragerMode(Averager::MODE_MAX_HOLD);
+  else if (savedConfig.averager == "min")
+    this->setAveragerMode(Averager::MODE_MIN_HOLD);
+  else
+    this->setAveragerMode(Averager::MODE_EXPONENTIAL);
+
+  this->setPersistenceTime(savedConfig.persistenceTime);
+  this->setPersistence(savedConfig.persistence);
+
+  if (savedConfig.historyPath.empty())
+    this->panelConfig->historyPath =
+        (QDir::homePath() + "/.suscan/waterfall.history").toStdString();
+
+  this->setHistoryEnabled(savedConfig.historyEnabled);
+
+  if (savedConfig.spectrumLogFolder.empty())
+    this->panelConfig->spectrumLogFolder = QDir::homePath().toStdString();
+
+  // Not restored: a log is started by hand, into a new file
+  this->ui->logIntervalSpin->setValue(
+        static_cast<int>(savedConfig.spectrumLogInterval));
+  this->ui->logMaxCheck->setChecked(savedConfig.spectrumLogMax);
+  this->ui->logBitsCombo->setCurrentIndex(
+        savedConfig.spectrumLogBits == 16 ? 1 : 0);
 }
 
 void
@@ -200,6 +281,120 @@ FftPanel::connectAll(void)
         SIGNAL(activated(int)),
         this,
         SLOT(onWindowFunctionChanged(void)));
+
+  connect(
+        this->ui->detectorCombo,
+        SIGNAL(activated(int)),
+        this,
+        SLOT(onDetectorChanged(void)));
+
+  connect(
+        this->ui->averagerCombo,
+        SIGNAL(activated(int)),
+        this,
+        SLOT(onAveragerModeChanged(void)));
+
+  connect(
+        this->ui->windowSpin,
+        SIGNAL(valueChanged(int)),
+        this,
+        SLOT(onAveragerParamsChanged(void)));
+
+  connect(
+        this->ui->decaySpin,
+        SIGNAL(valueChanged(double)),
+        this,
+        SLOT(onAveragerParamsChanged(void)));
+
+  connect(
+        this->ui->linearCheck,
+        SIGNAL(stateChanged(int)),
+        this,
+        SLOT(onAveragerParamsChanged(void)));
+
+  connect(
+        this->ui->autoFftCheck,
+        SIGNAL(stateChanged(int)),
+        this,
+        SLOT(onAutoFftChanged(void)));
+
+  connect(
+        this->ui->cpuTargetSpin,
+        SIGNAL(valueChanged(int)),
+        this,
+        SLOT(onAutoFftChanged(void)));
+
+  connect(
+        this->ui->zoomSpectrumCheck,
+        SIGNAL(stateChanged(int)),
+        this,
+        SLOT(onZoomSpectrumChanged(void)));
+
+  connect(
+        this->ui->persistenceCheck,
+        SIGNAL(stateChanged(int)),
+        this,
+        SLOT(onPersistenceChanged(void)));
+
+  connect(
+        this->ui->persistenceSpin,
+        SIGNAL(valueChanged(double)),
+        this,
+        SLOT(onPersistenceChanged(void)));
+
+  connect(
+        this->ui->historyButton,
+        SIGNAL(clicked(bool)),
+        this,
+        SLOT(onHistoryToggled(void)));
+
+  connect(
+        this->ui->browseHistoryButton,
+        SIGNAL(clicked(bool)),
+        this,
+        SLOT(onBrowseHistory(void)));
+
+  connect(
+        this->ui->logButton,
+        SIGNAL(clicked(bool)),
+        this,
+        SLOT(onSpectrumLogToggled(void)));
+
+  connect(
+        this->ui->replayButton,
+        SIGNAL(clicked(bool)),
+        this,
+        SLOT(onReplayToggled(void)));
+
+  connect(
+        this->ui->logIntervalSpin,
+        SIGNAL(valueChanged(int)),
+        this,
+        SLOT(onSpectrumLogParamsChanged(void)));
+
+  connect(
+        this->ui->logMaxCheck,
+        SIGNAL(stateChanged(int)),
+        this,
+        SLOT(onSpectrumLogParamsChanged(void)));
+
+  connect(
+        this->ui->logBitsCombo,
+        SIGNAL(activated(int)),
+        this,
+        SLOT(onSpectrumLogParamsChanged(void)));
+
+  connect(
+        this->ui->trackPeaksButton,
+        SIGNAL(clicked(bool)),
+        this,
+        SLOT(onTrackPeaks(void)));
+
+  connect(
+        this->ui->autoRangeButton,
+        SIGNAL(clicked(bool)),
+        this,
+        SLOT(onAutoRange(void)));
 }
 
 FftPanel::FftPanel(QWidget *parent) :
@@ -416,6 +611,14 @@ FftPanel::getPaletteGradient(void) const
   return this->palettes[0].getGradient();
 }
 
+Palette const &
+FftPanel::getSelectedPalette(void) const
+{
+  if (this->selected != nullptr)
+    return *this->selected;
+  return this->palettes[0];
+}
+
 unsigned int
 FftPanel::getFreqZoom(void) const
 {
@@ -428,6 +631,12 @@ FftPanel::getFftSize(void) const
   return this->fftSize;
 }
 
+std::vector<unsigned int> const &
+FftPanel::getFftSizes(void) const
+{
+  return this->sizes;
+}
+
 unsigned int
 FftPanel::getTimeSpan(void) const
 {
@@ -465,6 +674,136 @@ FftPanel::getWindowFunction(void) const
         this->ui->windowCombo->currentIndex());
 }
 
+enum Suscan::PSDMessage::Detector
+FftPanel::getDetector(void) const
+{
+  return static_cast<enum Suscan::PSDMessage::Detector>(
+        this->ui->detectorCombo->currentIndex());
+}
+
+enum Averager::Mode
+FftPanel::getAveragerMode(void) const
+{
+  return static_cast<enum Averager::Mode>(
+        this->ui->averagerCombo->currentIndex());
+}
+
+unsigned int
+FftPanel::getAveragerWindow(void) const
+{
+  return static_cast<unsigned int>(this->ui->windowSpin->value());
+}
+
+float
+FftPanel::getAveragerDecay(void) const
+{
+  return static_cast<float>(this->ui->decaySpin->value());
+}
+
+bool
+FftPanel::getAveragerLinear(void) const
+{
+  return this->ui->linearCheck->isChecked();
+}
+
+bool
+FftPanel::getAutoFft(void) const
+{
+  return this->ui->autoFftCheck->isChecked();
+}
+
+float
+FftPanel::getCpuTarget(void) const
+{
+  return .01f * this->ui->cpuTargetSpin->value();
+}
+
+bool
+FftPanel::getZoomSpectrum(void) const
+{
+  return this->ui->zoomSpectrumCheck->isChecked();
+}
+
+bool
+FftPanel::getPersistence(void) const
+{
+  return this->ui->persistenceCheck->isChecked();
+}
+
+float
+FftPanel::getPersistenceTime(void) const
+{
+  return static_cast<float>(this->ui->persistenceSpin->value());
+}
+
+bool
+FftPanel::getHistoryEnabled(void) const
+{
+  return this->ui->historyButton->isChecked();
+}
+
+std::string
+FftPanel::getHistoryPath(void) const
+{
+  return this->panelConfig->historyPath;
+}
+
+quint64
+FftPanel::getHistorySize(void) const
+{
+  return static_cast<quint64>(this->panelConfig->historySize) << 20;
+}
+
+bool
+FftPanel::getSpectrumLogEnabled(void) const
+{
+  return this->ui->logButton->isChecked();
+}
+
+std::string
+FftPanel::getSpectrumLogFolder(void) const
+{
+  return this->panelConfig->spectrumLogFolder;
+}
+
+unsigned int
+FftPanel::getSpectrumLogInterval(void) const
+{
+  return static_cast<unsigned int>(this->ui->logIntervalSpin->value());
+}
+
+enum SpectrumRecorder::Mode
+FftPanel::getSpectrumLogMode(void) const
+{
+  return this->ui->logMaxCheck->isChecked()
+      ? SpectrumRecorder::MODE_MAX
+      : SpectrumRecorder::MODE_DECIMATE;
+}
+
+unsigned int
+FftPanel::getSpectrumLogBits(void) const
+{
+  return this->ui->logBitsCombo->currentIndex() == 1 ? 16 : 8;
+}
+
+unsigned int
+FftPanel::getSpectrumLogWidth(void) const
+{
+  return this->panelConfig->spectrumLogWidth;
+}
+
+bool
+FftPanel::getReplaying(void) const
+{
+  return this->ui->replayButton->isChecked();
+}
+
+unsigned int
+FftPanel::getReplaySpeed(void) const
+{
+  return this->panelConfig->replaySpeed;
+}
+
 ///////////////////////////////// Setters //////////////////////////////////////
 bool
 FftPanel::setPalette(std::string const &str)
@@ -612,6 +951,115 @@ FftPanel::setWindowFunction(enum Suscan::AnalyzerParams::WindowFunction func)
   this->ui->windowCombo->setCurrentIndex(static_cast<int>(func));
 }
 
+void
+FftPanel::setDetector(enum Suscan::PSDMessage::Detector det)
+{
+  this->ui->detectorCombo->setCurrentIndex(static_cast<int>(det));
+  this->onDetectorChanged();
+}
+
+void
+FftPanel::setAveragerMode(enum Averager::Mode mode)
+{
+  this->ui->averagerCombo->setCurrentIndex(static_cast<int>(mode));
+  this->onAveragerModeChanged();
+}
+
+void
+FftPanel::setAveragerWindow(unsigned int frames)
+{
+  this->ui->windowSpin->setValue(static_cast<int>(frames));
+  this->panelConfig->averagerWindow = frames;
+}
+
+void
+FftPanel::setAveragerDecay(float dB)
+{
+  this->ui->decaySpin->setValue(static_cast<double>(dB));
+  this->panelConfig->averagerDecay = dB;
+}
+
+void
+FftPanel::setAveragerLinear(bool linear)
+{
+  this->ui->linearCheck->setChecked(linear);
+  this->panelConfig->averagerLinear = linear;
+}
+
+void
+FftPanel::setAutoFft(bool enabled)
+{
+  this->ui->autoFftCheck->setChecked(enabled);
+  this->ui->cpuTargetSpin->setEnabled(enabled);
+  this->panelConfig->autoFft = enabled;
+
+  if (!enabled)
+    this->ui->governorLabel->setText("Manual");
+}
+
+void
+FftPanel::setCpuTarget(unsigned int percent)
+{
+  this->ui->cpuTargetSpin->setValue(static_cast<int>(percent));
+  this->panelConfig->cpuTarget = percent;
+}
+
+void
+FftPanel::setGovernorDecision(
+    unsigned int size,
+    unsigned int rate,
+    QString const &reason)
+{
+  this->ui->governorLabel->setText(
+        QString::number(size)
+        + ", "
+        + QString::number(rate)
+        + " fps"
+        + (reason.isEmpty() ? "" : " (" + reason + ")"));
+}
+
+void
+FftPanel::setZoomSpectrum(bool enabled)
+{
+  this->ui->zoomSpectrumCheck->setChecked(enabled);
+  this->panelConfig->zoomSpectrum = enabled;
+}
+
+void
+FftPanel::setPersistence(bool enabled)
+{
+  this->ui->persistenceCheck->setChecked(enabled);
+  this->panelConfig->persistence = enabled;
+}
+
+void
+FftPanel::setPersistenceTime(float seconds)
+{
+  this->ui->persistenceSpin->setValue(static_cast<double>(seconds));
+  this->panelConfig->persistenceTime = seconds;
+}
+
+void
+FftPanel::setHistoryEnabled(bool enabled)
+{
+  this->ui->historyButton->setChecked(enabled);
+  this->panelConfig->historyEnabled = enabled;
+}
+
+// Bits cannot change in the middle of a file
+void
+FftPanel::setSpectrumLogEnabled(bool enabled)
+{
+  this->ui->logButton->setChecked(enabled);
+  this->ui->logBitsCombo->setEnabled(!enabled);
+}
+
+void
+FftPanel::setReplaying(bool replaying)
+{
+  this->ui->replayButton->setChecked(replaying);
+}
+
 ///////////////////////////////// Slots ///////////////////////////////////////
 void
 FftPanel::onPandRangeChanged(int min, int max)
@@ -728,3 +1176,141 @@ FftPanel::onWindowFunctionChanged(void)
 {
   emit windowFunctionChanged();
 }
+
+void
+FftPanel::onDetectorChanged(void)
+{
+  switch (this->getDetector()) {
+    case Suscan::PSDMessage::DETECTOR_PEAK:
+      this->panelConfig->detector = "peak";
+      break;
+
+    case Suscan::PSDMessage::DETECTOR_MEAN:
+      this->panelConfig->detector = "mean";
+      break;
+
+    case Suscan::PSDMessage::DETECTOR_MIN:
+      this->panelConfig->detector = "min";
+      break;
+  }
+}
+
+void
+FftPanel::onAveragerModeChanged(void)
+{
+  enum Averager::Mode mode = this->getAveragerMode();
+  bool average = mode == Averager::MODE_EXPONENTIAL
+      || mode == Averager::MODE_WINDOW;
+
+  switch (mode) {
+    case Averager::MODE_EXPONENTIAL:
+      this->panelConfig->averager = "exponential";
+      break;
+
+    case Averager::MODE_WINDOW:
+      this->panelConfig->averager = "window";
+      break;
+
+    case Averager::MODE_MAX_HOLD:
+      this->panelConfig->averager = "max";
+      break;
+
+    case Averager::MODE_MIN_HOLD:
+      this->panelConfig->averager = "min";
+      break;
+  }
+
+  // Only the knobs of the selected mode are enabled
+  this->ui->fftAvgSlider->setEnabled(mode == Averager::MODE_EXPONENTIAL);
+  this->ui->windowSpin->setEnabled(mode == Averager::MODE_WINDOW);
+  this->ui->decaySpin->setEnabled(mode == Averager::MODE_MAX_HOLD);
+  this->ui->linearCheck->setEnabled(average);
+
+  emit averagerChanged();
+}
+
+void
+FftPanel::onAveragerParamsChanged(void)
+{
+  this->panelConfig->averagerWindow = this->getAveragerWindow();
+  this->panelConfig->averagerDecay  = this->getAveragerDecay();
+  this->panelConfig->averagerLinear = this->getAveragerLinear();
+
+  emit averagerChanged();
+}
+
+void
+FftPanel::onAutoFftChanged(void)
+{
+  this->setAutoFft(this->getAutoFft());
+  this->panelConfig->cpuTarget =
+      static_cast<unsigned int>(this->ui->cpuTargetSpin->value());
+
+  emit autoFftChanged();
+}
+
+void
+FftPanel::onZoomSpectrumChanged(void)
+{
+  this->panelConfig->zoomSpectrum = this->getZoomSpectrum();
+
+  emit zoomSpectrumChanged();
+}
+
+void
+FftPanel::onPersistenceChanged(void)
+{
+  this->panelConfig->persistence     = this->getPersistence();
+  this->panelConfig->persistenceTime = this->getPersistenceTime();
+
+  emit persistenceChanged();
+}
+
+void
+FftPanel::onHistoryToggled(void)
+{
+  this->setHistoryEnabled(this->getHistoryEnabled());
+  emit historyChanged();
+}
+
+void
+FftPanel::onBrowseHistory(void)
+{
+  emit browseHistory();
+}
+
+void
+FftPanel::onSpectrumLogToggled(void)
+{
+  this->setSpectrumLogEnabled(this->getSpectrumLogEnabled());
+  emit spectrumLogChanged();
+}
+
+void
+FftPanel::onSpectrumLogParamsChanged(void)
+{
+  this->panelConfig->spectrumLogInterval = this->getSpectrumLogInterval();
+  this->panelConfig->spectrumLogMax =
+      this->getSpectrumLogMode() == SpectrumRecorder::MODE_MAX;
+  this->panelConfig->spectrumLogBits = this->getSpectrumLogBits();
+
+  emit spectrumLogChanged();
+}
+
+void
+FftPanel::onReplayToggled(void)
+{
+  emit replayChanged();
+}
+
+void
+FftPanel::onTrackPeaks(void)
+{
+  emit trackPeaks();
+}
+
+void
+FftPanel::onAutoRange(void)
+{
+  emit autoRange();
+}
@@ -19,6 +19,9 @@
 
 #include "MainSpectrum.h"
 #include "ui_MainSpectrum.h"
+#include <QGuiApplication>
+#include <QScreen>
+#include <cmath>
 
 using namespace SigDigger;
 
@@ -26,9 +29,27 @@ MainSpectrum::MainSpectrum(QWidget *parent) :
   QWidget(parent),
   ui(new Ui::MainSpectrum)
 {
+  QScreen *screen = QGuiApplication::primaryScreen();
+  qreal fps = screen != nullptr ? screen->refreshRate() : 0;
+
   ui->setupUi(this);
+  this->ui->persistenceView->hide();
+  this->ui->bandMeterView->hide();
+  this->ui->referenceView->hide();
+  this->ui->bookmarkView->hide();
+
+  this->renderTimer = new QTimer(this);
+  this->renderTimer->setTimerType(Qt::PreciseTimer);
+
   this->connectAll();
   this->setCenterFreq(0);
+
+  // Paint at the display refresh rate, within reason
+  if (fps < 1 || fps > SIGDIGGER_SPECTRUM_MAX_FPS)
+    fps = SIGDIGGER_SPECTRUM_MAX_FPS;
+
+  this->setRenderRate(static_cast<unsigned int>(std::round(fps)));
+  this->statsClock.start();
 }
 
 MainSpectrum::~MainSpectrum()
@@ -80,12 +101,124 @@ MainSpectrum::connectAll(void)
         SIGNAL(newZoomLevel(float)),
         this,
         SLOT(onNewZoomLevel(float)));
+
+  connect(
+        this->ui->bookmarkView,
+        SIGNAL(bookmarkSelected(qint64)),
+        this,
+        SIGNAL(bookmarkSelected(qint64)));
+
+  connect(
+        this->renderTimer,
+        SIGNAL(timeout(void)),
+        this,
+        SLOT(onRenderTick(void)));
+}
+
+//
+// PSD updates are only stored here. Painting is driven by renderTimer, so
+// the repaint rate no longer depends on how often the analyzer sends
+// PSDs. Every tick adds exactly one waterfall line: PSDs arriving faster
+// than that are dropped (only the latest one is painted) and, if they
+// arrive slower, the last one is painted again. Either way waterfall
+// lines stay evenly spaced in time.
+//
+void
+MainSpectrum::schedule(float *data, int size)
+{
+  if (this->fresh)
+    ++this->stats.skipped;
+
+  this->frame     = data;
+  this->frameSize = size;
+  this->fresh     = true;
+
+  if (this->renderTimer->isActive()) {
+    qreal elapsed = static_cast<qreal>(this->feedClock.restart());
+
+    if (this->psdInterval <= 0)
+      this->psdInterval = elapsed;
+    else
+      this->psdInterval += .25 * (elapsed - this->psdInterval);
+  } else {
+    this->feedClock.start();
+    this->renderTimer->start();
+  }
 }
 
 void
 MainSpectrum::feed(float *data, int size)
 {
-  this->ui->mainSpectrum->setNewFftData(data, size);
+  if (this->zoomRate == 0)
+    this->schedule(data, size);
+
+  // Hits fade to 1/e after persistenceTime, whatever the PSD rate is
+  if (this->persistence) {
+    if (this->psdInterval > 0)
+      this->ui->persistenceView->setDecay(
+            static_cast<float>(
+              std::exp(-1e-3 * this->psdInterval / this->persistenceTime)));
+    this->ui->persistenceView->feed(data, size);
+  }
+}
+
+//
+// The waterfall widget maps every frame to its sample rate, and shows
+// the span set by the zoom around the center. Giving it the width of
+// the zoom frames as sample rate is all it takes to paint them.
+//
+// Zoom frames are centered on the tuner frequency, while the widget
+// shows its span around the FFT center, which wheel zooms and drags move
+// away from it. Such a view would paint the frames off by the pan, so
+// the FFT center is pinned back to the tuner frequency with every frame.
+//
+void
+MainSpectrum::feedZoomSpectrum(float *data, int size, unsigned int rate)
+{
+  if (rate == 0)
+    return;
+
+  if (rate != this->zoomRate) {
+    this->ui->mainSpectrum->setSampleRate(rate);
+    this->zoomRate = rate;
+  }
+
+  this->ui->mainSpectrum->setFftCenterFreq(0);
+  this->schedule(data, size);
+}
+
+void
+MainSpectrum::leaveZoomSpectrum(void)
+{
+  if (this->zoomRate != 0) {
+    this->zoomRate = 0;
+    this->ui->mainSpectrum->setSampleRate(this->cachedRate);
+    this->ui->mainSpectrum->setSpanFreq(this->cachedRate / this->zoom);
+
+    // Do not repaint a zoom frame as if it covered the whole rate
+    this->frame = nullptr;
+    this->fresh = false;
+  }
+}
+
+void
+MainSpectrum::refreshRenderUi(SpectrumRenderStats const &stats)
+{
+  this->ui->renderLabel->setText(
+        "  Render: "
+        + QString::number(stats.fps, 'f', 1)
+        + " fps, "
+        + QString::number(stats.meanMs, 'f', 1)
+        + " ms (max "
+        + QString::number(stats.maxMs, 'f', 1)
+        + " ms)");
+
+  this->ui->frameLabel->setText(
+        "  Frames: "
+        + QString::number(stats.skipped)
+        + " skipped, "
+        + QString::number(stats.repeated)
+        + " repeated");
 }
 
 void
@@ -128,6 +261,15 @@ MainSpectrum::setTimeSpan(quint64 span)
   this->ui->mainSpectrum->setWaterfallSpan(span * 1000);
 }
 
+void
+MainSpectrum::setRenderRate(unsigned int fps)
+{
+  if (fps > 0) {
+    this->renderRate = fps;
+    this->renderTimer->setInterval(static_cast<int>(1000 / fps));
+  }
+}
+
 void
 MainSpectrum::setCaptureMode(CaptureMode mode)
 {
@@ -158,6 +300,8 @@ MainSpectrum::setCenterFreq(qint64 freq)
 {
   this->ui->fcLcd->setValue(freq);
   this->ui->mainSpectrum->setCenterFreq(static_cast<quint64>(freq));
+  this->ui->bandMeterView->setCenterFreq(freq);
+  this->ui->bookmarkView->setCenterFreq(freq);
   this->ui->mainSpectrum->setFreqUnits(
         getFrequencyUnits(
           static_cast<qint64>(freq)));
@@ -187,6 +331,8 @@ void
 MainSpectrum::setPandapterRange(float min, float max)
 {
   this->ui->mainSpectrum->setPandapterRange(min, max);
+  this->ui->persistenceView->setRange(min, max);
+  this->ui->bandMeterView->setRange(min, max);
 }
 
 void
@@ -213,6 +359,60 @@ MainSpectrum::setPeakDetect(bool det)
   this->ui->mainSpectrum->setPeakDetection(det, 5);
 }
 
+void
+MainSpectrum::setPersistence(bool enabled)
+{
+  if (this->persistence != enabled) {
+    this->persistence = enabled;
+    this->ui->persistenceView->clear();
+    this->ui->persistenceView->setVisible(enabled);
+  }
+}
+
+void
+MainSpectrum::setPersistenceTime(qreal seconds)
+{
+  if (seconds > 0)
+    this->persistenceTime = seconds;
+}
+
+void
+MainSpectrum::setPersistencePalette(Palette const &palette)
+{
+  this->ui->persistenceView->setColorPalette(palette);
+}
+
+void
+MainSpectrum::setNoiseFloor(const float *floor, int size)
+{
+  this->ui->persistenceView->setNoiseFloor(floor, size);
+}
+
+void
+MainSpectrum::setReferenceDiff(const float *diff, int size, float threshold)
+{
+  bool show = diff != nullptr && size > 0;
+
+  this->ui->referenceView->setDiff(diff, size, threshold);
+  if (this->ui->referenceView->isHidden() == show)
+    this->ui->referenceView->setVisible(show);
+}
+
+void
+MainSpectrum::setBandMeter(const BandMeter *meter)
+{
+  this->ui->bandMeterView->setMeter(meter);
+  this->ui->bandMeterView->setVisible(
+        meter != nullptr && !meter->getBands().empty());
+}
+
+void
+MainSpectrum::setBookmarks(const BookmarkStore *store)
+{
+  this->ui->bookmarkView->setStore(store);
+  this->ui->bookmarkView->setVisible(store != nullptr && store->size() > 0);
+}
+
 
 void
 MainSpectrum::setColorConfig(ColorConfig const &cfg)
@@ -235,6 +435,8 @@ MainSpectrum::setColorConfig(ColorConfig const &cfg)
   this->ui->lnbLabel->setStyleSheet(styleSheet);
   this->ui->captureModeLabel->setStyleSheet(styleSheet);
   this->ui->throttlingLabel->setStyleSheet(styleSheet);
+  this->ui->renderLabel->setStyleSheet(styleSheet);
+  this->ui->frameLabel->setStyleSheet(styleSheet);
 
   this->ui->mainSpectrum->setFftPlotColor(cfg.spectrumForeground);
   this->ui->mainSpectrum->setFftAxesColor(cfg.spectrumAxes);
@@ -261,6 +463,7 @@ MainSpectrum::setZoom(unsigned int zoom)
     this->zoom = zoom;
     this->ui->mainSpectrum->setSpanFreq(
           this->cachedRate / zoom);
+    this->ui->bookmarkView->setSpan(this->cachedRate / zoom);
   }
 }
 
@@ -272,9 +475,13 @@ MainSpectrum::setSampleRate(unsigned int rate)
 
     this->ui->mainSpectrum->setDemodRanges(-freq / 2, 1, 1, freq / 2, true);
 
-    this->ui->mainSpectrum->setSampleRate(rate);
+    // Zoom frames keep their own width until leaveZoomSpectrum()
+    if (this->zoomRate == 0)
+      this->ui->mainSpectrum->setSampleRate(rate);
+    this->ui->bandMeterView->setSampleRate(rate);
 
     this->ui->mainSpectrum->setSpanFreq(rate / this->zoom);
+    this->ui->bookmarkView->setSpan(rate / this->zoom);
     this->ui->loLcd->setMin(-freq / 2);
     this->ui->loLcd->setMax(freq / 2);
 
@@ -319,6 +526,70 @@ MainSpectrum::getBandwidth(void) const
   return this->bandwidth;
 }
 
+unsigned int
+MainSpectrum::getZoom(void) const
+{
+  return this->zoom;
+}
+
+// PSD bins worth painting: one per pixel column of the visible span,
+// over the whole sample rate. While the zoom spectrum is painted, the
+// full-span one is only a fallback and one bin per column of the whole
+// rate is enough. This only sizes the display copy of the PSD: analysis
+// always gets the full FFT.
+unsigned int
+MainSpectrum::getDisplayBins(void) const
+{
+  int width = this->ui->mainSpectrum->width();
+
+  if (width <= 0)
+    return 0;
+
+  if (this->zoomRate != 0)
+    return static_cast<unsigned int>(width);
+
+  return static_cast<unsigned int>(width) * this->zoom;
+}
+
+unsigned int
+MainSpectrum::getRenderRate(void) const
+{
+  return this->renderRate;
+}
+
+bool
+MainSpectrum::getPersistence(void) const
+{
+  return this->persistence;
+}
+
+qint64
+MainSpectrum::getRenderTime(void) const
+{
+  return this->totalRenderNs;
+}
+
+SpectrumRenderStats
+MainSpectrum::getRenderStats(void)
+{
+  SpectrumRenderStats stats = this->stats;
+  qint64 elapsed = this->statsClock.restart();
+
+  if (elapsed > 0)
+    stats.fps = 1e3 * stats.rendered / elapsed;
+
+  if (stats.rendered > 0)
+    stats.meanMs = 1e-6 * this->renderNs / stats.rendered;
+
+  stats.maxMs = 1e-6 * this->maxRenderNs;
+
+  this->stats = SpectrumRenderStats();
+  this->renderNs = 0;
+  this->maxRenderNs = 0;
+
+  return stats;
+}
+
 //////////////////////////////// Slots /////////////////////////////////////////
 void
 MainSpectrum::onWfBandwidthChanged(int min, int max)
@@ -360,6 +631,8 @@ MainSpectrum::onLoChanged(void)
 void
 MainSpectrum::onRangeChanged(float min, float max)
 {
+  this->ui->persistenceView->setRange(min, max);
+  this->ui->bandMeterView->setRange(min, max);
   emit rangeChanged(min, max);
 }
 
@@ -368,3 +641,46 @@ MainSpectrum::onNewZoomLevel(float level)
 {
   emit zoomChanged(level);
 }
+
+void
+MainSpectrum::onRenderTick(void)
+{
+  QElapsedTimer timer;
+  qint64 ns;
+
+  if (!this->fresh) {
+    qreal stall = 3 * this->psdInterval;
+
+    if (stall < SIGDIGGER_SPECTRUM_STALL_MS)
+      stall = SIGDIGGER_SPECTRUM_STALL_MS;
+
+    // Source paused or gone: do not scroll the waterfall on our own
+    if (this->frame == nullptr || this->feedClock.elapsed() > stall) {
+      this->renderTimer->stop();
+      this->refreshRenderUi(this->getRenderStats());
+      return;
+    }
+
+    ++this->stats.repeated;
+  }
+
+  timer.start();
+  this->ui->mainSpectrum->setNewFftData(this->frame, this->frameSize);
+  if (this->persistence && this->fresh)
+    this->ui->persistenceView->update();
+  if (this->ui->bandMeterView->isVisible() && this->fresh)
+    this->ui->bandMeterView->update();
+  if (this->ui->referenceView->isVisible() && this->fresh)
+    this->ui->referenceView->update();
+  ns = timer.nsecsElapsed();
+
+  this->fresh = false;
+  ++this->stats.rendered;
+  this->renderNs += ns;
+  this->totalRenderNs += ns;
+  if (ns > this->maxRenderNs)
+    this->maxRenderNs = ns;
+
+  if (this->statsClock.elapsed() >= 1000)
+    this->refreshRenderUi(this->getRenderStats());
+}
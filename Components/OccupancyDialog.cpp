@@ -0,0 +1,241 @@
+//
+//    OccupancyDialog.cpp: Spectrum occupancy statistics
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+
+#include "OccupancyDialog.h"
+#include "ui_OccupancyDialog.h"
+#include <QDateTime>
+#include <QFileDialog>
+#include <QMessageBox>
+
+using namespace SigDigger;
+
+OccupancyDialog::OccupancyDialog(QWidget *parent) :
+  QDialog(parent),
+  ui(new Ui::OccupancyDialog)
+{
+  ui->setupUi(this);
+
+  this->exporter = new OccupancyExporter(this);
+
+  this->refreshTimer = new QTimer(this);
+  this->refreshTimer->setInterval(SIGDIGGER_OCCUPANCY_DIALOG_REFRESH_MS);
+
+  this->connectAll();
+  this->refreshUi();
+
+  this->refreshTimer->start();
+}
+
+OccupancyDialog::~OccupancyDialog()
+{
+  delete ui;
+}
+
+void
+OccupancyDialog::connectAll(void)
+{
+  connect(
+        this->refreshTimer,
+        SIGNAL(timeout(void)),
+        this,
+        SLOT(onRefresh(void)));
+
+  connect(
+        this->ui->thresholdSpin,
+        SIGNAL(valueChanged(double)),
+        this,
+        SLOT(onParamsChanged(void)));
+
+  connect(
+        this->ui->relativeCheck,
+        SIGNAL(stateChanged(int)),
+        this,
+        SLOT(onParamsChanged(void)));
+
+  connect(
+        this->ui->resetButton,
+        SIGNAL(clicked(bool)),
+        this,
+        SLOT(onReset(void)));
+
+  connect(
+        this->ui->exportCsvButton,
+        SIGNAL(clicked(bool)),
+        this,
+        SLOT(onExportCsv(void)));
+
+  connect(
+        this->ui->exportPngButton,
+        SIGNAL(clicked(bool)),
+        this,
+        SLOT(onExportPng(void)));
+
+  connect(
+        this->exporter,
+        SIGNAL(finished(QString, QString)),
+        this,
+        SLOT(onExportFinished(QString, QString)));
+}
+
+void
+OccupancyDialog::setOccupancy(Occupancy *occupancy)
+{
+  this->occupancy = occupancy;
+  this->onParamsChanged();
+}
+
+void
+OccupancyDialog::setColorPalette(Palette const &palette)
+{
+  this->palette = palette;
+}
+
+bool
+OccupancyDialog::isRunning(void) const
+{
+  return this->ui->runButton->isChecked();
+}
+
+void
+OccupancyDialog::refreshUi(void)
+{
+  bool haveData = this->occupancy != nullptr
+      && this->occupancy->getFrames() > 0;
+  bool idle = !this->exporter->isBusy();
+
+  this->ui->exportCsvButton->setEnabled(haveData && idle);
+  this->ui->exportPngButton->setEnabled(haveData && idle);
+  this->ui->resetButton->setEnabled(haveData);
+}
+
+void
+OccupancyDialog::onRefresh(void)
+{
+  qint64 seconds;
+  QString status;
+
+  if (this->occupancy == nullptr || !this->isVisible())
+    return;
+
+  seconds = this->occupancy->getElapsed() / 1000;
+
+  if (this->occupancy->getFrames() == 0)
+    status = "No frames accumulated";
+  else
+    status = QString("%1:%2:%3 in %4 frames, mean duty cycle %5%")
+          .arg(seconds / 3600)
+          .arg(seconds / 60 % 60, 2, 10, QChar('0'))
+          .arg(seconds % 60, 2, 10, QChar('0'))
+          .arg(this->occupancy->getFrames())
+          .arg(
+            100. * static_cast<qreal>(this->occupancy->getMeanDuty()),
+            0,
+            'f',
+            2);
+
+  // Earlier statistics were dropped without the user asking for it
+  if (this->occupancy->getRestart() != Occupancy::RESTART_NONE)
+    status += QString("\nStarted over at %1: %2 changed")
+        .arg(
+          QDateTime::fromMSecsSinceEpoch(
+            this->occupancy->getRestartTime()).toString("HH:mm:ss"))
+        .arg(
+          this->occupancy->getRestart() == Occupancy::RESTART_FFT_SIZE
+          ? "FFT size"
+          : "center frequency or sample rate");
+
+  this->ui->statusLabel->setText(status);
+  this->refreshUi();
+}
+
+void
+OccupancyDialog::onParamsChanged(void)
+{
+  if (this->occupancy == nullptr)
+    return;
+
+  // Statistics start over if either changes
+  this->occupancy->setThreshold(
+        static_cast<float>(this->ui->thresholdSpin->value()),
+        this->ui->relativeCheck->isChecked());
+}
+
+void
+OccupancyDialog::onReset(void)
+{
+  if (this->occupancy != nullptr) {
+    this->occupancy->reset();
+    this->onRefresh();
+  }
+}
+
+void
+OccupancyDialog::exportTo(OccupancyExporter::Format format)
+{
+  OccupancySnapshot snapshot;
+  QString path;
+
+  if (this->occupancy == nullptr || this->exporter->isBusy())
+    return;
+
+  path = QFileDialog::getSaveFileName(
+        this,
+        "Export occupancy statistics",
+        QString(),
+        format == OccupancyExporter::FORMAT_PNG
+        ? "PNG images (*.png)"
+        : "CSV files (*.csv)");
+
+  if (path.isEmpty())
+    return;
+
+  // Frames that arrived while the file dialog was open are included
+  this->occupancy->snapshot(snapshot);
+  this->exporter->exportTo(snapshot, format, path, this->palette);
+  this->refreshUi();
+}
+
+void
+OccupancyDialog::onExportCsv(void)
+{
+  this->exportTo(OccupancyExporter::FORMAT_CSV);
+}
+
+void
+OccupancyDialog::onExportPng(void)
+{
+  this->exportTo(OccupancyExporter::FORMAT_PNG);
+}
+
+void
+OccupancyDialog::onExportFinished(QString path, QString error)
+{
+  this->refreshUi();
+
+  if (!error.isEmpty())
+    QMessageBox::critical(
+          this,
+          "Cannot save file",
+          "Occupancy statistics could not be written to "
+          + path
+          + ": "
+          + error,
+          QMessageBox::Ok);
+}
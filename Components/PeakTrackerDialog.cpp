@@ -0,0 +1,199 @@
+//
+//    PeakTrackerDialog.cpp: Tracked peak list
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+#include "PeakTrackerDialog.h"
+#include "ui_PeakTrackerDialog.h"
+#include <QDateTime>
+#include <cmath>
+
+using namespace SigDigger;
+
+enum PeakTrackerColumn {
+  PEAK_COLUMN_FREQUENCY,
+  PEAK_COLUMN_POWER,
+  PEAK_COLUMN_SNR,
+  PEAK_COLUMN_MAX,
+  PEAK_COLUMN_DRIFT,
+  PEAK_COLUMN_SINCE,
+  PEAK_COLUMN_DURATION,
+  PEAK_COLUMN_COUNT
+};
+
+static QVariant
+roundTo(qreal value, qreal step)
+{
+  return std::round(value / step) * step;
+}
+
+PeakTrackerDialog::PeakTrackerDialog(QWidget *parent) :
+  QDialog(parent),
+  ui(new Ui::PeakTrackerDialog)
+{
+  ui->setupUi(this);
+
+  this->refreshTimer = new QTimer(this);
+  this->refreshTimer->setInterval(SIGDIGGER_PEAK_DIALOG_REFRESH_MS);
+
+  this->connectAll();
+
+  this->refreshTimer->start();
+}
+
+PeakTrackerDialog::~PeakTrackerDialog()
+{
+  delete ui;
+}
+
+void
+PeakTrackerDialog::connectAll(void)
+{
+  connect(
+        this->refreshTimer,
+        SIGNAL(timeout(void)),
+        this,
+        SLOT(onRefresh(void)));
+
+  connect(
+        this->ui->thresholdSpin,
+        SIGNAL(valueChanged(double)),
+        this,
+        SLOT(onParamsChanged(void)));
+
+  connect(
+        this->ui->hysteresisSpin,
+        SIGNAL(valueChanged(double)),
+        this,
+        SLOT(onParamsChanged(void)));
+
+  connect(
+        this->ui->peaksSpin,
+        SIGNAL(valueChanged(int)),
+        this,
+        SLOT(onParamsChanged(void)));
+
+  connect(
+        this->ui->peakTable,
+        SIGNAL(cellClicked(int, int)),
+        this,
+        SLOT(onPeakClicked(int, int)));
+}
+
+void
+PeakTrackerDialog::setTracker(PeakTracker *tracker)
+{
+  this->tracker = tracker;
+  this->onParamsChanged();
+}
+
+void
+PeakTrackerDialog::setNoiseFloor(const NoiseFloor *noiseFloor)
+{
+  this->noiseFloor = noiseFloor;
+}
+
+//
+// Cells are reused between refreshes. Sorting is suspended while they
+// are written, and the table is sorted again by the current column once
+// they are all there.
+//
+void
+PeakTrackerDialog::onRefresh(void)
+{
+  QTableWidget *table = this->ui->peakTable;
+  qint64 now = QDateTime::currentMSecsSinceEpoch();
+  int row = 0;
+
+  if (this->tracker == nullptr || !this->isVisible())
+    return;
+
+  table->setSortingEnabled(false);
+
+  for (auto const &p : this->tracker->getPeaks()) {
+    QVariant values[PEAK_COLUMN_COUNT];
+
+    if (!p.active)
+      continue;
+
+    values[PEAK_COLUMN_FREQUENCY] = qRound64(p.freq);
+    values[PEAK_COLUMN_POWER]     = roundTo(static_cast<qreal>(p.power), .1);
+    values[PEAK_COLUMN_SNR]       = roundTo(static_cast<qreal>(p.snr), .1);
+    values[PEAK_COLUMN_MAX]       = roundTo(static_cast<qreal>(p.maxPower), .1);
+    values[PEAK_COLUMN_DRIFT]     = qRound64(p.getDrift());
+    values[PEAK_COLUMN_SINCE]     =
+        QDateTime::fromMSecsSinceEpoch(p.start).toString("hh:mm:ss");
+    values[PEAK_COLUMN_DURATION]  = roundTo(1e-3 * (now - p.start), .1);
+
+    if (row >= table->rowCount())
+      table->setRowCount(row + 1);
+
+    for (int col = 0; col < PEAK_COLUMN_COUNT; ++col) {
+      QTableWidgetItem *item = table->item(row, col);
+
+      if (item == nullptr) {
+        item = new QTableWidgetItem();
+        table->setItem(row, col, item);
+      }
+
+      item->setData(Qt::DisplayRole, values[col]);
+    }
+
+    ++row;
+  }
+
+  table->setRowCount(row);
+  table->setSortingEnabled(true);
+
+  if (this->noiseFloor != nullptr && this->noiseFloor->isValid())
+    this->ui->floorLabel->setText(
+          "Noise floor: "
+          + QString::number(
+            static_cast<double>(this->noiseFloor->getFloor()),
+            'f',
+            1)
+          + " dB");
+}
+
+void
+PeakTrackerDialog::onParamsChanged(void)
+{
+  unsigned int peaks = static_cast<unsigned int>(this->ui->peaksSpin->value());
+
+  if (this->tracker == nullptr)
+    return;
+
+  this->tracker->setThreshold(
+        static_cast<float>(this->ui->thresholdSpin->value()));
+  this->tracker->setHysteresis(
+        static_cast<float>(this->ui->hysteresisSpin->value()));
+
+  // Changing the number of peaks starts over
+  if (this->tracker->getMaxPeaks() != peaks)
+    this->tracker->setMaxPeaks(peaks);
+}
+
+void
+PeakTrackerDialog::onPeakClicked(int row, int)
+{
+  QTableWidgetItem *item = this->ui->peakTable->item(
+        row,
+        PEAK_COLUMN_FREQUENCY);
+
+  if (item != nullptr)
+    emit tune(item->data(Qt::DisplayRole).toLongLong());
+}
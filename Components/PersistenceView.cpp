@@ -0,0 +1,140 @@
+//
+//    PersistenceView.cpp: Persistence spectrum display
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+#include "PersistenceView.h"
+#include <QPainter>
+#include <cmath>
+
+using namespace SigDigger;
+
+PersistenceView::PersistenceView(QWidget *parent) : QFrame(parent)
+{
+  this->persistence.setRange(this->min, this->max);
+}
+
+void
+PersistenceView::feed(const float *data, int size)
+{
+  if (size > 0)
+    this->persistence.feed(data, static_cast<size_t>(size));
+}
+
+void
+PersistenceView::setColorPalette(Palette const &palette)
+{
+  this->palette = palette;
+  this->update();
+}
+
+void
+PersistenceView::setRange(float min, float max)
+{
+  this->min = min;
+  this->max = max;
+  this->persistence.setRange(min, max);
+  this->update();
+}
+
+void
+PersistenceView::setDecay(float decay)
+{
+  this->persistence.setDecay(decay);
+}
+
+void
+PersistenceView::setNoiseFloor(const float *floor, int size)
+{
+  this->floor = floor;
+  this->floorSize = size;
+}
+
+void
+PersistenceView::clear(void)
+{
+  this->persistence.clear();
+  this->update();
+}
+
+void
+PersistenceView::resizeEvent(QResizeEvent *)
+{
+  int width = this->width();
+  int height = this->height();
+
+  if (width > 0 && height > 0) {
+    this->persistence.resize(
+          static_cast<unsigned int>(width),
+          static_cast<unsigned int>(height));
+    this->image = QImage(width, height, QImage::Format_RGB32);
+    this->floorLine.resize(width);
+  }
+}
+
+void
+PersistenceView::paintEvent(QPaintEvent *)
+{
+  QPainter painter(this);
+  unsigned int y;
+  float db, k;
+  int line;
+
+  if (this->image.isNull())
+    return;
+
+  for (y = 0; y < this->persistence.getHeight(); ++y)
+    this->persistence.render(
+          y,
+          reinterpret_cast<QRgb *>(this->image.scanLine(static_cast<int>(y))),
+          this->palette);
+
+  painter.drawImage(0, 0, this->image);
+
+  // Power grid, as in the pandapter
+  painter.setPen(QColor(255, 255, 255, 96));
+
+  for (db = std::floor(this->max / SIGDIGGER_PERSISTENCE_VIEW_GRID_DB)
+         * SIGDIGGER_PERSISTENCE_VIEW_GRID_DB;
+       db >= this->min;
+       db -= SIGDIGGER_PERSISTENCE_VIEW_GRID_DB) {
+    line = static_cast<int>(
+          (this->max - db) * (this->height() - 1) / (this->max - this->min));
+    painter.drawLine(0, line, this->width(), line);
+    painter.drawText(
+          4,
+          line + painter.fontMetrics().ascent(),
+          QString::number(static_cast<double>(db), 'f', 0) + " dB");
+  }
+
+  // Noise floor, at the center bin of each column
+  if (this->floor != nullptr && this->floorSize > 0) {
+    k = (this->height() - 1) / (this->max - this->min);
+
+    for (int x = 0; x < this->floorLine.size(); ++x) {
+      int bin = static_cast<int>(
+            (static_cast<qint64>(2 * x + 1) * this->floorSize)
+            / (2 * this->floorLine.size()));
+      this->floorLine[x] = QPointF(
+            x,
+            static_cast<qreal>((this->max - this->floor[bin]) * k));
+    }
+
+    painter.setPen(QColor(255, 255, 255, 192));
+    painter.drawPolyline(this->floorLine.data(), this->floorLine.size());
+  }
+}
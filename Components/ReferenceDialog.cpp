@@ -0,0 +1,251 @@
+//
+//    ReferenceDialog.cpp: Reference spectrum controls
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+#include "ReferenceDialog.h"
+#include "ui_ReferenceDialog.h"
+#include <QDateTime>
+#include <QFileDialog>
+#include <QMessageBox>
+
+using namespace SigDigger;
+
+ReferenceDialog::ReferenceDialog(QWidget *parent) :
+  QDialog(parent),
+  ui(new Ui::ReferenceDialog)
+{
+  ui->setupUi(this);
+
+  this->refreshTimer = new QTimer(this);
+  this->refreshTimer->setInterval(SIGDIGGER_REFERENCE_DIALOG_REFRESH_MS);
+
+  this->connectAll();
+  this->refreshUi();
+
+  this->refreshTimer->start();
+}
+
+ReferenceDialog::~ReferenceDialog()
+{
+  delete ui;
+}
+
+void
+ReferenceDialog::connectAll(void)
+{
+  connect(
+        this->refreshTimer,
+        SIGNAL(timeout(void)),
+        this,
+        SLOT(onRefresh(void)));
+
+  connect(
+        this->ui->thresholdSpin,
+        SIGNAL(valueChanged(double)),
+        this,
+        SLOT(onThresholdChanged(void)));
+
+  connect(
+        this->ui->captureButton,
+        SIGNAL(clicked(bool)),
+        this,
+        SLOT(onCapture(void)));
+
+  connect(
+        this->ui->loadButton,
+        SIGNAL(clicked(bool)),
+        this,
+        SLOT(onLoad(void)));
+
+  connect(
+        this->ui->saveButton,
+        SIGNAL(clicked(bool)),
+        this,
+        SLOT(onSave(void)));
+
+  connect(
+        this->ui->clearButton,
+        SIGNAL(clicked(bool)),
+        this,
+        SLOT(onClear(void)));
+}
+
+void
+ReferenceDialog::setReference(ReferenceTrace *reference)
+{
+  this->reference = reference;
+  this->onThresholdChanged();
+  this->refreshUi();
+}
+
+bool
+ReferenceDialog::isDiffEnabled(void) const
+{
+  return this->ui->diffCheck->isChecked()
+      && this->reference != nullptr
+      && this->reference->isValid();
+}
+
+void
+ReferenceDialog::refreshUi(void)
+{
+  bool haveReference = this->reference != nullptr
+      && this->reference->isValid();
+  bool capturing = this->reference != nullptr
+      && this->reference->isCapturing();
+
+  this->ui->captureButton->setText(capturing ? "Cancel" : "Capture");
+  this->ui->captureButton->setEnabled(this->reference != nullptr);
+  this->ui->durationSpin->setEnabled(!capturing);
+  this->ui->loadButton->setEnabled(this->reference != nullptr && !capturing);
+  this->ui->saveButton->setEnabled(haveReference);
+  this->ui->clearButton->setEnabled(haveReference && !capturing);
+}
+
+void
+ReferenceDialog::onRefresh(void)
+{
+  QString text;
+
+  if (this->reference == nullptr || !this->isVisible())
+    return;
+
+  if (this->reference->isCapturing()) {
+    text = QString("Capturing: %1%").arg(
+          qRound(
+            100 * this->reference->getCaptureProgress(
+              QDateTime::currentMSecsSinceEpoch())));
+  } else if (!this->reference->isValid()) {
+    text = "No reference";
+  } else {
+    ReferenceTraceHeader const &h = this->reference->getHeader();
+
+    text = QString("%1 bins at %2 MHz, %3 Msps, %4 s average, %5")
+        .arg(h.width)
+        .arg(h.fc * 1e-6, 0, 'f', 6)
+        .arg(h.rate * 1e-6, 0, 'f', 3)
+        .arg(h.duration * 1e-3, 0, 'f', 1)
+        .arg(
+          QDateTime::fromMSecsSinceEpoch(h.timestamp).toString(
+            "yyyy-MM-dd hh:mm:ss"));
+  }
+
+  if (this->isDiffEnabled()) {
+    if (this->reference->getOverlap() == 0)
+      text += "\nNot within the current span";
+    else
+      text += QString("\n%1 bins beyond the threshold").arg(
+            this->reference->getDeviating());
+  }
+
+  this->ui->statusLabel->setText(text);
+  this->refreshUi();
+}
+
+void
+ReferenceDialog::onThresholdChanged(void)
+{
+  if (this->reference != nullptr)
+    this->reference->setThreshold(
+          static_cast<float>(this->ui->thresholdSpin->value()));
+}
+
+void
+ReferenceDialog::onCapture(void)
+{
+  if (this->reference == nullptr)
+    return;
+
+  if (this->reference->isCapturing())
+    this->reference->cancelCapture();
+  else
+    this->reference->startCapture(
+          1000 * this->ui->durationSpin->value(),
+          QDateTime::currentMSecsSinceEpoch());
+
+  this->onRefresh();
+}
+
+void
+ReferenceDialog::onLoad(void)
+{
+  QString path, error;
+
+  if (this->reference == nullptr)
+    return;
+
+  path = QFileDialog::getOpenFileName(
+        this,
+        "Load reference spectrum",
+        QString(),
+        "Reference spectra (*.ref)");
+
+  if (path.isEmpty())
+    return;
+
+  error = this->reference->load(path);
+  if (!error.isEmpty())
+    QMessageBox::critical(
+          this,
+          "Cannot load file",
+          "Reference spectrum could not be read from "
+          + path
+          + ": "
+          + error,
+          QMessageBox::Ok);
+
+  this->onRefresh();
+}
+
+void
+ReferenceDialog::onSave(void)
+{
+  QString path, error;
+
+  if (this->reference == nullptr || !this->reference->isValid())
+    return;
+
+  path = QFileDialog::getSaveFileName(
+        this,
+        "Save reference spectrum",
+        QString(),
+        "Reference spectra (*.ref)");
+
+  if (path.isEmpty())
+    return;
+
+  error = this->reference->save(path);
+  if (!error.isEmpty())
+    QMessageBox::critical(
+          this,
+          "Cannot save file",
+          "Reference spectrum could not be written to "
+          + path
+          + ": "
+          + error,
+          QMessageBox::Ok);
+}
+
+void
+ReferenceDialog::onClear(void)
+{
+  if (this->reference != nullptr) {
+    this->reference->clear();
+    this->onRefresh();
+  }
+}
@@ -0,0 +1,82 @@
+//
+//    ReferenceView.cpp: Bins deviating from the reference spectrum
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+#include "ReferenceView.h"
+#include <QPainter>
+#include <algorithm>
+
+using namespace SigDigger;
+
+ReferenceView::ReferenceView(QWidget *parent) : QFrame(parent)
+{
+  this->setMinimumHeight(SIGDIGGER_REFERENCE_VIEW_HEIGHT);
+  this->setMaximumHeight(SIGDIGGER_REFERENCE_VIEW_HEIGHT);
+}
+
+// Does not repaint: the spectrum repaints it along with every frame
+void
+ReferenceView::setDiff(const float *diff, int size, float threshold)
+{
+  this->diff = diff;
+  this->size = size;
+  this->threshold = threshold;
+}
+
+void
+ReferenceView::paintEvent(QPaintEvent *)
+{
+  QPainter painter(this);
+  int width = this->width();
+  qreal half = .5 * (this->height() - 1);
+  qreal scale = half / SIGDIGGER_REFERENCE_VIEW_RANGE_DB;
+
+  painter.fillRect(this->rect(), Qt::black);
+
+  painter.setPen(QColor(64, 64, 64));
+  painter.drawLine(QPointF(0, half), QPointF(width, half));
+
+  if (this->diff == nullptr || this->size <= 0 || width <= 0)
+    return;
+
+  for (int x = 0; x < width; ++x) {
+    int start = static_cast<int>(static_cast<qint64>(x) * this->size / width);
+    int end   = static_cast<int>(
+          static_cast<qint64>(x + 1) * this->size / width);
+    float hi = 0, lo = 0;
+    qreal h;
+
+    // Columns narrower than a bin show the bin below them
+    end = std::min(std::max(end, start + 1), this->size);
+
+    for (int i = start; i < end; ++i) {
+      hi = std::max(hi, this->diff[i]);
+      lo = std::min(lo, this->diff[i]);
+    }
+
+    if (hi > this->threshold) {
+      h = std::min((hi - this->threshold) * scale + 1, half);
+      painter.fillRect(QRectF(x, half - h, 1, h), QColor(255, 64, 64));
+    }
+
+    if (lo < -this->threshold) {
+      h = std::min((-this->threshold - lo) * scale + 1, half);
+      painter.fillRect(QRectF(x, half, 1, h), QColor(64, 128, 255));
+    }
+  }
+}
@@ -0,0 +1,428 @@
+//
+//    WaterfallHistoryView.cpp: Waterfall history viewer
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+#include "WaterfallHistoryView.h"
+#include "ui_WaterfallHistoryDialog.h"
+#include <QPainter>
+#include <QMouseEvent>
+#include <QDateTime>
+#include <algorithm>
+#include <climits>
+
+using namespace SigDigger;
+
+/////////////////////////////// History view ///////////////////////////////////
+WaterfallHistoryView::WaterfallHistoryView(QWidget *parent) : QFrame(parent)
+{
+  for (int i = 0; i < 256; ++i)
+    this->lut[i] = qRgb(i, i, i);
+
+  this->tiles = new WaterfallTileCache(this);
+
+  connect(
+        this->tiles,
+        SIGNAL(tileReady(void)),
+        this,
+        SLOT(update(void)));
+
+  this->setMouseTracking(true);
+}
+
+//
+// Stored rows are already quantized, so each of the 256 levels gets its
+// pixel value once per palette or range change, and painting is a plain
+// table lookup.
+//
+void
+WaterfallHistoryView::updateLut(void)
+{
+  float levels[256];
+  float min = SIGDIGGER_HISTORY_DB_MIN;
+  float max = SIGDIGGER_HISTORY_DB_MAX;
+
+  if (this->history != nullptr) {
+    min = this->history->getDbMin();
+    max = this->history->getDbMax();
+  }
+
+  for (int i = 0; i < 256; ++i)
+    levels[i] = min + i * (max - min) / 255.f;
+
+  this->palette.map(levels, this->lut, 256, this->rangeMin, this->rangeMax);
+  this->tiles->setLut(this->lut);
+  this->update();
+}
+
+void
+WaterfallHistoryView::setHistory(WaterfallHistory *history)
+{
+  this->history = history;
+  this->tiles->setHistory(history);
+  this->updateLut();
+}
+
+void
+WaterfallHistoryView::setColorPalette(Palette const &palette)
+{
+  this->palette = palette;
+  this->updateLut();
+}
+
+void
+WaterfallHistoryView::setRange(float min, float max)
+{
+  this->rangeMin = min;
+  this->rangeMax = max;
+  this->updateLut();
+}
+
+void
+WaterfallHistoryView::setTop(quint64 seq)
+{
+  if (this->top != seq) {
+    this->top = seq;
+    this->update();
+  }
+}
+
+void
+WaterfallHistoryView::setLevel(unsigned int level)
+{
+  if (this->level != level) {
+    this->level = level;
+    this->update();
+  }
+}
+
+void
+WaterfallHistoryView::setMean(bool mean)
+{
+  if (this->mean != mean) {
+    this->mean = mean;
+    this->tiles->setMean(mean);
+    this->update();
+  }
+}
+
+// Row of the current level on top. While following, the newest block may
+// still be incomplete, in which case the previous one is shown.
+quint64
+WaterfallHistoryView::levelTop(void) const
+{
+  quint64 end = this->history->getEnd(this->level);
+  quint64 top = this->top >> this->level;
+
+  return top < end ? top : end - 1;
+}
+
+void
+WaterfallHistoryView::paintEvent(QPaintEvent *)
+{
+  QPainter painter(this);
+  int width = this->width();
+  int height = this->height();
+  quint64 top = 0;
+
+  if (width <= 0 || height <= 0)
+    return;
+
+  painter.fillRect(this->rect(), Qt::black);
+
+  if (this->history != nullptr && this->history->getEnd(this->level) > 0) {
+    top = this->levelTop();
+    this->tiles->draw(painter, width, height, this->level, top);
+
+    // Time marks
+    painter.setPen(Qt::white);
+
+    for (int y = 0;
+         y < height && static_cast<quint64>(y) <= top;
+         y += SIGDIGGER_HISTORY_VIEW_TICK_ROWS) {
+      const WaterfallHistoryRow *row = this->history->getRow(
+            top - static_cast<quint64>(y),
+            this->level);
+
+      if (row == nullptr)
+        break;
+
+      painter.drawLine(0, y, 8, y);
+      painter.drawText(
+            12,
+            y + painter.fontMetrics().ascent(),
+            QDateTime::fromMSecsSinceEpoch(row->timestamp / 1000).toString(
+              "yyyy-MM-dd hh:mm:ss"));
+    }
+  }
+}
+
+void
+WaterfallHistoryView::mouseMoveEvent(QMouseEvent *event)
+{
+  int y = event->pos().y();
+  quint64 top;
+
+  if (this->history == nullptr || this->history->getEnd(this->level) == 0)
+    return;
+
+  top = this->levelTop();
+
+  if (y >= 0 && static_cast<quint64>(y) <= top && this->width() > 0)
+    emit rowHovered(
+        top - static_cast<quint64>(y),
+        static_cast<qreal>(event->pos().x()) / this->width());
+}
+
+////////////////////////////// History dialog //////////////////////////////////
+WaterfallHistoryDialog::WaterfallHistoryDialog(QWidget *parent) :
+  QDialog(parent),
+  ui(new Ui::WaterfallHistoryDialog)
+{
+  ui->setupUi(this);
+
+  this->refreshTimer = new QTimer(this);
+  this->refreshTimer->setInterval(SIGDIGGER_HISTORY_VIEW_REFRESH_MS);
+
+  this->connectAll();
+  this->setHistory(nullptr);
+
+  this->refreshTimer->start();
+}
+
+WaterfallHistoryDialog::~WaterfallHistoryDialog()
+{
+  delete ui;
+}
+
+void
+WaterfallHistoryDialog::connectAll(void)
+{
+  connect(
+        this->refreshTimer,
+        SIGNAL(timeout(void)),
+        this,
+        SLOT(onRefresh(void)));
+
+  connect(
+        this->ui->scrollBar,
+        SIGNAL(valueChanged(int)),
+        this,
+        SLOT(onScroll(int)));
+
+  connect(
+        this->ui->followCheck,
+        SIGNAL(stateChanged(int)),
+        this,
+        SLOT(onFollowToggled(void)));
+
+  connect(
+        this->ui->zoomCombo,
+        SIGNAL(activated(int)),
+        this,
+        SLOT(onZoomChanged(void)));
+
+  connect(
+        this->ui->meanCheck,
+        SIGNAL(stateChanged(int)),
+        this,
+        SLOT(onZoomChanged(void)));
+
+  connect(
+        this->ui->historyView,
+        SIGNAL(rowHovered(quint64, qreal)),
+        this,
+        SLOT(onRowHovered(quint64, qreal)));
+}
+
+void
+WaterfallHistoryDialog::setHistory(WaterfallHistory *history)
+{
+  this->history = history;
+  this->ui->historyView->setHistory(history);
+
+  if (history == nullptr)
+    this->ui->infoLabel->setText("Waterfall history recording is disabled");
+  else
+    this->ui->infoLabel->setText("");
+
+  this->refreshLevels();
+  this->refreshScrollBar();
+}
+
+void
+WaterfallHistoryDialog::refreshLevels(void)
+{
+  unsigned int levels = this->history != nullptr
+      ? this->history->getLevels()
+      : 1;
+  int index = this->ui->zoomCombo->currentIndex();
+
+  this->ui->zoomCombo->clear();
+  this->ui->zoomCombo->addItem("Fit");
+
+  for (unsigned int k = 0; k < levels; ++k)
+    this->ui->zoomCombo->addItem(
+          k == 0 ? QString("1 row/px") : QString::number(1 << k) + " rows/px");
+
+  if (index < 0 || index >= this->ui->zoomCombo->count())
+    index = 1;
+
+  this->ui->zoomCombo->setCurrentIndex(index);
+}
+
+void
+WaterfallHistoryDialog::setColorPalette(Palette const &palette)
+{
+  this->ui->historyView->setColorPalette(palette);
+}
+
+void
+WaterfallHistoryDialog::setRange(float min, float max)
+{
+  this->ui->historyView->setRange(min, max);
+}
+
+//
+// Scroll bar value is the number of rows between the top of the view and
+// the newest row, so the top of the scroll bar is the live end. "Fit"
+// picks the finest level at which the whole history fits in the view.
+//
+void
+WaterfallHistoryDialog::refreshScrollBar(void)
+{
+  quint64 first, last, top, height;
+  unsigned int level = 0;
+  int max;
+
+  this->ui->scrollBar->blockSignals(true);
+
+  if (this->history == nullptr || this->history->getEnd() == 0) {
+    this->ui->scrollBar->setRange(0, 0);
+    this->ui->historyView->setTop(0);
+    this->ui->historyView->setLevel(0);
+  } else {
+    first  = this->history->getFirst();
+    last   = this->history->getEnd() - 1;
+    top    = this->ui->historyView->getTop();
+    height = static_cast<quint64>(std::max(this->ui->historyView->height(), 1));
+
+    if (this->ui->zoomCombo->currentIndex() > 0)
+      level = static_cast<unsigned int>(this->ui->zoomCombo->currentIndex() - 1);
+    else
+      while (level + 1 < this->history->getLevels()
+             && ((last - first) >> level) >= height)
+        ++level;
+
+    this->ui->historyView->setLevel(level);
+
+    if (this->ui->followCheck->isChecked() || top > last)
+      top = last;
+    else if (top < first)
+      top = first;
+
+    max = static_cast<int>(std::min<quint64>(last - first, INT_MAX));
+
+    this->ui->scrollBar->setRange(0, max);
+    this->ui->scrollBar->setSingleStep(1 << level);
+    this->ui->scrollBar->setPageStep(
+          static_cast<int>(std::min<quint64>(height << level, INT_MAX)));
+    this->ui->scrollBar->setValue(
+          static_cast<int>(std::min<quint64>(last - top, INT_MAX)));
+    this->ui->historyView->setTop(top);
+  }
+
+  this->ui->scrollBar->blockSignals(false);
+}
+
+void
+WaterfallHistoryDialog::onRefresh(void)
+{
+  if (this->isVisible()) {
+    this->refreshScrollBar();
+
+    // New rows only change what is painted when following
+    if (this->ui->followCheck->isChecked())
+      this->ui->historyView->update();
+  }
+}
+
+void
+WaterfallHistoryDialog::onScroll(int value)
+{
+  if (this->history != nullptr && this->history->getEnd() > 0) {
+    quint64 last = this->history->getEnd() - 1;
+    quint64 back = static_cast<quint64>(value);
+
+    this->ui->historyView->setTop(back > last ? 0 : last - back);
+
+    // Scrolling back detaches the view from the live end
+    this->ui->followCheck->blockSignals(true);
+    this->ui->followCheck->setChecked(value == 0);
+    this->ui->followCheck->blockSignals(false);
+  }
+}
+
+void
+WaterfallHistoryDialog::onFollowToggled(void)
+{
+  this->refreshScrollBar();
+}
+
+void
+WaterfallHistoryDialog::onZoomChanged(void)
+{
+  this->ui->historyView->setMean(this->ui->meanCheck->isChecked());
+  this->refreshScrollBar();
+}
+
+void
+WaterfallHistoryDialog::onRowHovered(quint64 seq, qreal x)
+{
+  const WaterfallHistoryRow *row;
+  unsigned int k = this->ui->historyView->getLevel();
+  unsigned int bin, width;
+  const uint8_t *data;
+  qreal freq, level;
+
+  if (this->history == nullptr
+      || (row = this->history->getRow(seq, k)) == nullptr)
+    return;
+
+  width = this->history->getWidth(k);
+  bin = static_cast<unsigned int>(x * width);
+  if (bin >= width)
+    bin = width - 1;
+
+  data = this->ui->meanCheck->isChecked()
+      ? this->history->getMean(k, row)
+      : row->getData();
+
+  freq  = row->fc + (x - .5) * row->rate;
+  level = this->history->getDbMin()
+      + data[bin]
+      * (this->history->getDbMax() - this->history->getDbMin()) / 255.;
+
+  this->ui->infoLabel->setText(
+        QDateTime::fromMSecsSinceEpoch(row->timestamp / 1000).toString(
+          "yyyy-MM-dd hh:mm:ss.zzz")
+        + "   "
+        + QString::number(freq * 1e-6, 'f', 6)
+        + " MHz   "
+        + QString::number(level, 'f', 1)
+        + " dB");
+}
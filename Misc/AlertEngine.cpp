@@ -0,0 +1,230 @@
+//
+//    AlertEngine.cpp: Band threshold alerts
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+
+#include "AlertEngine.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace SigDigger;
+
+void
+AlertEngine::setRules(std::vector<AlertRule> const &rules)
+{
+  this->rules = rules;
+  this->states.assign(rules.size(), RuleState());
+
+  // Forces a rebuild on the next frame
+  this->bins = 0;
+}
+
+void
+AlertEngine::setHoldoff(qint64 ms)
+{
+  this->holdoff = ms;
+}
+
+//
+// Rules take the FFT bins whose centers fall inside them, or the one
+// holding the rule center if narrower than a bin. Bins only partly
+// inside the rule are left out, so a carrier next to the rule does not
+// raise it. The engine is fed the full resolution PSD, so this mapping
+// only changes with the FFT size, center frequency or sample rate.
+//
+void
+AlertEngine::rebuild(size_t size, qint64 fc, unsigned int rate)
+{
+  qreal binsPerHz = static_cast<qreal>(size) / rate;
+  qreal half = .5 * size;
+  std::vector<size_t> lo(this->rules.size()), hi(this->rules.size());
+  size_t r, s;
+
+  this->bins = size;
+  this->fc   = fc;
+  this->rate = rate;
+
+  this->edges.clear();
+  this->edges.push_back(0);
+  this->edges.push_back(size);
+
+  for (r = 0; r < this->rules.size(); ++r) {
+    AlertRule const &rule = this->rules[r];
+    qreal a = (rule.freq - fc - .5 * rule.bandwidth) * binsPerHz + half;
+    qreal b = (rule.freq - fc + .5 * rule.bandwidth) * binsPerHz + half;
+    qreal first = std::ceil(a);
+    qreal last = std::floor(b);
+
+    if (first > last)
+      first = last = std::round(.5 * (a + b));
+
+    first = std::max<qreal>(first, 0);
+    last  = std::min<qreal>(last, size - 1);
+
+    this->states[r].inSpan = first <= last;
+    if (!this->states[r].inSpan)
+      continue;
+
+    lo[r] = static_cast<size_t>(first);
+    hi[r] = static_cast<size_t>(last) + 1;
+    this->edges.push_back(lo[r]);
+    this->edges.push_back(hi[r]);
+  }
+
+  std::sort(this->edges.begin(), this->edges.end());
+  this->edges.erase(
+        std::unique(this->edges.begin(), this->edges.end()),
+        this->edges.end());
+
+  this->covered.assign(this->edges.size() - 1, false);
+  this->absMax.resize(this->edges.size() - 1);
+  this->relMax.resize(this->edges.size() - 1);
+
+  for (r = 0; r < this->rules.size(); ++r) {
+    RuleState &state = this->states[r];
+
+    if (!state.inSpan)
+      continue;
+
+    state.first = static_cast<unsigned int>(
+          std::lower_bound(this->edges.begin(), this->edges.end(), lo[r])
+          - this->edges.begin());
+    state.last = static_cast<unsigned int>(
+          std::lower_bound(this->edges.begin(), this->edges.end(), hi[r])
+          - this->edges.begin());
+
+    for (s = state.first; s < state.last; ++s)
+      this->covered[s] = true;
+  }
+}
+
+bool
+AlertEngine::allow(RuleState &state, qint64 now)
+{
+  if (state.lastNotified >= 0 && now - state.lastNotified < this->holdoff) {
+    ++this->suppressed;
+    return false;
+  }
+
+  if (this->tokens < 1) {
+    ++this->suppressed;
+    return false;
+  }
+
+  this->tokens -= 1;
+  state.lastNotified = now;
+
+  return true;
+}
+
+std::vector<AlertEvent> const &
+AlertEngine::feed(
+    const float *psd,
+    const float *floor,
+    size_t size,
+    qint64 fc,
+    unsigned int rate,
+    qint64 now)
+{
+  size_t i, r, s;
+
+  this->events.clear();
+
+  if (this->rules.empty() || size == 0 || rate == 0)
+    return this->events;
+
+  if (size != this->bins || fc != this->fc || rate != this->rate)
+    this->rebuild(size, fc, rate);
+
+  if (this->lastRefill >= 0)
+    this->tokens = std::min<float>(
+          this->tokens
+          + (now - this->lastRefill) * (SIGDIGGER_ALERT_PER_MINUTE / 6e4f),
+          SIGDIGGER_ALERT_BURST);
+  this->lastRefill = now;
+
+  for (s = 0; s + 1 < this->edges.size(); ++s) {
+    float absMax = -INFINITY;
+    float relMax = -INFINITY;
+
+    if (!this->covered[s])
+      continue;
+
+#pragma omp simd reduction(max:absMax)
+    for (i = this->edges[s]; i < this->edges[s + 1]; ++i)
+      absMax = std::max(absMax, psd[i]);
+
+    if (floor != nullptr) {
+#pragma omp simd reduction(max:relMax)
+      for (i = this->edges[s]; i < this->edges[s + 1]; ++i)
+        relMax = std::max(relMax, psd[i] - floor[i]);
+    }
+
+    this->absMax[s] = absMax;
+    this->relMax[s] = relMax;
+  }
+
+  for (r = 0; r < this->rules.size(); ++r) {
+    AlertRule const &rule = this->rules[r];
+    RuleState &state = this->states[r];
+    const float *max = rule.relative
+        ? this->relMax.data()
+        : this->absMax.data();
+    float level = -INFINITY;
+
+    if (state.inSpan)
+      for (s = state.first; s < state.last; ++s)
+        level = std::max(level, max[s]);
+
+    state.level = level;
+
+    if (level > rule.threshold) {
+      if (state.since < 0)
+        state.since = now;
+
+      if (!state.raised && now - state.since >= rule.duration) {
+        state.raised   = true;
+        state.notified = this->allow(state, now);
+
+        if (state.notified)
+          this->events.push_back({AlertEvent::RAISED, r, now, level});
+      }
+    } else {
+      state.since = -1;
+
+      if (state.raised) {
+        if (state.notified)
+          this->events.push_back({AlertEvent::CLEARED, r, now, level});
+        state.raised   = false;
+        state.notified = false;
+      }
+    }
+  }
+
+  return this->events;
+}
+
+bool
+AlertEngine::isRecordRaised(void) const
+{
+  for (size_t r = 0; r < this->rules.size(); ++r)
+    if (this->rules[r].record && this->states[r].raised)
+      return true;
+
+  return false;
+}
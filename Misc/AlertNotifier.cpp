@@ -0,0 +1,185 @@
+//
+//    AlertNotifier.cpp: Alert log and socket notifications
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+
+#include "AlertNotifier.h"
+#include <QDateTime>
+#include <QString>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netdb.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+using namespace SigDigger;
+
+AlertNotifier::AlertNotifier()
+{
+  memset(&this->addr, 0, sizeof(this->addr));
+}
+
+AlertNotifier::~AlertNotifier()
+{
+  this->closeLog();
+  this->closeSocket();
+}
+
+void
+AlertNotifier::closeLog(void)
+{
+  if (this->logFd != -1) {
+    ::close(this->logFd);
+    this->logFd = -1;
+  }
+}
+
+void
+AlertNotifier::closeSocket(void)
+{
+  if (this->sockFd != -1) {
+    ::close(this->sockFd);
+    this->sockFd = -1;
+  }
+
+  this->addrLen = 0;
+}
+
+bool
+AlertNotifier::setLogFile(std::string const &path)
+{
+  this->closeLog();
+
+  if (path.empty())
+    return true;
+
+  if ((this->logFd = open(
+         path.c_str(),
+         O_CREAT | O_APPEND | O_WRONLY,
+         0644)) == -1) {
+    this->lastError =
+        "Cannot open " + path + ": " + std::string(strerror(errno));
+    return false;
+  }
+
+  return true;
+}
+
+bool
+AlertNotifier::setTarget(std::string const &target)
+{
+  this->closeSocket();
+
+  if (target.empty())
+    return true;
+
+  if (target.compare(0, 5, "unix:") == 0) {
+    struct sockaddr_un *un =
+        reinterpret_cast<struct sockaddr_un *>(&this->addr);
+    std::string path = target.substr(5);
+
+    if (path.empty() || path.size() >= sizeof(un->sun_path)) {
+      this->lastError = "Invalid socket path " + path;
+      return false;
+    }
+
+    un->sun_family = AF_UNIX;
+    strncpy(un->sun_path, path.c_str(), sizeof(un->sun_path) - 1);
+    this->addrLen = sizeof(struct sockaddr_un);
+  } else if (target.compare(0, 4, "udp:") == 0) {
+    struct sockaddr_in *in =
+        reinterpret_cast<struct sockaddr_in *>(&this->addr);
+    size_t colon = target.rfind(':');
+    std::string host = target.substr(4, colon - 4);
+    struct hostent *ent;
+    int port = 0;
+
+    if (colon > 4)
+      port = atoi(target.c_str() + colon + 1);
+
+    if (port <= 0 || port > 65535) {
+      this->lastError = "No valid port in " + target;
+      return false;
+    }
+
+    if ((ent = gethostbyname(host.c_str())) == nullptr) {
+      this->lastError = "Failed to resolve hostname " + host;
+      return false;
+    }
+
+    in->sin_family = AF_INET;
+    in->sin_port = htons(static_cast<uint16_t>(port));
+    in->sin_addr = *reinterpret_cast<struct in_addr *>(ent->h_addr);
+    this->addrLen = sizeof(struct sockaddr_in);
+  } else {
+    this->lastError = "Unknown notification target " + target;
+    return false;
+  }
+
+  if ((this->sockFd = socket(this->addr.ss_family, SOCK_DGRAM, 0)) == -1) {
+    this->lastError = "Failed to open socket: " + std::string(strerror(errno));
+    this->addrLen = 0;
+    return false;
+  }
+
+  return true;
+}
+
+std::string
+AlertNotifier::format(AlertEvent const &event, AlertRule const &rule)
+{
+  QString line =
+      "time="
+      + QDateTime::fromMSecsSinceEpoch(event.time).toString(Qt::ISODate)
+      + (event.type == AlertEvent::RAISED ? " event=raised" : " event=cleared")
+      + " rule=\"" + QString::fromStdString(rule.name).replace('"', '\'') + "\""
+      + " freq=" + QString::number(rule.freq)
+      + " bandwidth=" + QString::number(rule.bandwidth)
+      + " threshold="
+      + QString::number(static_cast<double>(rule.threshold), 'f', 1)
+      + (rule.relative ? " relative=1" : " relative=0");
+
+  // Rules that leave the span are cleared with no level
+  if (std::isfinite(event.level))
+    line += " level=" + QString::number(static_cast<double>(event.level), 'f', 1);
+
+  return line.toStdString() + "\n";
+}
+
+void
+AlertNotifier::notify(std::string const &line)
+{
+  if (this->logFd != -1
+      && write(this->logFd, line.c_str(), line.size())
+         != static_cast<ssize_t>(line.size()))
+    this->lastError = "Alert log write failed: " + std::string(strerror(errno));
+
+  if (this->sockFd != -1
+      && sendto(
+        this->sockFd,
+        line.c_str(),
+        line.size(),
+        MSG_DONTWAIT | MSG_NOSIGNAL,
+        reinterpret_cast<struct sockaddr *>(&this->addr),
+        this->addrLen) == -1)
+    this->lastError = "Alert notification failed: " + std::string(strerror(errno));
+}
@@ -0,0 +1,278 @@
+//
+//    AudioFileSaver.cpp: Save demodulated audio to WAV files
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+#include "AudioFileSaver.h"
+#include "AudioOutputStage.h"
+#include <QMutex>
+#include <atomic>
+#include <sstream>
+#include <iomanip>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+
+using namespace SigDigger;
+
+namespace SigDigger {
+  class AudioFileWriter : public GenericDataWriter {
+    std::string dir;
+    std::string prefix;
+    std::string path;
+    std::string lastError;
+    unsigned int rate;
+    unsigned int counter = 0;
+
+    FILE *fp = nullptr;
+    std::atomic<bool> writable;
+    uint64_t samples = 0;
+    uint64_t rotateAfter;
+
+    AudioOutputStage stage;
+    std::vector<int16_t> scratch;
+
+    mutable QMutex pathMutex;
+
+    std::string nextFileName(void);
+    bool openNext(void);
+    bool finish(void);
+
+  public:
+    AudioFileWriter(
+        std::string const &dir,
+        std::string const &prefix,
+        unsigned int rate);
+
+    std::string getPath(void) const;
+
+    bool prepare(void);
+    bool canWrite(void) const;
+    std::string getError(void) const;
+    ssize_t write(const float _Complex *data, size_t len);
+    bool close(void);
+    ~AudioFileWriter();
+  };
+}
+
+AudioFileWriter::AudioFileWriter(
+    std::string const &dir,
+    std::string const &prefix,
+    unsigned int rate) : writable(true), stage(AUDIO_FORMAT_S16)
+{
+  this->dir = dir;
+  this->prefix = prefix;
+  this->rate = rate;
+  this->rotateAfter =
+      static_cast<uint64_t>(rate) * SIGDIGGER_AUDIO_SAVER_ROTATE_SECS;
+
+  // Recordings keep the demodulator output as it is
+  this->stage.setSoftClip(false);
+}
+
+std::string
+AudioFileWriter::nextFileName(void)
+{
+  std::string path;
+
+  do {
+    std::ostringstream os;
+
+    os << "audio-"
+       << this->prefix
+       << "-"
+       << std::to_string(this->rate)
+       << "sps-"
+       << std::setw(4)
+       << std::setfill('0')
+       << ++this->counter
+       << ".wav";
+    path = this->dir + "/" + os.str();
+  } while (access(path.c_str(), F_OK) != -1);
+
+  return path;
+}
+
+bool
+AudioFileWriter::openNext(void)
+{
+  uint8_t hdr[SIGDIGGER_WAV_HEADER_SIZE];
+  std::string path = this->nextFileName();
+
+  if ((this->fp = fopen(path.c_str(), "wb")) == nullptr) {
+    this->lastError =
+        "Cannot open " + path + " for writing: " + std::string(strerror(errno));
+    return false;
+  }
+
+  // Placeholder header, lengths are fixed when the file is finished
+  composeWavHeader(hdr, this->rate, 1, AUDIO_FORMAT_S16, 0);
+
+  if (fwrite(hdr, sizeof(hdr), 1, this->fp) != 1) {
+    this->lastError = "write() failed: " + std::string(strerror(errno));
+    fclose(this->fp);
+    this->fp = nullptr;
+    return false;
+  }
+
+  this->samples = 0;
+
+  {
+    QMutexLocker locker(&this->pathMutex);
+    this->path = path;
+  }
+
+  return true;
+}
+
+bool
+AudioFileWriter::finish(void)
+{
+  uint8_t hdr[SIGDIGGER_WAV_HEADER_SIZE];
+  bool ok = true;
+
+  if (this->fp == nullptr)
+    return true;
+
+  composeWavHeader(
+        hdr,
+        this->rate,
+        1,
+        AUDIO_FORMAT_S16,
+        static_cast<uint32_t>(this->samples * sizeof(int16_t)));
+
+  if (fseek(this->fp, 0, SEEK_SET) != 0
+      || fwrite(hdr, sizeof(hdr), 1, this->fp) != 1) {
+    this->lastError = "Failed to finalize WAV header: "
+        + std::string(strerror(errno));
+    ok = false;
+  }
+
+  if (fclose(this->fp) != 0)
+    ok = false;
+
+  this->fp = nullptr;
+
+  return ok;
+}
+
+std::string
+AudioFileWriter::getPath(void) const
+{
+  QMutexLocker locker(&this->pathMutex);
+
+  return this->path;
+}
+
+std::string
+AudioFileWriter::getError(void) const
+{
+  return this->lastError;
+}
+
+bool
+AudioFileWriter::prepare(void)
+{
+  return this->openNext();
+}
+
+//
+// Called from the producer thread, hence the flag: fp changes on rotation.
+// It stays up until close() so that the saver reports open and rotation
+// failures through stopped().
+//
+bool
+AudioFileWriter::canWrite(void) const
+{
+  return this->writable;
+}
+
+ssize_t
+AudioFileWriter::write(const float _Complex *data, size_t len)
+{
+  if (this->fp == nullptr)
+    return 0;
+
+  // Rotate before writing, so that a file never exceeds rotateAfter
+  if (this->samples >= this->rotateAfter) {
+    if (!this->finish() || !this->openNext())
+      return 0;
+  }
+
+  if (len > this->rotateAfter - this->samples)
+    len = this->rotateAfter - this->samples;
+
+  if (this->scratch.size() < len)
+    this->scratch.resize(len);
+
+  this->stage.write(this->scratch.data(), data, len);
+
+  if (fwrite(this->scratch.data(), sizeof(int16_t), len, this->fp) != len) {
+    this->lastError = "write() failed: " + std::string(strerror(errno));
+    return 0;
+  }
+
+  this->samples += len;
+
+  return static_cast<ssize_t>(len);
+}
+
+bool
+AudioFileWriter::close(void)
+{
+  this->writable = false;
+
+  return this->finish();
+}
+
+AudioFileWriter::~AudioFileWriter()
+{
+  this->close();
+}
+
+//////////////////////////// AudioFileSaver ////////////////////////////////////
+AudioFileSaver::AudioFileSaver(
+    std::string const &dir,
+    std::string const &prefix,
+    unsigned int rate,
+    QObject *parent) :
+  GenericDataSaver(new AudioFileWriter(dir, prefix, rate), parent)
+{
+  this->setSampleRate(rate);
+}
+
+// The writer is kept by the base class, which gets it before this
+// object exists
+AudioFileWriter *
+AudioFileSaver::getAudioWriter(void) const
+{
+  return static_cast<AudioFileWriter *>(this->getWriter());
+}
+
+std::string
+AudioFileSaver::getCurrentFile(void) const
+{
+  return this->getAudioWriter()->getPath();
+}
+
+AudioFileSaver::~AudioFileSaver(void)
+{
+  AudioFileWriter *writer = this->getAudioWriter();
+
+  this->shutdown();
+  delete writer;
+}
@@ -18,33 +18,259 @@
 //
 
 #include "Averager.h"
+#include "PowerMath.h"
+#include <cstdlib>
+#include <cstring>
 
 using namespace SigDigger;
 
+enum AveragerMean {
+  AVERAGER_MEAN_NONE,
+  AVERAGER_MEAN_EXPONENTIAL,
+  AVERAGER_MEAN_WINDOW
+};
+
+struct AveragerPass {
+  const float *in;
+  size_t size;
+  float *mean;
+  float *acc;
+  float *sum;
+  float *slot;
+  float *max;
+  float *min;
+  float alpha;
+  float scale;
+  float decay;
+};
+
+//
+// One instance per combination of enabled modes, so that the loop body
+// carries no branches. In dB mode, the exponential state is the output
+// itself and `acc' is not used.
+//
+template <int Mean, bool Hold, bool Linear>
+static void
+fusedPass(AveragerPass const &p)
+{
+  const float *__restrict__ in = p.in;
+  float *__restrict__ mean = p.mean;
+  float *__restrict__ acc  = p.acc;
+  float *__restrict__ sum  = p.sum;
+  float *__restrict__ slot = p.slot;
+  float *__restrict__ max  = p.max;
+  float *__restrict__ min  = p.min;
+  float alpha = p.alpha;
+  float scale = p.scale;
+  float decay = p.decay;
+
+#pragma omp simd
+  for (size_t i = 0; i < p.size; ++i) {
+    float x = in[i];
+
+    if (Hold) {
+      float m = max[i] - decay;
+      max[i] = x > m ? x : m;
+      min[i] = x < min[i] ? x : min[i];
+    }
+
+    if (Mean != AVERAGER_MEAN_NONE) {
+      float v = Linear ? powerFromLog2(SIGDIGGER_DB_TO_LOG2 * x) : x;
+      float r;
+
+      if (Mean == AVERAGER_MEAN_EXPONENTIAL) {
+        float prev = Linear ? acc[i] : mean[i];
+        r = prev + alpha * (v - prev);
+        if (Linear)
+          acc[i] = r;
+      } else {
+        r = sum[i] + v - slot[i];
+        sum[i]  = r;
+        slot[i] = v;
+        r *= scale;
+      }
+
+      mean[i] = Linear ? SIGDIGGER_LOG2_TO_DB * log2FromPower(r) : r;
+    }
+  }
+}
+
+template <int Mean, bool Hold>
+static void
+fusedPass(AveragerPass const &p, bool linear)
+{
+  if (linear)
+    fusedPass<Mean, Hold, true>(p);
+  else
+    fusedPass<Mean, Hold, false>(p);
+}
+
+template <int Mean>
+static void
+fusedPass(AveragerPass const &p, bool hold, bool linear)
+{
+  if (hold)
+    fusedPass<Mean, true>(p, linear);
+  else
+    fusedPass<Mean, false>(p, linear);
+}
+
+// The first PSD fills every state, as if it had always been there
+template <bool Linear>
+static void
+initialPass(AveragerPass const &p)
+{
+  const float *__restrict__ in = p.in;
+  float *__restrict__ mean = p.mean;
+  float *__restrict__ acc  = p.acc;
+  float *__restrict__ sum  = p.sum;
+  float *__restrict__ max  = p.max;
+  float *__restrict__ min  = p.min;
+  float n = p.scale;
+
+#pragma omp simd
+  for (size_t i = 0; i < p.size; ++i) {
+    float v = Linear ? powerFromLog2(SIGDIGGER_DB_TO_LOG2 * in[i]) : in[i];
+
+    mean[i] = max[i] = min[i] = in[i];
+    acc[i]  = v;
+    sum[i]  = n * v;
+  }
+}
+
 void
-Averager::feed(Suscan::PSDMessage const &m)
+Averager::allocate(unsigned long size)
 {
-  bool blend = this->alpha != 1.f;
-
-  if (this->last == nullptr || m.size() != this->bufsiz) {
-    try {
-      float *buf = new float[m.size()];
-      if (this->last != nullptr)
-        delete [] this->last;
-      this->last = buf;
-      this->bufsiz = m.size();
-      blend = false;
-    } catch (std::bad_alloc &) {
+  size_t perRow = SIGDIGGER_AVERAGER_ALIGN / sizeof(float);
+  size_t stride = (size + perRow - 1) / perRow * perRow;
+  bool windowed = this->mode == MODE_WINDOW;
+  size_t needed = (5 + (windowed ? this->window : 0)) * stride;
+  float *block = this->block;
+
+  if (needed > this->capacity) {
+    void *mem;
+
+    if (posix_memalign(
+          &mem,
+          SIGDIGGER_AVERAGER_ALIGN,
+          needed * sizeof(float)) != 0)
       throw Suscan::Exception("Failed to allocate PSD buffer");
+
+    free(this->block);
+    block = this->block = static_cast<float *>(mem);
+    this->capacity = needed;
+  }
+
+  this->bufsiz  = size;
+  this->stride  = stride;
+  this->mean    = block;
+  this->acc     = block + stride;
+  this->sum     = block + 2 * stride;
+  this->max     = block + 3 * stride;
+  this->min     = block + 4 * stride;
+  this->ring    = windowed ? block + 5 * stride : nullptr;
+  this->restart = true;
+}
+
+void
+Averager::feed(Suscan::PSDMessage const &m)
+{
+  this->feed(m.get(), m.size());
+}
+
+void
+Averager::feed(const float *__restrict__ in, size_t size)
+{
+  int meanMode = AVERAGER_MEAN_NONE;
+  bool hold = this->holds
+      || this->mode == MODE_MAX_HOLD
+      || this->mode == MODE_MIN_HOLD;
+  AveragerPass pass;
+
+  if (this->block == nullptr || size != this->bufsiz || this->restart)
+    this->allocate(size);
+
+  pass.in    = in;
+  pass.size  = size;
+  pass.mean  = this->mean;
+  pass.acc   = this->acc;
+  pass.sum   = this->sum;
+  pass.slot  = this->ring != nullptr
+      ? this->ring + this->slot * this->stride
+      : nullptr;
+  pass.max   = this->max;
+  pass.min   = this->min;
+  pass.alpha = this->alpha;
+  pass.scale = 1.f / this->window;
+  pass.decay = this->decay;
+
+  if (this->restart) {
+    pass.scale = this->window;
+
+    if (this->linear)
+      initialPass<true>(pass);
+    else
+      initialPass<false>(pass);
+
+    if (this->ring != nullptr)
+      for (unsigned int j = 0; j < this->window; ++j)
+        memcpy(
+            this->ring + j * this->stride,
+            this->acc,
+            size * sizeof(float));
+
+    this->slot = 0;
+    this->restart = false;
+    return;
+  }
+
+  if (this->mode == MODE_EXPONENTIAL)
+    meanMode = AVERAGER_MEAN_EXPONENTIAL;
+  else if (this->mode == MODE_WINDOW)
+    meanMode = AVERAGER_MEAN_WINDOW;
+
+  switch (meanMode) {
+    case AVERAGER_MEAN_EXPONENTIAL:
+      fusedPass<AVERAGER_MEAN_EXPONENTIAL>(pass, hold, this->linear);
+      break;
+
+    case AVERAGER_MEAN_WINDOW:
+      fusedPass<AVERAGER_MEAN_WINDOW>(pass, hold, this->linear);
+      break;
+
+    default:
+      fusedPass<AVERAGER_MEAN_NONE>(pass, hold, this->linear);
+  }
+
+  // Running sums drift. Once per turn of the ring, they are recomputed
+  // from the values they are made of.
+  if (meanMode == AVERAGER_MEAN_WINDOW
+      && ++this->slot == this->window) {
+    float *__restrict__ sum = this->sum;
+
+    this->slot = 0;
+
+    for (unsigned int j = 0; j < this->window; ++j) {
+      const float *__restrict__ row = this->ring + j * this->stride;
+#pragma omp simd
+      for (size_t i = 0; i < size; ++i)
+        sum[i] = (j == 0 ? 0 : sum[i]) + row[i];
     }
   }
+}
+
+float *
+Averager::get(void) const
+{
+  switch (this->mode) {
+    case MODE_MAX_HOLD:
+      return this->max;
+
+    case MODE_MIN_HOLD:
+      return this->min;
 
-  if (blend) {
-    const SUFLOAT *original = m.get();
-    for (unsigned long i = 0; i < this->bufsiz; ++i)
-      this->last[i] += this->alpha * (original[i] - this->last[i]);
-  } else {
-    memcpy(this->last, m.get(), m.size() * sizeof(float));
+    default:
+      return this->mean;
   }
 }
 
@@ -54,8 +280,54 @@ Averager::setAlpha(float alpha)
   this->alpha = alpha;
 }
 
-Averager::~Averager(void)
+void
+Averager::setMode(Mode mode)
 {
-  this->reset();
+  if (this->mode != mode) {
+    this->mode = mode;
+    this->restart = true;
+  }
 }
 
+void
+Averager::setWindow(unsigned int frames)
+{
+  if (frames < 1)
+    frames = 1;
+  else if (frames > SIGDIGGER_AVERAGER_MAX_WINDOW)
+    frames = SIGDIGGER_AVERAGER_MAX_WINDOW;
+
+  if (this->window != frames) {
+    this->window = frames;
+    this->restart = true;
+  }
+}
+
+void
+Averager::setDecay(float dBPerUpdate)
+{
+  this->decay = dBPerUpdate;
+}
+
+void
+Averager::setLinear(bool linear)
+{
+  if (this->linear != linear) {
+    this->linear = linear;
+    this->restart = true;
+  }
+}
+
+void
+Averager::setHoldsEnabled(bool enabled)
+{
+  if (this->holds != enabled) {
+    this->holds = enabled;
+    this->restart = true;
+  }
+}
+
+Averager::~Averager(void)
+{
+  free(this->block);
+}
@@ -0,0 +1,212 @@
+//
+//    BandMeter.cpp: Band power meters
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+#include "BandMeter.h"
+#include "PowerMath.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace SigDigger;
+
+//
+// Changing the frequency or width of a band (or adding and removing
+// bands) starts a new log. Renaming does not.
+//
+void
+BandMeter::setBands(std::vector<BandMeterBand> const &bands)
+{
+  bool same = bands.size() == this->bands.size();
+
+  for (size_t i = 0; same && i < bands.size(); ++i)
+    same = bands[i].freq == this->bands[i].freq
+        && bands[i].bandwidth == this->bands[i].bandwidth;
+
+  this->bands = bands;
+
+  if (!same) {
+    this->readings.assign(bands.size(), BandMeterReading());
+    this->clearLog();
+  }
+}
+
+void
+BandMeter::clearLog(void)
+{
+  this->sums.assign(this->bands.size(), 0);
+  this->hits.assign(this->bands.size(), 0);
+  this->start = -1;
+
+  this->log.assign(
+        this->bands.size() * SIGDIGGER_BAND_METER_LOG_LENGTH,
+        std::numeric_limits<float>::quiet_NaN());
+  this->times.assign(SIGDIGGER_BAND_METER_LOG_LENGTH, 0);
+  this->head  = 0;
+  this->count = 0;
+}
+
+//
+// prefix[i] is the linear power of bins [0, i). Conversion is done in
+// blocks so that the vectorized part stays in cache, the running sum
+// (which cannot be vectorized) is kept in double so that narrow bands at
+// the end of a large FFT do not lose their digits.
+//
+void
+BandMeter::integrate(const float *psd, size_t size)
+{
+  double *prefix;
+  double acc = 0;
+  size_t i, j, n;
+
+  this->prefix.resize(size + 1);
+  prefix = this->prefix.data();
+  prefix[0] = 0;
+
+  for (j = 0; j < size; j += n) {
+    const float *__restrict__ in = psd + j;
+    float *__restrict__ out = this->block;
+
+    n = std::min<size_t>(size - j, SIGDIGGER_BAND_METER_BLOCK);
+
+#pragma omp simd
+    for (i = 0; i < n; ++i)
+      out[i] = powerFromLog2(SIGDIGGER_DB_TO_LOG2 * in[i]);
+
+    for (i = 0; i < n; ++i) {
+      acc += static_cast<double>(out[i]);
+      prefix[j + i + 1] = acc;
+    }
+  }
+}
+
+void
+BandMeter::flush(void)
+{
+  float *row = this->log.data() + this->head * this->bands.size();
+
+  for (size_t b = 0; b < this->bands.size(); ++b) {
+    row[b] = this->hits[b] > 0
+        ? static_cast<float>(10 * std::log10(this->sums[b] / this->hits[b]))
+        : std::numeric_limits<float>::quiet_NaN();
+    this->sums[b] = 0;
+    this->hits[b] = 0;
+  }
+
+  this->times[this->head] = this->start;
+  this->head = (this->head + 1) % SIGDIGGER_BAND_METER_LOG_LENGTH;
+  if (this->count < SIGDIGGER_BAND_METER_LOG_LENGTH)
+    ++this->count;
+}
+
+//
+// Power of bins [0, u), u in bins (bin k spans [k, k + 1)). The bin u
+// falls in counts for the fraction of it below u, as if its power were
+// spread evenly over its width.
+//
+double
+BandMeter::cumulative(const float *psd, size_t size, qreal u) const
+{
+  size_t k;
+
+  if (u <= 0)
+    return 0;
+
+  if (u >= size)
+    return this->prefix[size];
+
+  k = static_cast<size_t>(u);
+
+  return this->prefix[k]
+      + (u - k) * static_cast<double>(
+        powerFromLog2(SIGDIGGER_DB_TO_LOG2 * psd[k]));
+}
+
+//
+// PSD bins are centered at fc + (k - size / 2) * rate / size, and each
+// one is rate / size wide. A band takes the power of the bins it covers,
+// edge bins in proportion to how much of them is inside, so a band
+// narrower than a bin gets its share of the one it falls in.
+//
+void
+BandMeter::feed(
+    const float *psd,
+    size_t size,
+    qint64 fc,
+    qreal rate,
+    qint64 now)
+{
+  qreal binsPerHz, half;
+
+  if (this->bands.empty() || size == 0 || rate <= 0)
+    return;
+
+  if (this->start < 0)
+    this->start = now;
+  else if (now - this->start >= SIGDIGGER_BAND_METER_LOG_INTERVAL_MS) {
+    this->flush();
+    this->start = now;
+  }
+
+  this->integrate(psd, size);
+
+  binsPerHz = size / rate;
+  half = .5 * size + .5;
+
+  for (size_t b = 0; b < this->bands.size(); ++b) {
+    BandMeterBand const &band = this->bands[b];
+    BandMeterReading &r = this->readings[b];
+    qreal lo = (band.freq - fc - .5 * band.bandwidth) * binsPerHz + half;
+    qreal hi = (band.freq - fc + .5 * band.bandwidth) * binsPerHz + half;
+    double sum;
+
+    lo = std::max<qreal>(lo, 0);
+    hi = std::min<qreal>(hi, size);
+
+    r.valid = lo < hi;
+    if (!r.valid)
+      continue;
+
+    sum = this->cumulative(psd, size, hi) - this->cumulative(psd, size, lo);
+
+    r.power = static_cast<float>(10 * std::log10(sum));
+    r.level = static_cast<float>(10 * std::log10(sum / (hi - lo)));
+
+    this->sums[b] += sum;
+    ++this->hits[b];
+  }
+}
+
+qint64
+BandMeter::getLogTime(size_t index) const
+{
+  size_t first = (this->head + SIGDIGGER_BAND_METER_LOG_LENGTH - this->count)
+      % SIGDIGGER_BAND_METER_LOG_LENGTH;
+
+  return this->times[(first + index) % SIGDIGGER_BAND_METER_LOG_LENGTH];
+}
+
+float
+BandMeter::getLogPower(size_t index, size_t band) const
+{
+  size_t first = (this->head + SIGDIGGER_BAND_METER_LOG_LENGTH - this->count)
+      % SIGDIGGER_BAND_METER_LOG_LENGTH;
+  size_t row = (first + index) % SIGDIGGER_BAND_METER_LOG_LENGTH;
+
+  return this->log[row * this->bands.size() + band];
+}
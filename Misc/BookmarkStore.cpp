@@ -0,0 +1,377 @@
+//
+//    BookmarkStore.cpp: Frequency bookmarks and band plans
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+
+#include "BookmarkStore.h"
+#include <QFile>
+#include <QSaveFile>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <strings.h>
+
+using namespace SigDigger;
+
+//
+// maxHi[mid] covers entries [begin, end), with mid = (begin + end) / 2.
+// Returns it, or the lowest possible value for an empty range.
+//
+static qint64
+buildMaxHi(
+    std::vector<Bookmark> const &entries,
+    std::vector<qint64> &maxHi,
+    size_t begin,
+    size_t end)
+{
+  size_t mid;
+  qint64 max;
+
+  if (begin >= end)
+    return INT64_MIN;
+
+  mid = (begin + end) / 2;
+  max = std::max(
+        entries[mid].hi,
+        std::max(
+          buildMaxHi(entries, maxHi, begin, mid),
+          buildMaxHi(entries, maxHi, mid + 1, end)));
+
+  maxHi[mid] = max;
+
+  return max;
+}
+
+void
+BookmarkStore::index(void)
+{
+  std::stable_sort(
+        this->entries.begin(),
+        this->entries.end(),
+        [] (Bookmark const &a, Bookmark const &b) {
+          return a.lo < b.lo;
+        });
+
+  this->maxHi.resize(this->entries.size());
+  buildMaxHi(this->entries, this->maxHi, 0, this->entries.size());
+}
+
+void
+BookmarkStore::add(Bookmark const &bookmark)
+{
+  this->entries.push_back(bookmark);
+  this->index();
+}
+
+void
+BookmarkStore::addAll(std::vector<Bookmark> &&bookmarks)
+{
+  if (this->entries.empty())
+    this->entries = std::move(bookmarks);
+  else
+    this->entries.insert(
+          this->entries.end(),
+          std::make_move_iterator(bookmarks.begin()),
+          std::make_move_iterator(bookmarks.end()));
+
+  this->index();
+}
+
+void
+BookmarkStore::remove(size_t index)
+{
+  if (index < this->entries.size()) {
+    this->entries.erase(this->entries.begin() + static_cast<long>(index));
+    this->index();
+  }
+}
+
+void
+BookmarkStore::clear(void)
+{
+  this->entries.clear();
+  this->maxHi.clear();
+}
+
+void
+BookmarkStore::query(
+    size_t begin,
+    size_t end,
+    qint64 from,
+    qint64 to,
+    std::vector<size_t> &out,
+    size_t max) const
+{
+  size_t mid;
+
+  if (begin >= end || out.size() >= max)
+    return;
+
+  mid = (begin + end) / 2;
+
+  // Nothing in this range reaches the span
+  if (this->maxHi[mid] < from)
+    return;
+
+  this->query(begin, mid, from, to, out, max);
+
+  // Neither this entry nor the ones after it start before the end
+  if (this->entries[mid].lo > to || out.size() >= max)
+    return;
+
+  if (this->entries[mid].hi >= from)
+    out.push_back(mid);
+
+  this->query(mid + 1, end, from, to, out, max);
+}
+
+void
+BookmarkStore::query(
+    qint64 from,
+    qint64 to,
+    std::vector<size_t> &out,
+    size_t max) const
+{
+  out.clear();
+  this->query(0, this->entries.size(), from, to, out, max);
+}
+
+//////////////////////////////////// CSV //////////////////////////////////////
+static const char *
+parseField(const char *p, const char *end, std::string &field)
+{
+  field.clear();
+
+  while (p < end && (*p == ' ' || *p == '\t'))
+    ++p;
+
+  if (p < end && *p == '"') {
+    for (++p; p < end; ++p) {
+      if (*p == '"') {
+        if (p + 1 < end && p[1] == '"')
+          ++p;
+        else
+          break;
+      }
+      field += *p;
+    }
+
+    // Anything between the closing quote and the comma is dropped
+    while (p < end && *p != ',')
+      ++p;
+  } else {
+    const char *comma = static_cast<const char *>(
+          memchr(p, ',', static_cast<size_t>(end - p)));
+    const char *last = comma != nullptr ? comma : end;
+
+    field.assign(p, last);
+    while (!field.empty()
+           && (field.back() == ' '
+               || field.back() == '\t'
+               || field.back() == '\r'))
+      field.pop_back();
+    p = last;
+  }
+
+  return p < end ? p + 1 : end;
+}
+
+static bool
+parseFrequency(std::string const &field, qint64 &freq)
+{
+  const char *str = field.c_str();
+  char *tail;
+  double value = strtod(str, &tail);
+
+  if (tail == str)
+    return false;
+
+  while (*tail == ' ')
+    ++tail;
+
+  switch (*tail) {
+    case 'k':
+    case 'K':
+      value *= 1e3;
+      ++tail;
+      break;
+
+    case 'M':
+      value *= 1e6;
+      ++tail;
+      break;
+
+    case 'G':
+      value *= 1e9;
+      ++tail;
+      break;
+  }
+
+  while (*tail == ' ')
+    ++tail;
+
+  if (strcasecmp(tail, "hz") == 0)
+    tail += 2;
+
+  if (*tail != '\0' || !std::isfinite(value) || value < 0 || value > 1e15)
+    return false;
+
+  freq = std::llround(value);
+
+  return true;
+}
+
+bool
+BookmarkStore::parseCsv(
+    const char *data,
+    size_t size,
+    std::vector<Bookmark> &out)
+{
+  const char *p = data;
+  const char *end = data + size;
+  std::string fields[4];
+  size_t before = out.size();
+
+  while (p < end) {
+    const char *nl = static_cast<const char *>(
+          memchr(p, '\n', static_cast<size_t>(end - p)));
+    const char *eol = nl != nullptr ? nl : end;
+    const char *q = p;
+    unsigned int count = 0;
+    Bookmark bookmark;
+
+    while (q < eol && count < 4)
+      q = parseField(q, eol, fields[count++]);
+
+    p = nl != nullptr ? nl + 1 : end;
+
+    if (count < 2 || !parseFrequency(fields[0], bookmark.lo))
+      continue;
+
+    if (parseFrequency(fields[1], bookmark.hi)) {
+      if (count < 3)
+        continue;
+      bookmark.name = fields[2];
+      if (count > 3 && !fields[3].empty())
+        bookmark.color = QColor(QString::fromStdString(fields[3]));
+    } else if (fields[1].empty() && count >= 3) {
+      bookmark.hi   = bookmark.lo;
+      bookmark.name = fields[2];
+      if (count > 3 && !fields[3].empty())
+        bookmark.color = QColor(QString::fromStdString(fields[3]));
+    } else {
+      bookmark.hi   = bookmark.lo;
+      bookmark.name = fields[1];
+    }
+
+    if (bookmark.hi < bookmark.lo)
+      std::swap(bookmark.lo, bookmark.hi);
+
+    out.push_back(std::move(bookmark));
+  }
+
+  return out.size() > before;
+}
+
+bool
+BookmarkStore::importCsv(QString const &path, size_t &added, QString &error)
+{
+  QFile file(path);
+  QByteArray data;
+  std::vector<Bookmark> bookmarks;
+
+  if (!file.open(QIODevice::ReadOnly)) {
+    error = file.errorString();
+    return false;
+  }
+
+  data = file.readAll();
+
+  if (!parseCsv(data.constData(), static_cast<size_t>(data.size()), bookmarks)) {
+    error = "No bookmarks found in file";
+    return false;
+  }
+
+  added = bookmarks.size();
+  this->addAll(std::move(bookmarks));
+
+  return true;
+}
+
+bool
+BookmarkStore::load(QString const &path)
+{
+  QFile file(path);
+  QByteArray data;
+  std::vector<Bookmark> bookmarks;
+
+  this->clear();
+
+  if (!file.open(QIODevice::ReadOnly))
+    return false;
+
+  data = file.readAll();
+  parseCsv(data.constData(), static_cast<size_t>(data.size()), bookmarks);
+  this->addAll(std::move(bookmarks));
+
+  return true;
+}
+
+static QByteArray
+csvQuote(std::string const &field)
+{
+  QByteArray copy = QByteArray::fromStdString(field);
+
+  if (!copy.contains(',') && !copy.contains('"'))
+    return copy;
+
+  return "\"" + copy.replace("\"", "\"\"") + "\"";
+}
+
+// Written to a temporary file first, a crash never leaves half a store
+bool
+BookmarkStore::save(QString const &path, QString &error) const
+{
+  QSaveFile file(path);
+  QByteArray line;
+
+  if (!file.open(QIODevice::WriteOnly)) {
+    error = file.errorString();
+    return false;
+  }
+
+  for (auto const &b : this->entries) {
+    line = QByteArray::number(b.lo)
+        + ","
+        + (b.hi != b.lo ? QByteArray::number(b.hi) : QByteArray())
+        + ","
+        + csvQuote(b.name)
+        + ","
+        + (b.color.isValid() ? b.color.name().toLatin1() : QByteArray())
+        + "\n";
+    file.write(line);
+  }
+
+  if (!file.commit()) {
+    error = file.errorString();
+    return false;
+  }
+
+  return true;
+}
@@ -0,0 +1,131 @@
+//
+//    FftGovernor.cpp: Automatic FFT size and refresh rate
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+#include "FftGovernor.h"
+
+using namespace SigDigger;
+
+void
+FftGovernor::setLimits(unsigned int fftSize, unsigned int refreshRate)
+{
+  unsigned int size = fftSize, rate = refreshRate;
+
+  if (fftSize == this->maxSize && refreshRate == this->maxRate)
+    return;
+
+  this->maxSize  = fftSize;
+  this->maxRate  = refreshRate;
+  this->maxLevel = 0;
+
+  while (rate / 2 >= SIGDIGGER_FFT_GOVERNOR_MIN_RATE) {
+    rate /= 2;
+    ++this->maxLevel;
+  }
+
+  while (size / 2 >= SIGDIGGER_FFT_GOVERNOR_MIN_SIZE) {
+    size /= 2;
+    ++this->maxLevel;
+  }
+
+  this->reset();
+}
+
+void
+FftGovernor::setTarget(qreal target)
+{
+  this->target = target;
+}
+
+void
+FftGovernor::reset(void)
+{
+  this->level  = 0;
+  this->over   = 0;
+  this->under  = 0;
+  this->settle = 0;
+  this->reason = REASON_NONE;
+
+  this->apply();
+}
+
+void
+FftGovernor::apply(void)
+{
+  unsigned int i;
+
+  this->size = this->maxSize;
+  this->rate = this->maxRate;
+
+  for (i = 0; i < this->level; ++i)
+    if (this->rate / 2 >= SIGDIGGER_FFT_GOVERNOR_MIN_RATE)
+      this->rate /= 2;
+    else
+      this->size /= 2;
+}
+
+bool
+FftGovernor::update(qreal processed, qreal load, unsigned int backlog)
+{
+  Reason why = REASON_NONE;
+  bool severe = false;
+
+  if (this->settle > 0) {
+    --this->settle;
+    return false;
+  }
+
+  if (processed < SIGDIGGER_FFT_GOVERNOR_LAG) {
+    why = REASON_ANALYZER;
+    severe = processed < SIGDIGGER_FFT_GOVERNOR_SEVERE_LAG;
+  } else if (backlog > SIGDIGGER_FFT_GOVERNOR_MAX_BACKLOG) {
+    why = REASON_BACKLOG;
+    severe = backlog > 4 * SIGDIGGER_FFT_GOVERNOR_MAX_BACKLOG;
+  } else if (load > this->target) {
+    why = REASON_GUI;
+  }
+
+  if (why != REASON_NONE) {
+    this->under = 0;
+
+    if (this->level < this->maxLevel
+        && (severe || ++this->over >= SIGDIGGER_FFT_GOVERNOR_DOWN_COUNT)) {
+      ++this->level;
+      this->reason = why;
+      this->over   = 0;
+      this->settle = SIGDIGGER_FFT_GOVERNOR_SETTLE_COUNT;
+      this->apply();
+      return true;
+    }
+  } else {
+    this->over = 0;
+
+    if (this->level > 0
+        && load < SIGDIGGER_FFT_GOVERNOR_UP_MARGIN * this->target
+        && ++this->under >= SIGDIGGER_FFT_GOVERNOR_UP_COUNT) {
+      --this->level;
+      this->reason = REASON_HEADROOM;
+      this->under  = 0;
+      this->settle = SIGDIGGER_FFT_GOVERNOR_SETTLE_COUNT;
+      this->apply();
+      return true;
+    }
+  }
+
+  return false;
+}
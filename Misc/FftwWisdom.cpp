@@ -0,0 +1,236 @@
+//
+//    FftwWisdom.cpp: FFTW wisdom cache and plan warm-up
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+#include "FftwWisdom.h"
+#include <QDir>
+#include <QFileInfo>
+#include <algorithm>
+#include <fftw3.h>
+
+using namespace SigDigger;
+
+FftwWisdomWorker::FftwWisdomWorker(FftwWisdom *instance)
+{
+  this->instance = instance;
+}
+
+//
+// Same problem as Suscan's plans: one dimensional, complex, out of place
+// and with buffers from the FFTW allocator. The flags are only a lower
+// bound for the wisdom that can be reused, so estimated plans benefit
+// from measured wisdom too.
+//
+bool
+FftwWisdomWorker::measure(
+    unsigned int size,
+    int sign,
+    void *in,
+    void *out)
+{
+  fftwf_plan plan;
+
+  plan = fftwf_plan_dft_1d(
+        static_cast<int>(size),
+        static_cast<fftwf_complex *>(in),
+        static_cast<fftwf_complex *>(out),
+        sign,
+        FFTW_MEASURE | FFTW_WISDOM_ONLY);
+
+  // Already known
+  if (plan != nullptr) {
+    fftwf_destroy_plan(plan);
+    return false;
+  }
+
+  plan = fftwf_plan_dft_1d(
+        static_cast<int>(size),
+        static_cast<fftwf_complex *>(in),
+        static_cast<fftwf_complex *>(out),
+        sign,
+        FFTW_MEASURE);
+
+  if (plan == nullptr)
+    return false;
+
+  fftwf_destroy_plan(plan);
+
+  return true;
+}
+
+void
+FftwWisdomWorker::onWarmUp(void)
+{
+  std::vector<unsigned int> const &sizes = this->instance->sizes;
+  fftwf_complex *in = nullptr;
+  fftwf_complex *out = nullptr;
+  unsigned int planned = 0;
+
+  if (!sizes.empty()) {
+    size_t max = *std::max_element(sizes.begin(), sizes.end());
+
+    in  = fftwf_alloc_complex(max);
+    out = fftwf_alloc_complex(max);
+  }
+
+  if (in != nullptr && out != nullptr) {
+    for (auto size : sizes) {
+      if (this->instance->cancelled)
+        break;
+
+      if (this->measure(size, FFTW_FORWARD, in, out))
+        ++planned;
+
+      if (this->instance->cancelled)
+        break;
+
+      if (this->measure(size, FFTW_BACKWARD, in, out))
+        ++planned;
+    }
+  }
+
+  if (in != nullptr)
+    fftwf_free(in);
+
+  if (out != nullptr)
+    fftwf_free(out);
+
+  // Keep what was measured even if SigDigger does not exit cleanly
+  if (planned > 0)
+    (void) FftwWisdom::save();
+
+  emit finished(planned);
+}
+
+FftwWisdom::FftwWisdom(QObject *parent) :
+  QObject(parent), cancelled(false), workerObject(this)
+{
+  QObject::connect(
+        this,
+        SIGNAL(start()),
+        &this->workerObject,
+        SLOT(onWarmUp()));
+
+  QObject::connect(
+        &this->workerObject,
+        SIGNAL(finished(unsigned int)),
+        this,
+        SLOT(onFinished(unsigned int)));
+
+  this->workerObject.moveToThread(&this->workerThread);
+  this->workerThread.start(QThread::LowestPriority);
+}
+
+FftwWisdom::~FftwWisdom()
+{
+  this->stop();
+}
+
+QString
+FftwWisdom::getPath(void)
+{
+  return QDir::homePath() + "/.suscan/" SIGDIGGER_FFTW_WISDOM_FILE;
+}
+
+//
+// The planner is not reentrant unless told otherwise, and the warm-up
+// plans while Suscan may be planning too. A missing file is not an
+// error: it will be created on exit.
+//
+bool
+FftwWisdom::load(void)
+{
+  QString path = getPath();
+
+  fftwf_make_planner_thread_safe();
+
+  if (!QFile::exists(path))
+    return true;
+
+  return fftwf_import_wisdom_from_filename(
+        path.toLocal8Bit().constData()) != 0;
+}
+
+bool
+FftwWisdom::save(void)
+{
+  QString path = getPath();
+
+  if (!QDir().mkpath(QFileInfo(path).absolutePath()))
+    return false;
+
+  return fftwf_export_wisdom_to_filename(
+        path.toLocal8Bit().constData()) != 0;
+}
+
+//
+// Sizes are planned from the smallest up, so the cheapest ones (and the
+// default analyzer size) are ready first.
+//
+bool
+FftwWisdom::warmUp(std::vector<unsigned int> const &sizes)
+{
+  unsigned int size;
+
+  if (this->busy || this->cancelled)
+    return false;
+
+  this->sizes.clear();
+
+  for (auto s : sizes)
+    if (s > 0)
+      this->sizes.push_back(s);
+
+  for (
+       size = SIGDIGGER_FFTW_WISDOM_INSPECTOR_MIN;
+       size <= SIGDIGGER_FFTW_WISDOM_INSPECTOR_MAX;
+       size <<= 1)
+    this->sizes.push_back(size);
+
+  std::sort(this->sizes.begin(), this->sizes.end());
+  this->sizes.erase(
+        std::unique(this->sizes.begin(), this->sizes.end()),
+        this->sizes.end());
+
+  this->busy = true;
+
+  emit start();
+
+  return true;
+}
+
+void
+FftwWisdom::stop(void)
+{
+  this->cancelled = true;
+  this->workerThread.quit();
+  this->workerThread.wait();
+}
+
+bool
+FftwWisdom::isBusy(void) const
+{
+  return this->busy;
+}
+
+void
+FftwWisdom::onFinished(unsigned int planned)
+{
+  this->busy = false;
+  emit finished(planned);
+}
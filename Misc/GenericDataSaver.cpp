@@ -145,17 +145,27 @@ GenericDataSaver::GenericDataSaver(
   emit prepare();
 }
 
-GenericDataSaver::~GenericDataSaver()
+void
+GenericDataSaver::shutdown(void)
 {
-  this->workerThread.quit();
-  this->workerThread.wait();
+  if (this->writer != nullptr) {
+    this->workerThread.quit();
+    this->workerThread.wait();
 
-  if (this->writer->canWrite()) {
-    QMutexLocker locker(&this->dataMutex);
-    this->writer->close();
+    if (this->writer->canWrite()) {
+      QMutexLocker locker(&this->dataMutex);
+      this->writer->close();
+    }
+
+    this->writer = nullptr;
   }
 }
 
+GenericDataSaver::~GenericDataSaver()
+{
+  this->shutdown();
+}
+
 // Protected by mutex
 void
 GenericDataSaver::doCommit(void)
@@ -209,7 +219,7 @@ GenericDataSaver::setBufferSize(unsigned int size)
 void
 GenericDataSaver::write(const float _Complex *data, size_t size)
 {
-  if (this->writer->canWrite()) {
+  if (this->writer != nullptr && this->writer->canWrite()) {
     QMutexLocker locker(&this->dataMutex);
     size_t totalSize = this->buffers[this->buffer].size();
     size_t avail = totalSize - this->ptr;
@@ -0,0 +1,232 @@
+//
+//    NoiseFloor.cpp: Streaming noise floor estimator
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+#include "NoiseFloor.h"
+#include <algorithm>
+#include <cstdint>
+
+using namespace SigDigger;
+
+NoiseFloor::NoiseFloor()
+{
+  this->setQuantile(this->quantile);
+}
+
+void
+NoiseFloor::setQuantile(float quantile)
+{
+  float p = std::min(std::max(quantile, .01f), .99f);
+
+  this->quantile = p;
+  this->dn[0] = 0;
+  this->dn[1] = p / 2;
+  this->dn[2] = p;
+  this->dn[3] = (1 + p) / 2;
+  this->dn[4] = 1;
+
+  this->reset();
+}
+
+void
+NoiseFloor::reset(void)
+{
+  for (auto &s : this->sketches)
+    s.count = 0;
+}
+
+void
+NoiseFloor::resize(size_t size)
+{
+  this->bins  = size;
+  this->bands = std::min<size_t>(size, SIGDIGGER_NOISE_FLOOR_BANDS);
+  this->band  = (size + this->bands - 1) / this->bands;
+  this->bands = (size + this->band - 1) / this->band;
+
+  this->sketches.resize(this->bands);
+  this->estimates.resize(this->bands);
+  this->scratch.resize(this->bands);
+  this->trace.resize(size);
+
+  this->reset();
+}
+
+//
+// One step of the P^2 algorithm (Jain & Chlamtac, 1985). Positions are
+// kept as floats so they can be scaled down to forget old observations.
+//
+void
+NoiseFloor::update(Sketch &s, float x)
+{
+  int i, k;
+
+  if (s.count < 5) {
+    s.q[s.count++] = x;
+
+    if (s.count == 5) {
+      std::sort(s.q, s.q + 5);
+
+      for (i = 0; i < 5; ++i) {
+        s.n[i]  = i + 1;
+        s.np[i] = 1 + 4 * this->dn[i];
+      }
+    }
+
+    return;
+  }
+
+  if (x < s.q[0]) {
+    s.q[0] = x;
+    k = 0;
+  } else if (x >= s.q[4]) {
+    s.q[4] = x;
+    k = 3;
+  } else {
+    for (k = 0; k < 3 && x >= s.q[k + 1]; ++k);
+  }
+
+  for (i = k + 1; i < 5; ++i)
+    s.n[i] += 1;
+
+  for (i = 0; i < 5; ++i)
+    s.np[i] += this->dn[i];
+
+  for (i = 1; i < 4; ++i) {
+    float d = s.np[i] - s.n[i];
+
+    if ((d >= 1 && s.n[i + 1] - s.n[i] > 1)
+        || (d <= -1 && s.n[i - 1] - s.n[i] < -1)) {
+      float sign = d > 0 ? 1.f : -1.f;
+      int j = i + (d > 0 ? 1 : -1);
+      float qp = s.q[i] + sign / (s.n[i + 1] - s.n[i - 1])
+          * ((s.n[i] - s.n[i - 1] + sign)
+             * (s.q[i + 1] - s.q[i]) / (s.n[i + 1] - s.n[i])
+             + (s.n[i + 1] - s.n[i] - sign)
+             * (s.q[i] - s.q[i - 1]) / (s.n[i] - s.n[i - 1]));
+
+      // Parabolic prediction, unless it breaks the marker order
+      if (s.q[i - 1] < qp && qp < s.q[i + 1])
+        s.q[i] = qp;
+      else
+        s.q[i] += sign * (s.q[j] - s.q[i]) / (s.n[j] - s.n[i]);
+
+      s.n[i] += sign;
+    }
+  }
+
+  // Halve the weight of everything seen so far
+  if (s.n[4] > SIGDIGGER_NOISE_FLOOR_WINDOW)
+    for (i = 0; i < 5; ++i) {
+      s.n[i]  = 1 + .5f * (s.n[i] - 1);
+      s.np[i] = 1 + .5f * (s.np[i] - 1);
+    }
+}
+
+float
+NoiseFloor::estimate(Sketch const &s) const
+{
+  float q[5];
+
+  if (s.count >= 5)
+    return s.q[2];
+
+  std::copy(s.q, s.q + s.count, q);
+  std::sort(q, q + s.count);
+
+  return q[static_cast<unsigned int>(this->quantile * (s.count - 1) + .5f)];
+}
+
+// Linear between band centers, flat beyond the outer ones
+void
+NoiseFloor::interpolate(void)
+{
+  float *__restrict__ trace = this->trace.data();
+  const float *est = this->estimates.data();
+  float half = .5f * this->band;
+  size_t i, j, start, end;
+
+  end = std::min<size_t>(static_cast<size_t>(half), this->bins);
+  for (i = 0; i < end; ++i)
+    trace[i] = est[0];
+
+  for (j = 0; j + 1 < this->bands; ++j) {
+    float center = j * this->band + half;
+    float slope = (est[j + 1] - est[j]) / this->band;
+    float base = est[j];
+
+    start = static_cast<size_t>(center);
+    end   = std::min<size_t>(
+          static_cast<size_t>(center + this->band),
+          this->bins);
+    base += slope * (start - center);
+
+#pragma omp simd
+    for (i = start; i < end; ++i)
+      trace[i] = base + slope * static_cast<int32_t>(i - start);
+  }
+
+  start = static_cast<size_t>((this->bands - 1) * this->band + half);
+  for (i = start; i < this->bins; ++i)
+    trace[i] = est[this->bands - 1];
+}
+
+void
+NoiseFloor::feed(Suscan::PSDMessage const &m)
+{
+  this->feed(m.get(), m.size());
+}
+
+void
+NoiseFloor::feed(const float *psd, size_t size)
+{
+  size_t j, i, start, end;
+
+  if (size == 0)
+    return;
+
+  // Fed the full resolution PSD, so this only happens when the FFT size
+  // changes: band levels of a different bin width are not comparable
+  if (size != this->bins)
+    this->resize(size);
+
+  for (j = 0; j < this->bands; ++j) {
+    float sum = 0;
+
+    start = j * this->band;
+    end   = std::min(start + this->band, size);
+
+#pragma omp simd reduction(+:sum)
+    for (i = start; i < end; ++i)
+      sum += psd[i];
+
+    this->update(this->sketches[j], sum / (end - start));
+    this->estimates[j] = this->estimate(this->sketches[j]);
+  }
+
+  this->interpolate();
+
+  std::copy(
+        this->estimates.begin(),
+        this->estimates.end(),
+        this->scratch.begin());
+  std::nth_element(
+        this->scratch.begin(),
+        this->scratch.begin() + static_cast<long>(this->bands / 2),
+        this->scratch.end());
+  this->floor = this->scratch[this->bands / 2];
+}
@@ -0,0 +1,301 @@
+//
+//    Occupancy.cpp: Spectrum occupancy and duty cycle statistics
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+
+#include "Occupancy.h"
+#include "PowerMath.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace SigDigger;
+
+void
+Occupancy::setThreshold(float threshold, bool relative)
+{
+  if (threshold != this->threshold || relative != this->relative) {
+    this->threshold = threshold;
+    this->relative  = relative;
+    this->reset();
+  }
+}
+
+void
+Occupancy::reset(void)
+{
+  std::fill(this->hits.begin(), this->hits.end(), 0);
+  std::fill(this->acc.begin(), this->acc.end(), 0);
+  std::fill(this->sums.begin(), this->sums.end(), 0);
+  std::fill(this->max.begin(), this->max.end(), -INFINITY);
+  std::fill(this->mark.begin(), this->mark.end(), 0);
+
+  this->frames     = 0;
+  this->pending    = 0;
+  this->start      = -1;
+  this->last       = 0;
+  this->markFrames = 0;
+  this->rows       = 0;
+  this->slot       = SIGDIGGER_OCCUPANCY_SLOT_MS;
+  this->restart    = RESTART_NONE;
+}
+
+void
+Occupancy::resize(size_t size)
+{
+  this->bins    = size;
+  this->columns = static_cast<unsigned int>(
+        std::min<size_t>(size, SIGDIGGER_OCCUPANCY_COLUMNS));
+
+  this->hits.resize(size);
+  this->acc.resize(size);
+  this->sums.resize(size);
+  this->max.resize(size);
+  this->mark.resize(size);
+
+  this->heatmap.resize(SIGDIGGER_OCCUPANCY_ROWS * this->columns);
+  this->rowFrames.resize(SIGDIGGER_OCCUPANCY_ROWS);
+  this->rowTimes.resize(SIGDIGGER_OCCUPANCY_ROWS);
+
+  this->reset();
+}
+
+void
+Occupancy::fold(void)
+{
+  const float *__restrict__ acc = this->acc.data();
+  double *__restrict__ sums = this->sums.data();
+  size_t i;
+
+#pragma omp simd
+  for (i = 0; i < this->bins; ++i)
+    sums[i] += static_cast<double>(acc[i]);
+
+  std::fill(this->acc.begin(), this->acc.end(), 0);
+  this->pending = 0;
+}
+
+// Duty cycle of each column since the current row started
+void
+Occupancy::rowDuty(float *out) const
+{
+  const uint32_t *hits = this->hits.data();
+  const uint32_t *mark = this->mark.data();
+  quint64 frames = this->frames - this->markFrames;
+  size_t i, j, lo, hi;
+
+  for (j = 0; j < this->columns; ++j) {
+    uint64_t sum = 0;
+
+    lo = j * this->bins / this->columns;
+    hi = (j + 1) * this->bins / this->columns;
+
+    for (i = lo; i < hi; ++i)
+      sum += hits[i] - mark[i];
+
+    out[j] = frames > 0
+        ? static_cast<float>(
+            static_cast<double>(sum) / (frames * (hi - lo)))
+        : 0;
+  }
+}
+
+void
+Occupancy::mergeRows(void)
+{
+  unsigned int half = this->rows / 2;
+  unsigned int k, j;
+
+  for (k = 0; k < half; ++k) {
+    const float *a = &this->heatmap[2 * k * this->columns];
+    const float *b = &this->heatmap[(2 * k + 1) * this->columns];
+    float *out = &this->heatmap[k * this->columns];
+    quint64 fa = this->rowFrames[2 * k];
+    quint64 fb = this->rowFrames[2 * k + 1];
+    float wa = fa + fb > 0 ? static_cast<float>(fa) / (fa + fb) : .5f;
+
+    // out may alias a when k == 0, which is fine element by element
+    for (j = 0; j < this->columns; ++j)
+      out[j] = wa * a[j] + (1 - wa) * b[j];
+
+    this->rowFrames[k] = fa + fb;
+    this->rowTimes[k]  = this->rowTimes[2 * k];
+  }
+
+  this->rows  = half;
+  this->slot *= 2;
+}
+
+void
+Occupancy::closeRow(qint64 now)
+{
+  if (this->frames > this->markFrames) {
+    if (this->rows == SIGDIGGER_OCCUPANCY_ROWS)
+      this->mergeRows();
+
+    this->rowDuty(&this->heatmap[this->rows * this->columns]);
+    this->rowFrames[this->rows] = this->frames - this->markFrames;
+    this->rowTimes[this->rows]  = this->rowStart;
+    ++this->rows;
+
+    std::copy(this->hits.begin(), this->hits.end(), this->mark.begin());
+    this->markFrames = this->frames;
+  }
+
+  this->rowStart = now;
+}
+
+void
+Occupancy::feed(
+    const float *psd,
+    const float *floor,
+    size_t size,
+    qint64 fc,
+    unsigned int rate,
+    qint64 now)
+{
+  const float *__restrict__ in = psd;
+  const float *__restrict__ ref = floor;
+  uint32_t *__restrict__ hits;
+  float *__restrict__ acc;
+  float *__restrict__ max;
+  float threshold = this->threshold;
+  size_t i;
+
+  if (size == 0)
+    return;
+
+  // Statistics of a different span, or of bins of a different width,
+  // are meaningless together. The PSD is the full resolution one, so
+  // window and zoom changes do not get here.
+  if (size != this->bins || fc != this->fc || rate != this->rate) {
+    Restart reason = size != this->bins ? RESTART_FFT_SIZE : RESTART_RETUNED;
+    bool discarded = this->frames > 0;
+
+    this->fc   = fc;
+    this->rate = rate;
+    this->resize(size);
+
+    if (discarded) {
+      this->restart     = reason;
+      this->restartTime = now;
+    }
+  }
+
+  if (this->frames == 0) {
+    this->start    = now;
+    this->rowStart = now;
+  } else if (now - this->rowStart >= this->slot) {
+    this->closeRow(now);
+  }
+
+  hits = this->hits.data();
+  acc  = this->acc.data();
+  max  = this->max.data();
+
+  if (this->relative && ref != nullptr) {
+#pragma omp simd
+    for (i = 0; i < size; ++i) {
+      hits[i] += in[i] > ref[i] + threshold ? 1u : 0u;
+      max[i]   = in[i] > max[i] ? in[i] : max[i];
+      acc[i]  += powerFromLog2(SIGDIGGER_DB_TO_LOG2 * in[i]);
+    }
+  } else {
+#pragma omp simd
+    for (i = 0; i < size; ++i) {
+      hits[i] += in[i] > threshold ? 1u : 0u;
+      max[i]   = in[i] > max[i] ? in[i] : max[i];
+      acc[i]  += powerFromLog2(SIGDIGGER_DB_TO_LOG2 * in[i]);
+    }
+  }
+
+  ++this->frames;
+  this->last = now;
+
+  if (++this->pending == SIGDIGGER_OCCUPANCY_FOLD)
+    this->fold();
+}
+
+float
+Occupancy::getMeanDuty(void) const
+{
+  uint64_t sum = 0;
+
+  if (this->frames == 0)
+    return 0;
+
+  for (auto h : this->hits)
+    sum += h;
+
+  return static_cast<float>(
+        static_cast<double>(sum) / (this->frames * this->bins));
+}
+
+//
+// Meant to be called from the GUI thread between frames. The current
+// row, if it has any frames, is included as the last one.
+//
+void
+Occupancy::snapshot(OccupancySnapshot &snap) const
+{
+  float k = this->frames > 0 ? 1.f / this->frames : 0;
+  size_t i;
+
+  snap.fc        = this->fc;
+  snap.rate      = this->rate;
+  snap.threshold = this->threshold;
+  snap.relative  = this->relative;
+  snap.start     = this->start;
+  snap.end       = this->last;
+  snap.frames    = this->frames;
+
+  snap.duty.resize(this->bins);
+  snap.mean.resize(this->bins);
+  snap.max.resize(this->bins);
+
+  for (i = 0; i < this->bins; ++i) {
+    float power = static_cast<float>(
+          (this->sums[i] + static_cast<double>(this->acc[i])) * k);
+    snap.duty[i] = this->hits[i] * k;
+    snap.mean[i] = SIGDIGGER_LOG2_TO_DB * log2FromPower(power);
+  }
+
+  std::copy(this->max.begin(), this->max.end(), snap.max.begin());
+
+  snap.columns = this->columns;
+  snap.slot    = this->slot;
+  snap.rows    = this->rows;
+  if (this->frames > this->markFrames)
+    ++snap.rows;
+
+  snap.heatmap.resize(snap.rows * snap.columns);
+  snap.rowTimes.resize(snap.rows);
+
+  std::copy(
+        this->heatmap.begin(),
+        this->heatmap.begin() + this->rows * this->columns,
+        snap.heatmap.begin());
+  std::copy(
+        this->rowTimes.begin(),
+        this->rowTimes.begin() + this->rows,
+        snap.rowTimes.begin());
+
+  if (snap.rows > this->rows) {
+    this->rowDuty(&snap.heatmap[this->rows * this->columns]);
+    snap.rowTimes[this->rows] = this->rowStart;
+  }
+}
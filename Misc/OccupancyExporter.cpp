@@ -0,0 +1,177 @@
+//
+//    OccupancyExporter.cpp: Background export of occupancy statistics
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+
+#include "OccupancyExporter.h"
+#include <QDateTime>
+#include <QFile>
+#include <QImage>
+#include <QTextStream>
+#include <utility>
+
+using namespace SigDigger;
+
+OccupancyExporterWorker::OccupancyExporterWorker(OccupancyExporter *instance)
+{
+  this->instance = instance;
+}
+
+QString
+OccupancyExporterWorker::writeCsv(void)
+{
+  OccupancySnapshot const &snap = this->instance->snapshot;
+  QFile file(this->instance->path);
+  qreal binWidth;
+  qreal first;
+
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+    return file.errorString();
+
+  QTextStream out(&file);
+
+  binWidth = snap.duty.empty()
+      ? 0
+      : static_cast<qreal>(snap.rate) / snap.duty.size();
+  first = snap.fc - .5 * snap.duty.size() * binWidth;
+
+  out << "# from "
+      << QDateTime::fromMSecsSinceEpoch(snap.start).toString(Qt::ISODate)
+      << " to "
+      << QDateTime::fromMSecsSinceEpoch(snap.end).toString(Qt::ISODate)
+      << ", " << snap.frames << " frames, threshold "
+      << QString::number(static_cast<double>(snap.threshold), 'f', 1)
+      << (snap.relative ? " dB above noise floor" : " dB")
+      << "\n";
+  out << "frequency,duty,mean,max\n";
+
+  for (size_t i = 0; i < snap.duty.size(); ++i)
+    out << qRound64(first + i * binWidth) << ","
+        << QString::number(static_cast<double>(snap.duty[i]), 'f', 5) << ","
+        << QString::number(static_cast<double>(snap.mean[i]), 'f', 2) << ","
+        << QString::number(static_cast<double>(snap.max[i]), 'f', 2) << "\n";
+
+  out.flush();
+
+  return file.error() == QFile::NoError ? QString() : file.errorString();
+}
+
+QString
+OccupancyExporterWorker::writePng(void)
+{
+  OccupancySnapshot const &snap = this->instance->snapshot;
+  int rows = static_cast<int>(snap.rows);
+  int columns = static_cast<int>(snap.columns);
+
+  if (rows == 0 || columns == 0)
+    return "Nothing has been accumulated yet";
+
+  QImage image(columns, rows, QImage::Format_RGB32);
+
+  for (int i = 0; i < rows; ++i)
+    this->instance->palette.map(
+          &snap.heatmap[static_cast<size_t>(i * columns)],
+          reinterpret_cast<QRgb *>(image.scanLine(i)),
+          snap.columns,
+          0,
+          1);
+
+  image.setText("Frequency", QString::number(snap.fc));
+  image.setText("SampleRate", QString::number(snap.rate));
+  image.setText(
+        "Start",
+        QDateTime::fromMSecsSinceEpoch(snap.start).toString(Qt::ISODate));
+  image.setText("RowDuration", QString::number(snap.slot) + " ms");
+
+  if (!image.save(this->instance->path, "PNG"))
+    return "Cannot save image";
+
+  return QString();
+}
+
+void
+OccupancyExporterWorker::onExport(void)
+{
+  if (this->instance->format == OccupancyExporter::FORMAT_PNG)
+    emit finished(this->writePng());
+  else
+    emit finished(this->writeCsv());
+}
+
+OccupancyExporter::OccupancyExporter(QObject *parent) :
+  QObject(parent), workerObject(this)
+{
+  QObject::connect(
+        this,
+        SIGNAL(start()),
+        &this->workerObject,
+        SLOT(onExport()));
+
+  QObject::connect(
+        &this->workerObject,
+        SIGNAL(finished(QString)),
+        this,
+        SLOT(onFinished(QString)));
+
+  this->workerObject.moveToThread(&this->workerThread);
+  this->workerThread.start();
+}
+
+OccupancyExporter::~OccupancyExporter()
+{
+  this->workerThread.quit();
+  this->workerThread.wait();
+}
+
+//
+// The snapshot is only touched by the worker between start() and
+// finished(), both queued, so no lock is needed.
+//
+bool
+OccupancyExporter::exportTo(
+    OccupancySnapshot &snapshot,
+    Format format,
+    QString const &path,
+    Palette const &palette)
+{
+  if (this->busy)
+    return false;
+
+  std::swap(this->snapshot, snapshot);
+  this->format  = format;
+  this->path    = path;
+  this->palette = palette;
+  this->busy    = true;
+
+  emit start();
+
+  return true;
+}
+
+bool
+OccupancyExporter::isBusy(void) const
+{
+  return this->busy;
+}
+
+void
+OccupancyExporter::onFinished(QString error)
+{
+  this->busy = false;
+  emit finished(this->path, error);
+}
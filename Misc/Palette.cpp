@@ -19,12 +19,14 @@
 
 #include <Palette.h>
 #include <cstring>
+#include <algorithm>
 
 using namespace SigDigger;
 
 Palette::Palette()
 {
   memset(this->bitmap, 0, sizeof(this->bitmap));
+  memset(this->lut, 0, sizeof(this->lut));
   this->thumbnail = QImage(
         SIGDIGGER_PALETTE_THUMB_WIDTH,
         SIGDIGGER_PALETTE_THUMB_HEIGHT,
@@ -54,6 +56,7 @@ Palette::Palette(std::string const &name, qreal gradient[][3]) : Palette()
   this->name = name;
 
   this->updateThumbnail();
+  this->updateLut();
 }
 
 
@@ -75,6 +78,83 @@ Palette::updateThumbnail(void)
   }
 }
 
+//
+// Fine LUT entries fall between two stops of the gradient, and are mixed
+// the same way compose() fills the gap between two user stops.
+//
+void
+Palette::updateLut(void)
+{
+  unsigned int i, j;
+  qreal pos, alpha;
+  QColor c0, c1;
+
+  for (i = 0; i < SIGDIGGER_PALETTE_LUT_SIZE; ++i) {
+    pos = static_cast<qreal>(i * (SIGDIGGER_PALETTE_MAX_STOPS - 1))
+        / (SIGDIGGER_PALETTE_LUT_SIZE - 1);
+    j = static_cast<unsigned int>(pos);
+
+    if (j >= SIGDIGGER_PALETTE_MAX_STOPS - 1) {
+      this->lut[i] = this->gradient[SIGDIGGER_PALETTE_MAX_STOPS - 1].rgb();
+      continue;
+    }
+
+    alpha = pos - j;
+    c0 = this->gradient[j];
+    c1 = this->gradient[j + 1];
+
+    this->lut[i] = qRgb(
+          qRound(255 * sqrt(
+            alpha * c1.redF() * c1.redF()
+            + (1. - alpha) * c0.redF() * c0.redF())),
+          qRound(255 * sqrt(
+            alpha * c1.greenF() * c1.greenF()
+            + (1. - alpha) * c0.greenF() * c0.greenF())),
+          qRound(255 * sqrt(
+            alpha * c1.blueF() * c1.blueF()
+            + (1. - alpha) * c0.blueF() * c0.blueF())));
+  }
+}
+
+//
+// Indices are computed a block at a time so that the arithmetic and the
+// table lookups vectorize separately, even without gather instructions.
+//
+void
+Palette::map(
+    const float *__restrict__ db,
+    QRgb *__restrict__ pixels,
+    size_t size,
+    float min,
+    float max) const
+{
+  const QRgb *__restrict__ lut = this->lut;
+  const float top = SIGDIGGER_PALETTE_LUT_SIZE - 1;
+  int32_t index[SIGDIGGER_PALETTE_MAP_BLOCK];
+  size_t p, i, n;
+  float k;
+
+  if (max <= min)
+    max = min + 1;
+
+  k = top / (max - min);
+
+  for (p = 0; p < size; p += n) {
+    n = std::min<size_t>(size - p, SIGDIGGER_PALETTE_MAP_BLOCK);
+
+#pragma omp simd
+    for (i = 0; i < n; ++i) {
+      float x = (db[p + i] - min) * k + .5f;
+      x = x < 0.f ? 0.f : x;
+      x = x > top ? top : x;
+      index[i] = static_cast<int32_t>(x);
+    }
+
+    for (i = 0; i < n; ++i)
+      pixels[p + i] = lut[index[i]];
+  }
+}
+
 void
 Palette::compose(void)
 {
@@ -124,6 +204,7 @@ Palette::compose(void)
       this->gradient[j] = this->gradient[prev];
 
   this->updateThumbnail();
+  this->updateLut();
 }
 
 void
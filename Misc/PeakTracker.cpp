@@ -0,0 +1,193 @@
+//
+//    PeakTracker.cpp: Spectral peak tracker
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+#include "PeakTracker.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace SigDigger;
+
+PeakTracker::PeakTracker()
+{
+  this->setMaxPeaks(this->maxPeaks);
+}
+
+void
+PeakTracker::setMaxPeaks(unsigned int peaks)
+{
+  if (peaks < 1)
+    peaks = 1;
+  else if (peaks > SIGDIGGER_PEAK_TRACKER_MAX_PEAKS)
+    peaks = SIGDIGGER_PEAK_TRACKER_MAX_PEAKS;
+
+  this->maxPeaks = peaks;
+  this->tracks.assign(peaks, TrackedPeak());
+  this->candidates.clear();
+  this->candidates.reserve(2 * peaks);
+}
+
+void
+PeakTracker::setThreshold(float dB)
+{
+  this->threshold = dB;
+}
+
+void
+PeakTracker::setHysteresis(float dB)
+{
+  this->hysteresis = dB < 0 ? 0 : dB;
+}
+
+void
+PeakTracker::clear(void)
+{
+  for (auto &t : this->tracks)
+    t.active = false;
+}
+
+//
+// Local maxima above threshold - hysteresis. Only the 2 * maxPeaks strongest are kept,
+// in a min-heap, so the weakest one is replaced in O(log maxPeaks).
+//
+void
+PeakTracker::collect(const float *psd, const float *floor, size_t size)
+{
+  size_t capacity = 2 * this->maxPeaks;
+  float exit = this->threshold - this->hysteresis;
+  auto cmp = [] (Candidate const &a, Candidate const &b) {
+    return a.power > b.power;
+  };
+
+  this->candidates.clear();
+
+  for (size_t i = 1; i + 1 < size; ++i) {
+    float a = psd[i - 1];
+    float b = psd[i];
+    float c = psd[i + 1];
+    float den, delta;
+
+    if (b <= floor[i] + exit || b <= a || b < c)
+      continue;
+
+    if (this->candidates.size() == capacity) {
+      if (b <= this->candidates.front().power)
+        continue;
+
+      std::pop_heap(this->candidates.begin(), this->candidates.end(), cmp);
+      this->candidates.pop_back();
+    }
+
+    // Vertex of the parabola through the three bins
+    den   = a - 2 * b + c;
+    delta = den < 0 ? .5f * (a - c) / den : 0;
+
+    this->candidates.push_back(
+          Candidate {
+            static_cast<float>(i) + delta,
+            b - .25f * (a - c) * delta,
+            floor[i],
+            false});
+    std::push_heap(this->candidates.begin(), this->candidates.end(), cmp);
+  }
+
+  // Strongest first
+  std::sort_heap(this->candidates.begin(), this->candidates.end(), cmp);
+}
+
+void
+PeakTracker::feed(
+    const float *psd,
+    const float *floor,
+    size_t size,
+    qint64 fc,
+    unsigned int rate,
+    qint64 now)
+{
+  qreal binWidth;
+
+  if (size < 3 || rate == 0)
+    return;
+
+  binWidth = static_cast<qreal>(rate) / size;
+
+  this->collect(psd, floor, size);
+
+  // Existing tracks take the strongest candidate close to where they were
+  for (auto &t : this->tracks) {
+    Candidate *best = nullptr;
+    float pos;
+
+    if (!t.active)
+      continue;
+
+    pos = static_cast<float>((t.freq - fc) / binWidth + .5 * size);
+
+    for (auto &c : this->candidates)
+      if (!c.used
+          && std::fabs(c.bin - pos) <= SIGDIGGER_PEAK_TRACKER_MATCH_BINS
+          && (best == nullptr || c.power > best->power))
+        best = &c;
+
+    if (best != nullptr) {
+      best->used = true;
+      t.freq   = fc + (best->bin - .5 * size) * binWidth;
+      t.power  = best->power;
+      t.snr    = best->power - best->floor;
+      t.last   = now;
+      t.misses = 0;
+      if (t.power > t.maxPower)
+        t.maxPower = t.power;
+    } else if (++t.misses > SIGDIGGER_PEAK_TRACKER_HOLD) {
+      t.active = false;
+    }
+  }
+
+  // What is left starts new tracks, evicting weaker ones if needed
+  for (auto &c : this->candidates) {
+    TrackedPeak *slot = nullptr;
+
+    if (c.used || c.power < c.floor + this->threshold)
+      continue;
+
+    for (auto &t : this->tracks) {
+      if (!t.active) {
+        slot = &t;
+        break;
+      }
+
+      if (t.power < c.power && (slot == nullptr || t.power < slot->power))
+        slot = &t;
+    }
+
+    // Candidates are sorted, no weaker one will find room either
+    if (slot == nullptr)
+      break;
+
+    slot->id        = this->nextId++;
+    slot->active    = true;
+    slot->freq      = fc + (c.bin - .5 * size) * binWidth;
+    slot->firstFreq = slot->freq;
+    slot->power     = c.power;
+    slot->maxPower  = c.power;
+    slot->snr       = c.power - c.floor;
+    slot->start     = now;
+    slot->last      = now;
+    slot->misses    = 0;
+  }
+}
@@ -0,0 +1,153 @@
+//
+//    Persistence.cpp: Decaying (frequency, power) histogram
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+#include "Persistence.h"
+#include "PeakResample.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace SigDigger;
+
+void
+Persistence::resize(unsigned int width, unsigned int height)
+{
+  this->width  = width;
+  this->height = height;
+
+  this->cells.resize(static_cast<size_t>(width) * height);
+  this->column.resize(SIGDIGGER_PERSISTENCE_TILE);
+  this->rows.resize(SIGDIGGER_PERSISTENCE_TILE);
+  this->line.resize(width);
+
+  this->clear();
+}
+
+void
+Persistence::setRange(float min, float max)
+{
+  if (max <= min)
+    max = min + 1;
+
+  if (this->min != min || this->max != max) {
+    this->min = min;
+    this->max = max;
+    this->clear();
+  }
+}
+
+void
+Persistence::setDecay(float decay)
+{
+  // At 1, hits would never fade and densities would all be zero
+  this->decay = std::min(std::max(decay, 1e-3f), .9999f);
+}
+
+void
+Persistence::clear(void)
+{
+  std::fill(this->cells.begin(), this->cells.end(), 0.f);
+  this->gain = 1;
+}
+
+void
+Persistence::renormalize(void)
+{
+  float *__restrict__ cells = this->cells.data();
+  float k = 1.f / this->gain;
+  size_t i, size = this->cells.size();
+
+#pragma omp simd
+  for (i = 0; i < size; ++i)
+    cells[i] *= k;
+
+  this->gain = 1;
+}
+
+//
+// Columns are handled a tile at a time: their peaks and target rows are
+// computed into small buffers that stay in cache, and only then the hits
+// are added to the grid.
+//
+void
+Persistence::feed(const float *psd, size_t size)
+{
+  float *__restrict__ column = this->column.data();
+  int32_t *__restrict__ rows = this->rows.data();
+  float *cells = this->cells.data();
+  const float bottom = this->height - 1;
+  float k;
+  size_t x0, n, i;
+
+  if (this->width == 0 || this->height == 0 || size == 0)
+    return;
+
+  // Instead of fading every cell, make the new hits weigh more
+  this->gain /= this->decay;
+
+  if (this->gain > SIGDIGGER_PERSISTENCE_MAX_GAIN)
+    this->renormalize();
+
+  k = bottom / (this->max - this->min);
+
+  for (x0 = 0; x0 < this->width; x0 += n) {
+    n = std::min<size_t>(this->width - x0, SIGDIGGER_PERSISTENCE_TILE);
+
+    peakResample(psd, size, column, this->width, x0, n);
+
+#pragma omp simd
+    for (i = 0; i < n; ++i) {
+      float y = (this->max - column[i]) * k + .5f;
+      y = y < 0.f ? 0.f : y;
+      y = y > bottom ? bottom : y;
+      rows[i] = static_cast<int32_t>(y);
+    }
+
+    for (i = 0; i < n; ++i)
+      cells[static_cast<size_t>(rows[i]) * this->width + x0 + i] += this->gain;
+  }
+}
+
+//
+// In steady state, a cell hit on every update holds gain / (1 - decay).
+// Densities are shown in a log scale, with a bit-level approximation of
+// log2 that is plenty for picking a color.
+//
+void
+Persistence::render(unsigned int y, QRgb *pixels, Palette const &palette)
+{
+  const float *__restrict__ cells =
+      this->cells.data() + static_cast<size_t>(y) * this->width;
+  float *__restrict__ line = this->line.data();
+  float k = (1.f - this->decay) / this->gain;
+  size_t x;
+
+  if (y >= this->height)
+    return;
+
+#pragma omp simd
+  for (x = 0; x < this->width; ++x) {
+    float density = cells[x] * k;
+    int32_t bits;
+
+    memcpy(&bits, &density, sizeof(float));
+    line[x] = bits * (1.f / (1 << 23)) - 127.f;
+  }
+
+  palette.map(line, pixels, this->width, -SIGDIGGER_PERSISTENCE_RANGE_LOG2, 0);
+}
@@ -0,0 +1,293 @@
+//
+//    ReferenceTrace.cpp: Reference spectrum and live difference
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+#include "ReferenceTrace.h"
+#include "PowerMath.h"
+#include <QFile>
+#include <QtEndian>
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+using namespace SigDigger;
+
+ReferenceTrace::ReferenceTrace()
+{
+  memset(&this->header, 0, sizeof(ReferenceTraceHeader));
+}
+
+void
+ReferenceTrace::startCapture(qint64 ms, qint64 now)
+{
+  this->capturing     = true;
+  this->captureStart  = now;
+  this->captureLength = ms;
+  this->count         = 0;
+}
+
+void
+ReferenceTrace::cancelCapture(void)
+{
+  this->capturing = false;
+}
+
+qreal
+ReferenceTrace::getCaptureProgress(qint64 now) const
+{
+  if (!this->capturing || this->captureLength <= 0)
+    return 0;
+
+  return std::min(
+        static_cast<qreal>(now - this->captureStart) / this->captureLength,
+        1.);
+}
+
+bool
+ReferenceTrace::feed(
+    const float *psd,
+    size_t size,
+    int64_t fc,
+    unsigned int rate,
+    qint64 now)
+{
+  float *__restrict__ acc;
+
+  if (!this->capturing || size == 0)
+    return false;
+
+  // Different bins: what was accumulated is of no use
+  if (this->count > 0
+      && (size != this->acc.size()
+          || fc != this->captureFc
+          || rate != this->captureRate)) {
+    this->count = 0;
+    this->captureStart = now;
+  }
+
+  if (this->count == 0) {
+    this->acc.assign(size, 0);
+    this->captureFc   = fc;
+    this->captureRate = rate;
+  }
+
+  acc = this->acc.data();
+
+#pragma omp simd
+  for (size_t i = 0; i < size; ++i)
+    acc[i] += powerFromLog2(SIGDIGGER_DB_TO_LOG2 * psd[i]);
+
+  ++this->count;
+
+  if (now - this->captureStart < this->captureLength)
+    return false;
+
+  this->finishCapture(now);
+
+  return true;
+}
+
+void
+ReferenceTrace::finishCapture(qint64 now)
+{
+  const float *__restrict__ acc = this->acc.data();
+  float *__restrict__ level;
+  float scale = 1.f / this->count;
+  size_t size = this->acc.size();
+
+  this->level.resize(size);
+  level = this->level.data();
+
+#pragma omp simd
+  for (size_t i = 0; i < size; ++i)
+    level[i] = SIGDIGGER_LOG2_TO_DB * log2FromPower(scale * acc[i]);
+
+  this->header.magic     = SIGDIGGER_REFERENCE_TRACE_MAGIC;
+  this->header.version   = SIGDIGGER_REFERENCE_TRACE_VERSION;
+  this->header.timestamp = now;
+  this->header.fc        = this->captureFc;
+  this->header.rate      = this->captureRate;
+  this->header.width     = static_cast<uint32_t>(size);
+  this->header.frames    = this->count;
+  this->header.duration  = static_cast<uint32_t>(now - this->captureStart);
+
+  this->capturing = false;
+  this->dirty     = true;
+}
+
+//
+// Linear interpolation between reference bins. Live bins are placed at
+// fc - rate / 2 + i * rate / size, and the same goes for the reference.
+//
+void
+ReferenceTrace::align(size_t size, int64_t fc, unsigned int rate)
+{
+  const float *level = this->level.data();
+  qreal refStart, refStep, start, step;
+  size_t width = this->level.size();
+
+  this->aligned.resize(size);
+  this->alignedSize = size;
+  this->alignedFc   = fc;
+  this->alignedRate = rate;
+  this->dirty       = false;
+  this->first       = size;
+  this->last        = 0;
+
+  if (width == 0 || this->header.rate == 0 || rate == 0)
+    return;
+
+  refStep  = static_cast<qreal>(this->header.rate) / width;
+  refStart = this->header.fc - .5 * this->header.rate;
+  step     = static_cast<qreal>(rate) / size;
+  start    = fc - .5 * rate;
+
+  for (size_t i = 0; i < size; ++i) {
+    qreal j = (start + i * step - refStart) / refStep;
+    size_t k;
+    qreal t;
+
+    if (j < 0 || j > width - 1)
+      continue;
+
+    k = std::min(static_cast<size_t>(j), width - 1);
+    t = j - k;
+
+    this->aligned[i] = k + 1 < width
+        ? static_cast<float>((1 - t) * level[k] + t * level[k + 1])
+        : level[k];
+
+    this->first = std::min(this->first, i);
+    this->last  = i + 1;
+  }
+
+  if (this->first > this->last)
+    this->first = this->last = 0;
+}
+
+float *
+ReferenceTrace::diff(
+    const float *psd,
+    size_t size,
+    int64_t fc,
+    unsigned int rate)
+{
+  const float *__restrict__ ref;
+  float *__restrict__ out;
+  float threshold = this->threshold;
+  size_t deviating = 0;
+
+  if (this->dirty
+      || size != this->alignedSize
+      || fc != this->alignedFc
+      || rate != this->alignedRate)
+    this->align(size, fc, rate);
+
+  if (this->delta.size() < size)
+    this->delta.resize(size);
+
+  ref = this->aligned.data();
+  out = this->delta.data();
+
+  std::fill(out, out + this->first, 0.f);
+  std::fill(out + this->last, out + size, 0.f);
+
+#pragma omp simd reduction(+:deviating)
+  for (size_t i = this->first; i < this->last; ++i) {
+    float d = psd[i] - ref[i];
+
+    out[i] = d;
+    deviating += (d > threshold) + (d < -threshold);
+  }
+
+  this->deviating = deviating;
+
+  return out;
+}
+
+void
+ReferenceTrace::clear(void)
+{
+  this->level.clear();
+  memset(&this->header, 0, sizeof(ReferenceTraceHeader));
+  this->dirty = true;
+}
+
+QString
+ReferenceTrace::save(QString const &path) const
+{
+  QFile file(path);
+  qint64 len = static_cast<qint64>(this->level.size() * sizeof(float));
+
+  if (!this->isValid())
+    return "No reference to save";
+
+  if (!file.open(QIODevice::WriteOnly))
+    return file.errorString();
+
+  if (file.write(
+        reinterpret_cast<const char *>(&this->header),
+        sizeof(ReferenceTraceHeader))
+      != static_cast<qint64>(sizeof(ReferenceTraceHeader))
+      || file.write(
+        reinterpret_cast<const char *>(this->level.data()),
+        len) != len)
+    return file.errorString();
+
+  return QString();
+}
+
+QString
+ReferenceTrace::load(QString const &path)
+{
+  QFile file(path);
+  ReferenceTraceHeader header;
+  std::vector<float> level;
+  qint64 len;
+
+  if (!file.open(QIODevice::ReadOnly))
+    return file.errorString();
+
+  if (file.read(reinterpret_cast<char *>(&header), sizeof(header))
+      != static_cast<qint64>(sizeof(header)))
+    return "File too short";
+
+  if (header.magic != SIGDIGGER_REFERENCE_TRACE_MAGIC) {
+    if (header.magic == qbswap<uint32_t>(SIGDIGGER_REFERENCE_TRACE_MAGIC))
+      return "Reference saved on a machine of different endianness";
+    return "Not a reference trace";
+  }
+
+  if (header.version != SIGDIGGER_REFERENCE_TRACE_VERSION)
+    return "Unsupported version " + QString::number(header.version);
+
+  if (header.width == 0 || header.rate == 0)
+    return "Empty reference";
+
+  level.resize(header.width);
+  len = static_cast<qint64>(header.width * sizeof(float));
+
+  if (file.read(reinterpret_cast<char *>(level.data()), len) != len)
+    return "File too short";
+
+  this->header = header;
+  this->level  = std::move(level);
+  this->dirty  = true;
+
+  return QString();
+}
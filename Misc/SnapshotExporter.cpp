@@ -0,0 +1,326 @@
+//
+//    SnapshotExporter.cpp: Background export of spectrum snapshots
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+#include "SnapshotExporter.h"
+#include "PeakResample.h"
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPainter>
+#include <QSysInfo>
+#include <QVector>
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+using namespace SigDigger;
+
+SnapshotExporterWorker::SnapshotExporterWorker(SnapshotExporter *instance)
+{
+  this->instance = instance;
+}
+
+//
+// Newest row first, both in the matrix and in the image. Rows are
+// converted and written one at a time, so memory does not grow with the
+// number of rows.
+//
+QString
+SnapshotExporterWorker::writeWaterfall(QString const &base, QImage &image)
+{
+  SpectrumSnapshot const &snap = this->instance->snapshot;
+  WaterfallHistorySnapshot *waterfall = snap.waterfall.get();
+  QFile file(base + ".f32");
+  std::vector<float> line(waterfall->getWidth());
+  qint64 len = static_cast<qint64>(line.size() * sizeof(float));
+  int y = SIGDIGGER_SNAPSHOT_PSD_HEIGHT;
+
+  if (!file.open(QIODevice::WriteOnly))
+    return file.errorString();
+
+  for (uint64_t seq = waterfall->getEnd(); seq-- > waterfall->getBegin(); ) {
+    WaterfallHistoryRow info;
+
+    if (!waterfall->read(seq, line.data(), info))
+      continue;
+
+    if (file.write(reinterpret_cast<const char *>(line.data()), len) != len)
+      return file.errorString();
+
+    this->instance->palette.map(
+          line.data(),
+          reinterpret_cast<QRgb *>(image.scanLine(y++)),
+          line.size(),
+          snap.wfMin,
+          snap.wfMax);
+
+    this->rows.push_back(info);
+  }
+
+  return QString();
+}
+
+QString
+SnapshotExporterWorker::writePsd(QString const &base)
+{
+  SpectrumSnapshot const &snap = this->instance->snapshot;
+  QFile file(base + ".psd.f32");
+  qint64 len = static_cast<qint64>(snap.psd.size() * sizeof(float));
+
+  if (!file.open(QIODevice::WriteOnly))
+    return file.errorString();
+
+  if (file.write(reinterpret_cast<const char *>(snap.psd.data()), len) != len)
+    return file.errorString();
+
+  return QString();
+}
+
+// Peak of the bins under every pixel column, over a 10 dB grid
+void
+SnapshotExporterWorker::drawPsd(QImage &image)
+{
+  SpectrumSnapshot const &snap = this->instance->snapshot;
+  QPainter painter(&image);
+  QVector<QPointF> trace;
+  std::vector<float> peaks;
+  int width = image.width();
+  int size = static_cast<int>(snap.psd.size());
+  qreal height = SIGDIGGER_SNAPSHOT_PSD_HEIGHT - 1;
+  qreal scale = height / static_cast<qreal>(snap.psdMax - snap.psdMin);
+
+  painter.fillRect(0, 0, width, SIGDIGGER_SNAPSHOT_PSD_HEIGHT, Qt::black);
+
+  if (size == 0 || snap.psdMax <= snap.psdMin)
+    return;
+
+  painter.setPen(QColor(64, 64, 64));
+  for (
+       float db = std::ceil(snap.psdMin / 10) * 10;
+       db <= snap.psdMax;
+       db += 10) {
+    qreal y = (snap.psdMax - db) * scale;
+    painter.drawLine(QPointF(0, y), QPointF(width, y));
+  }
+
+  peaks.resize(static_cast<size_t>(width));
+  peakResample(
+        snap.psd.data(),
+        snap.psd.size(),
+        peaks.data(),
+        peaks.size());
+
+  trace.resize(width);
+  for (int x = 0; x < width; ++x)
+    trace[x] = QPointF(
+          x,
+          std::min(std::max((snap.psdMax - peaks[x]) * scale, 0.), height));
+
+  painter.setPen(QColor(0xb7, 0xe8, 0x69));
+  painter.drawPolyline(trace.data(), trace.size());
+}
+
+//
+// Bin i of a row of `columns' bins is centered at
+// centerFrequency - sampleRate / 2 + (i + .5) * sampleRate / columns.
+//
+QString
+SnapshotExporterWorker::writeMetadata(QString const &base)
+{
+  SpectrumSnapshot const &snap = this->instance->snapshot;
+  QFile file(base + ".json");
+  QJsonObject root, psd, image;
+  QJsonArray rows;
+
+  root["byteOrder"] =
+      QSysInfo::ByteOrder == QSysInfo::LittleEndian ? "little" : "big";
+  root["units"] = "dB";
+
+  psd["file"]            = QFileInfo(base + ".psd.f32").fileName();
+  psd["columns"]         = static_cast<int>(snap.psd.size());
+  psd["centerFrequency"] = static_cast<qint64>(snap.fc);
+  psd["sampleRate"]      = static_cast<qint64>(snap.rate);
+  psd["timestamp"]       = static_cast<qint64>(snap.timestamp);
+  psd["time"]            = QDateTime::fromMSecsSinceEpoch(
+        snap.timestamp / 1000).toString(Qt::ISODateWithMs);
+  root["psd"] = psd;
+
+  if (snap.waterfall != nullptr) {
+    QJsonObject waterfall;
+
+    for (auto const &r : this->rows) {
+      QJsonObject row;
+
+      row["timestamp"]       = static_cast<qint64>(r.timestamp);
+      row["centerFrequency"] = static_cast<qint64>(r.fc);
+      row["sampleRate"]      = static_cast<qint64>(r.rate);
+      rows.append(row);
+    }
+
+    waterfall["file"]    = QFileInfo(base + ".f32").fileName();
+    waterfall["columns"] = static_cast<int>(snap.waterfall->getWidth());
+    waterfall["order"]   = "newest first";
+    waterfall["rows"]    = rows;
+    root["waterfall"] = waterfall;
+  }
+
+  image["file"]          = QFileInfo(base + ".png").fileName();
+  image["psdHeight"]     = SIGDIGGER_SNAPSHOT_PSD_HEIGHT;
+  image["psdMin"]        = static_cast<double>(snap.psdMin);
+  image["psdMax"]        = static_cast<double>(snap.psdMax);
+  image["waterfallMin"]  = static_cast<double>(snap.wfMin);
+  image["waterfallMax"]  = static_cast<double>(snap.wfMax);
+  root["image"] = image;
+
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+    return file.errorString();
+
+  if (file.write(QJsonDocument(root).toJson()) < 0)
+    return file.errorString();
+
+  return QString();
+}
+
+void
+SnapshotExporterWorker::onExport(void)
+{
+  SpectrumSnapshot const &snap = this->instance->snapshot;
+  QString path = this->instance->path;
+  QString base = path;
+  QString error;
+  QImage image;
+  int width, height;
+
+  if (base.endsWith(".png", Qt::CaseInsensitive))
+    base.chop(4);
+
+  this->rows.clear();
+
+  width  = static_cast<int>(
+        snap.waterfall != nullptr
+        ? snap.waterfall->getWidth()
+        : snap.psd.size());
+  height = SIGDIGGER_SNAPSHOT_PSD_HEIGHT + static_cast<int>(
+        snap.waterfall != nullptr
+        ? snap.waterfall->getEnd() - snap.waterfall->getBegin()
+        : 0);
+
+  if (width == 0) {
+    emit finished("Nothing to export");
+    return;
+  }
+
+  image = QImage(width, height, QImage::Format_RGB32);
+  if (image.isNull()) {
+    emit finished("Image too large");
+    return;
+  }
+
+  if (snap.waterfall != nullptr)
+    error = this->writeWaterfall(base, image);
+
+  if (error.isEmpty())
+    error = this->writePsd(base);
+
+  if (error.isEmpty())
+    error = this->writeMetadata(base);
+
+  if (error.isEmpty()) {
+    // Rows that were no longer there
+    image = image.copy(
+          0,
+          0,
+          width,
+          SIGDIGGER_SNAPSHOT_PSD_HEIGHT + static_cast<int>(this->rows.size()));
+    this->drawPsd(image);
+
+    if (!image.save(base + ".png", "PNG"))
+      error = "Cannot write " + base + ".png";
+  }
+
+  emit finished(error);
+}
+
+SnapshotExporter::SnapshotExporter(QObject *parent) :
+  QObject(parent), workerObject(this)
+{
+  QObject::connect(
+        this,
+        SIGNAL(start()),
+        &this->workerObject,
+        SLOT(onExport()));
+
+  QObject::connect(
+        &this->workerObject,
+        SIGNAL(finished(QString)),
+        this,
+        SLOT(onFinished(QString)));
+
+  this->workerObject.moveToThread(&this->workerThread);
+  this->workerThread.start();
+}
+
+SnapshotExporter::~SnapshotExporter()
+{
+  this->workerThread.quit();
+  this->workerThread.wait();
+}
+
+//
+// The snapshot is only touched by the worker between start() and
+// finished(), both queued. The waterfall rows it reads are protected by
+// the history snapshot itself.
+//
+bool
+SnapshotExporter::exportTo(
+    SpectrumSnapshot &snapshot,
+    QString const &path,
+    Palette const &palette)
+{
+  if (this->busy)
+    return false;
+
+  std::swap(this->snapshot, snapshot);
+  this->path    = path;
+  this->palette = palette;
+  this->busy    = true;
+
+  emit start();
+
+  return true;
+}
+
+bool
+SnapshotExporter::isBusy(void) const
+{
+  return this->busy;
+}
+
+// The history snapshot must go away in the thread that feeds the history
+void
+SnapshotExporter::onFinished(QString error)
+{
+  this->snapshot.waterfall = nullptr;
+  this->snapshot.psd.clear();
+  this->busy = false;
+  emit finished(this->path, error);
+}
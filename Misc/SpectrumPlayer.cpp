@@ -0,0 +1,212 @@
+//
+//    SpectrumPlayer.cpp: PSD log replay
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+#include "SpectrumPlayer.h"
+#include <cerrno>
+#include <cstring>
+
+using namespace SigDigger;
+
+SpectrumLogReader::~SpectrumLogReader()
+{
+  this->close();
+}
+
+void
+SpectrumLogReader::close(void)
+{
+  if (this->fp != nullptr) {
+    fclose(this->fp);
+    this->fp = nullptr;
+  }
+}
+
+bool
+SpectrumLogReader::open(std::string const &path)
+{
+  this->close();
+
+  if ((this->fp = fopen(path.c_str(), "rb")) == nullptr) {
+    this->lastError = "Cannot open " + path + ": " + strerror(errno);
+    return false;
+  }
+
+  if (fread(&this->header, sizeof(this->header), 1, this->fp) != 1
+      || this->header.magic != SIGDIGGER_SPECTRUM_LOG_MAGIC
+      || this->header.version != SIGDIGGER_SPECTRUM_LOG_VERSION
+      || (this->header.bits != 8 && this->header.bits != 16)) {
+    this->lastError = path + " is not a spectrum log";
+    this->close();
+    return false;
+  }
+
+  return true;
+}
+
+// A truncated last row (recording interrupted) ends the file
+bool
+SpectrumLogReader::read(SpectrumLogRow &row, std::vector<float> &data)
+{
+  float min = this->header.dbMin;
+  float step;
+  size_t bytes;
+
+  if (this->fp == nullptr)
+    return false;
+
+  if (fread(&row, sizeof(row), 1, this->fp) != 1 || row.width == 0)
+    return false;
+
+  bytes = static_cast<size_t>(row.width) * this->header.bits / 8;
+  this->raw.resize(bytes);
+  if (fread(this->raw.data(), 1, bytes, this->fp) != bytes)
+    return false;
+
+  data.resize(row.width);
+
+  if (this->header.bits == 8) {
+    const uint8_t *__restrict__ in = this->raw.data();
+    float *__restrict__ out = data.data();
+
+    step = (this->header.dbMax - min) / 255.f;
+
+#pragma omp simd
+    for (uint32_t i = 0; i < row.width; ++i)
+      out[i] = min + step * in[i];
+  } else {
+    const uint16_t *__restrict__ in =
+        reinterpret_cast<const uint16_t *>(this->raw.data());
+    float *__restrict__ out = data.data();
+
+    step = (this->header.dbMax - min) / 65535.f;
+
+#pragma omp simd
+    for (uint32_t i = 0; i < row.width; ++i)
+      out[i] = min + step * in[i];
+  }
+
+  return true;
+}
+
+SpectrumPlayer::SpectrumPlayer(QObject *parent) : QObject(parent)
+{
+  this->timer = new QTimer(this);
+  this->timer->setInterval(SIGDIGGER_SPECTRUM_PLAYER_INTERVAL_MS);
+
+  connect(
+        this->timer,
+        SIGNAL(timeout(void)),
+        this,
+        SLOT(onTimeout(void)));
+}
+
+bool
+SpectrumPlayer::open(QString const &path)
+{
+  this->stop();
+
+  if (!this->reader.open(path.toStdString())) {
+    this->lastError = QString::fromStdString(this->reader.getError());
+    return false;
+  }
+
+  this->pending = false;
+  this->timer->start();
+
+  return true;
+}
+
+void
+SpectrumPlayer::setSpeed(unsigned int rows)
+{
+  this->speed = rows > 0 ? rows : 1;
+}
+
+void
+SpectrumPlayer::stop(void)
+{
+  this->timer->stop();
+  this->reader.close();
+}
+
+bool
+SpectrumPlayer::isPlaying(void) const
+{
+  return this->timer->isActive();
+}
+
+QString
+SpectrumPlayer::getLastError(void) const
+{
+  return this->lastError;
+}
+
+void
+SpectrumPlayer::onTimeout(void)
+{
+  SpectrumLogRow first, row;
+  unsigned int count;
+
+  // Row read ahead in the previous tick, which did not fit in its frame
+  if (this->pending) {
+    first = this->next;
+    this->pending = false;
+  } else if (!this->reader.read(first, this->merged)) {
+    this->stop();
+    emit finished();
+    return;
+  }
+
+  for (count = 1; count < this->speed; ++count) {
+    float *__restrict__ merged;
+    const float *__restrict__ data;
+
+    if (!this->reader.read(row, this->data))
+      break;
+
+    if (row.fc != first.fc
+        || row.rate != first.rate
+        || row.width != first.width) {
+      // Starts the next frame
+      this->next = row;
+      this->pending = true;
+      break;
+    }
+
+    merged = this->merged.data();
+    data = this->data.data();
+
+#pragma omp simd
+    for (uint32_t i = 0; i < row.width; ++i)
+      merged[i] = data[i] > merged[i] ? data[i] : merged[i];
+
+    first.timestamp = row.timestamp;
+  }
+
+  emit frame(
+        this->merged.data(),
+        static_cast<int>(this->merged.size()),
+        first.fc,
+        first.rate,
+        first.timestamp / 1000);
+
+  // The read-ahead row is the start of the next frame
+  if (this->pending)
+    this->merged.swap(this->data);
+}
@@ -0,0 +1,318 @@
+//
+//    SpectrumRecorder.cpp: Compact long-term PSD log
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+#include "SpectrumRecorder.h"
+#include "PeakResample.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+
+using namespace SigDigger;
+
+SpectrumRecorderWorker::SpectrumRecorderWorker(SpectrumRecorder *instance)
+{
+  this->instance = instance;
+}
+
+void
+SpectrumRecorderWorker::onCommit(void)
+{
+  QMutexLocker locker(&this->instance->dataMutex);
+  const uint8_t *data =
+      this->instance->buffers[1 - this->instance->buffer].data();
+  size_t len = this->instance->committedSize;
+
+  locker.unlock();
+
+  if (this->failed)
+    return;
+
+  if (!this->instance->writeAll(data, len)) {
+    this->failed = true;
+    emit error("write() failed: " + QString(strerror(errno)));
+    return;
+  }
+
+  this->instance->bufferReady = true;
+
+  emit writeFinished(len);
+}
+
+SpectrumRecorder::SpectrumRecorder(
+    int fd,
+    unsigned int bits,
+    QObject *parent) : QObject(parent), workerObject(this)
+{
+  SpectrumLogHeader header;
+
+  this->fd = fd;
+  this->bits = bits == 16 ? 16 : 8;
+  this->bufferReady = true;
+
+  this->buffers[0].resize(SIGDIGGER_SPECTRUM_LOG_BUFFER);
+  this->buffers[1].resize(SIGDIGGER_SPECTRUM_LOG_BUFFER);
+
+  header.magic    = SIGDIGGER_SPECTRUM_LOG_MAGIC;
+  header.version  = SIGDIGGER_SPECTRUM_LOG_VERSION;
+  header.bits     = this->bits;
+  header.reserved = 0;
+  header.dbMin    = SIGDIGGER_SPECTRUM_LOG_DB_MIN;
+  header.dbMax    = SIGDIGGER_SPECTRUM_LOG_DB_MAX;
+
+  memcpy(this->buffers[0].data(), &header, sizeof(header));
+  this->ptr = sizeof(header);
+
+  QObject::connect(
+        this,
+        SIGNAL(commit()),
+        &this->workerObject,
+        SLOT(onCommit()));
+
+  QObject::connect(
+        &this->workerObject,
+        SIGNAL(error(QString)),
+        this,
+        SLOT(onError(QString)));
+
+  // Worker object will run somewhere else
+  this->workerObject.moveToThread(&this->workerThread);
+  this->workerThread.start();
+}
+
+SpectrumRecorder::~SpectrumRecorder()
+{
+  this->workerThread.quit();
+  this->workerThread.wait();
+
+  // A commit still queued when the thread stopped was never written
+  if (!this->failed) {
+    if (!this->bufferReady)
+      this->writeAll(
+            this->buffers[1 - this->buffer].data(),
+            this->committedSize);
+    this->writeAll(this->buffers[this->buffer].data(), this->ptr);
+  }
+
+  if (this->fd != -1)
+    ::close(this->fd);
+}
+
+bool
+SpectrumRecorder::writeAll(const uint8_t *data, size_t len)
+{
+  ssize_t result;
+
+  while (len > 0) {
+    result = ::write(this->fd, data, len);
+
+    if (result < 1)
+      return false;
+
+    data += result;
+    len  -= static_cast<size_t>(result);
+  }
+
+  return true;
+}
+
+void
+SpectrumRecorder::setMode(Mode mode)
+{
+  this->mode = mode;
+  this->frames = 0;
+}
+
+void
+SpectrumRecorder::setInterval(unsigned int frames)
+{
+  this->interval = std::max(frames, 1u);
+  this->frames = 0;
+}
+
+void
+SpectrumRecorder::setMaxWidth(unsigned int width)
+{
+  this->maxWidth = width;
+  this->frames = 0;
+}
+
+// Protected by mutex
+void
+SpectrumRecorder::doCommit(int64_t now)
+{
+  // If the writer is still busy, keep filling the current buffer
+  if (this->bufferReady && this->ptr > 0) {
+    this->buffer = 1 - this->buffer;
+    this->committedSize = this->ptr;
+    this->size += this->committedSize;
+    this->ptr = 0;
+    this->lastCommit = now;
+    this->bufferReady = false;
+
+    emit commit();
+  }
+}
+
+void
+SpectrumRecorder::append(int64_t timestamp)
+{
+  QMutexLocker locker(&this->dataMutex);
+  size_t width = this->row.size();
+  size_t rowSize = sizeof(SpectrumLogRow) + width * this->bits / 8;
+  float min = SIGDIGGER_SPECTRUM_LOG_DB_MIN;
+  float top = this->bits == 16 ? 65535.f : 255.f;
+  float k = top / (SIGDIGGER_SPECTRUM_LOG_DB_MAX - SIGDIGGER_SPECTRUM_LOG_DB_MIN);
+  const float *__restrict__ in = this->row.data();
+  SpectrumLogRow header;
+  uint8_t *out;
+
+  if (this->ptr + rowSize > this->buffers[this->buffer].size()) {
+    this->doCommit(timestamp);
+
+    if (this->ptr + rowSize > this->buffers[this->buffer].size()) {
+      emit swamped();
+      return;
+    }
+  }
+
+  header.timestamp = timestamp;
+  header.fc        = this->fc;
+  header.rate      = this->rate;
+  header.width     = static_cast<uint32_t>(width);
+
+  out = this->buffers[this->buffer].data() + this->ptr;
+  memcpy(out, &header, sizeof(header));
+  out += sizeof(header);
+
+  if (this->bits == 8) {
+    uint8_t *__restrict__ q8 = out;
+
+#pragma omp simd
+    for (size_t i = 0; i < width; ++i) {
+      float q = (in[i] - min) * k + .5f;
+      q = q < 0.f ? 0.f : q;
+      q = q > top ? top : q;
+      q8[i] = static_cast<uint8_t>(q);
+    }
+  } else {
+    uint16_t *__restrict__ q16;
+
+    this->quantized.resize(width);
+    q16 = this->quantized.data();
+
+#pragma omp simd
+    for (size_t i = 0; i < width; ++i) {
+      float q = (in[i] - min) * k + .5f;
+      q = q < 0.f ? 0.f : q;
+      q = q > top ? top : q;
+      q16[i] = static_cast<uint16_t>(q);
+    }
+
+    // Rows are not aligned in the buffer
+    memcpy(out, q16, width * sizeof(uint16_t));
+  }
+
+  this->ptr += rowSize;
+  ++this->rows;
+
+  if (this->ptr > this->buffers[this->buffer].size() / 2
+      || timestamp - this->lastCommit >= SIGDIGGER_SPECTRUM_LOG_FLUSH_MS * 1000)
+    this->doCommit(timestamp);
+}
+
+void
+SpectrumRecorder::feed(
+    const float *psd,
+    size_t size,
+    int64_t fc,
+    unsigned int rate,
+    int64_t timestamp)
+{
+  size_t width;
+
+  if (size == 0 || this->failed)
+    return;
+
+  width = this->maxWidth > 0 && size > this->maxWidth ? this->maxWidth : size;
+
+  // Retuning or resizing the FFT starts a new row
+  if (this->frames > 0
+      && (fc != this->fc || rate != this->rate || width != this->row.size()))
+    this->frames = 0;
+
+  this->fc   = fc;
+  this->rate = rate;
+
+  if (this->frames++ == 0) {
+    this->row.resize(width);
+    if (this->mode == MODE_MAX)
+      peakResample(psd, size, this->row.data(), width);
+  } else if (this->mode == MODE_MAX) {
+    float *__restrict__ row;
+    const float *__restrict__ line;
+
+    this->line.resize(width);
+    peakResample(psd, size, this->line.data(), width);
+
+    row  = this->row.data();
+    line = this->line.data();
+
+#pragma omp simd
+    for (size_t i = 0; i < width; ++i)
+      row[i] = line[i] > row[i] ? line[i] : row[i];
+  }
+
+  if (this->frames < this->interval)
+    return;
+
+  if (this->mode == MODE_DECIMATE)
+    peakResample(psd, size, this->row.data(), width);
+
+  this->append(timestamp);
+  this->frames = 0;
+}
+
+quint64
+SpectrumRecorder::getSize(void) const
+{
+  return this->size;
+}
+
+quint64
+SpectrumRecorder::getRows(void) const
+{
+  return this->rows;
+}
+
+QString
+SpectrumRecorder::getLastError(void) const
+{
+  return this->lastError;
+}
+
+////////////////////////////////////// Slots //////////////////////////////////
+void
+SpectrumRecorder::onError(QString error)
+{
+  this->lastError = error;
+  this->failed = true;
+
+  emit stopped();
+}
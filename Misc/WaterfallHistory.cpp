@@ -0,0 +1,458 @@
+//
+//    WaterfallHistory.cpp: Disk-backed waterfall history
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+#include "WaterfallHistory.h"
+#include "PeakResample.h"
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace SigDigger;
+
+///////////////////////////////// Snapshots ////////////////////////////////////
+WaterfallHistorySnapshot::WaterfallHistorySnapshot(
+    WaterfallHistory *history,
+    uint64_t begin,
+    uint64_t end)
+{
+  this->history = history;
+  this->begin   = begin;
+  this->end     = end;
+  this->width   = history->getWidth();
+  this->dbMin   = history->getDbMin();
+  this->dbMax   = history->getDbMax();
+}
+
+WaterfallHistorySnapshot::~WaterfallHistorySnapshot()
+{
+  std::vector<WaterfallHistorySnapshot *> *list;
+
+  if (this->history != nullptr) {
+    list = &this->history->snapshots;
+    list->erase(std::remove(list->begin(), list->end(), this), list->end());
+  }
+}
+
+void
+WaterfallHistorySnapshot::keep(uint64_t seq, const WaterfallHistoryRow *row)
+{
+  std::vector<uint8_t> *copy;
+
+  if (seq < this->begin || seq >= this->end)
+    return;
+
+  std::lock_guard<std::mutex> guard(this->mutex);
+
+  copy = &this->saved[seq];
+  copy->resize(sizeof(WaterfallHistoryRow) + this->width);
+  memcpy(copy->data(), row, copy->size());
+}
+
+// The history is going away: whatever was not copied yet is copied now
+void
+WaterfallHistorySnapshot::detach(void)
+{
+  for (uint64_t seq = this->begin; seq < this->end; ++seq)
+    if (this->saved.find(seq) == this->saved.end())
+      this->keep(seq, this->history->slot(0, seq));
+
+  std::lock_guard<std::mutex> guard(this->mutex);
+
+  this->history = nullptr;
+}
+
+bool
+WaterfallHistorySnapshot::read(
+    uint64_t seq,
+    float *db,
+    WaterfallHistoryRow &info)
+{
+  std::lock_guard<std::mutex> guard(this->mutex);
+  std::map<uint64_t, std::vector<uint8_t>>::const_iterator it;
+  const WaterfallHistoryRow *row;
+  const uint8_t *__restrict__ data;
+  float *__restrict__ out = db;
+  float min = this->dbMin;
+  float k = (this->dbMax - this->dbMin) / 255.f;
+
+  if (seq < this->begin || seq >= this->end)
+    return false;
+
+  if ((it = this->saved.find(seq)) != this->saved.end())
+    row = reinterpret_cast<const WaterfallHistoryRow *>(it->second.data());
+  else if (this->history != nullptr)
+    row = this->history->slot(0, seq);
+  else
+    return false;
+
+  info = *row;
+  data = row->getData();
+
+#pragma omp simd
+  for (unsigned int j = 0; j < this->width; ++j)
+    out[j] = min + k * data[j];
+
+  return true;
+}
+
+////////////////////////////////// History /////////////////////////////////////
+
+static size_t
+rowSize(unsigned int width, unsigned int level)
+{
+  // Reduced rows store both the max and the mean of each block
+  size_t bytes = level == 0 ? width : 2 * width;
+
+  return (sizeof(WaterfallHistoryRow) + bytes + 7) & ~static_cast<size_t>(7);
+}
+
+// Returns the size of the file for a given capacity
+size_t
+WaterfallHistory::layout(
+    uint64_t capacity,
+    std::vector<WaterfallHistoryLevel> &levels)
+{
+  WaterfallHistoryLevel level;
+  size_t offset = SIGDIGGER_HISTORY_HEADER_SIZE;
+  unsigned int k = 0;
+
+  levels.clear();
+
+  // Every level must hold at least the two rows the next one is built from
+  do {
+    level.offset   = offset;
+    level.width    = SIGDIGGER_HISTORY_WIDTH >> k;
+    level.rowSize  = rowSize(level.width, k);
+    level.capacity = capacity >> k;
+
+    levels.push_back(level);
+    offset += level.capacity * level.rowSize;
+    ++k;
+  } while (k < SIGDIGGER_HISTORY_MAX_LEVELS
+           && (SIGDIGGER_HISTORY_WIDTH >> k) >= SIGDIGGER_HISTORY_MIN_BINS
+           && (capacity >> (k - 1)) >= 2);
+
+  return offset;
+}
+
+uint64_t
+WaterfallHistory::capacityFor(uint64_t bytes)
+{
+  std::vector<WaterfallHistoryLevel> levels;
+  double perRow = 0;
+  uint64_t rows = 0;
+
+  if (bytes > SIGDIGGER_HISTORY_HEADER_SIZE) {
+    // The pyramid adds a geometric series on top of every row
+    for (unsigned int k = 0; k < SIGDIGGER_HISTORY_MAX_LEVELS; ++k)
+      perRow += static_cast<double>(
+            rowSize(SIGDIGGER_HISTORY_WIDTH >> k, k)) / (1ull << k);
+
+    rows = static_cast<uint64_t>(
+          (bytes - SIGDIGGER_HISTORY_HEADER_SIZE) / perRow);
+
+    while (rows > 1 && layout(rows, levels) > bytes)
+      --rows;
+  }
+
+  return rows > 0 ? rows : 1;
+}
+
+// Reuses an existing history file, as long as it has the same layout
+bool
+WaterfallHistory::attach(uint64_t capacity)
+{
+  WaterfallHistoryHeader header;
+  struct stat sbuf;
+  size_t size = layout(capacity, this->levels);
+
+  if (fstat(this->fd, &sbuf) == -1 || static_cast<size_t>(sbuf.st_size) != size)
+    return false;
+
+  if (pread(this->fd, &header, sizeof(header), 0) != sizeof(header))
+    return false;
+
+  if (header.magic != SIGDIGGER_HISTORY_MAGIC
+      || header.version != SIGDIGGER_HISTORY_VERSION
+      || header.width != SIGDIGGER_HISTORY_WIDTH
+      || header.rowSize != rowSize(SIGDIGGER_HISTORY_WIDTH, 0)
+      || header.capacity != capacity
+      || header.levels != this->levels.size())
+    return false;
+
+  this->mapSize = size;
+  return true;
+}
+
+// Anything else is discarded. The file is sparse, disk space is only
+// claimed as rows are written.
+void
+WaterfallHistory::format(uint64_t capacity)
+{
+  WaterfallHistoryHeader header;
+
+  this->mapSize = layout(capacity, this->levels);
+
+  if (ftruncate(this->fd, 0) == -1
+      || ftruncate(this->fd, static_cast<off_t>(this->mapSize)) == -1)
+    throw std::runtime_error(
+        "Cannot resize waterfall history file: "
+        + std::string(strerror(errno)));
+
+  memset(&header, 0, sizeof(header));
+  header.magic    = SIGDIGGER_HISTORY_MAGIC;
+  header.version  = SIGDIGGER_HISTORY_VERSION;
+  header.width    = SIGDIGGER_HISTORY_WIDTH;
+  header.rowSize  = static_cast<uint32_t>(rowSize(SIGDIGGER_HISTORY_WIDTH, 0));
+  header.capacity = capacity;
+  header.written  = 0;
+  header.dbMin    = SIGDIGGER_HISTORY_DB_MIN;
+  header.dbMax    = SIGDIGGER_HISTORY_DB_MAX;
+  header.levels   = static_cast<uint32_t>(this->levels.size());
+
+  if (pwrite(this->fd, &header, sizeof(header), 0) != sizeof(header))
+    throw std::runtime_error(
+        "Cannot write waterfall history header: "
+        + std::string(strerror(errno)));
+}
+
+WaterfallHistory::WaterfallHistory(std::string const &path, uint64_t capacity)
+{
+  void *map;
+
+  if (capacity == 0)
+    capacity = 1;
+
+  if ((this->fd = open(path.c_str(), O_RDWR | O_CREAT, 0644)) == -1)
+    throw std::runtime_error(
+        "Cannot open " + path + ": " + std::string(strerror(errno)));
+
+  try {
+    if (!this->attach(capacity))
+      this->format(capacity);
+
+    map = mmap(
+          nullptr,
+          this->mapSize,
+          PROT_READ | PROT_WRITE,
+          MAP_SHARED,
+          this->fd,
+          0);
+
+    if (map == MAP_FAILED)
+      throw std::runtime_error(
+          "Cannot map " + path + ": " + std::string(strerror(errno)));
+  } catch (std::runtime_error &) {
+    close(this->fd);
+    throw;
+  }
+
+  this->map    = static_cast<uint8_t *>(map);
+  this->header = reinterpret_cast<WaterfallHistoryHeader *>(this->map);
+  this->line.resize(this->header->width);
+  this->written.store(this->header->written, std::memory_order_release);
+}
+
+WaterfallHistory::~WaterfallHistory()
+{
+  for (auto s : this->snapshots)
+    s->detach();
+
+  if (this->map != nullptr)
+    munmap(this->map, this->mapSize);
+
+  if (this->fd != -1)
+    close(this->fd);
+}
+
+const WaterfallHistoryRow *
+WaterfallHistory::getRow(uint64_t seq, unsigned int level) const
+{
+  if (level >= this->levels.size()
+      || seq < this->getFirst(level)
+      || seq >= this->getEnd(level))
+    return nullptr;
+
+  return this->slot(level, seq);
+}
+
+//
+// Rows are published (written bumped, with release semantics) once
+// complete. Row `seq' of a level is overwritten while appending the row
+// that ends block seq + capacity of that level, when getEnd() of the
+// level already reads seq + capacity. If the end is still below that
+// after the copy, the slot was not touched while copying it.
+//
+bool
+WaterfallHistory::readRow(
+    uint64_t seq,
+    unsigned int level,
+    WaterfallHistoryRow &info,
+    uint8_t *data) const
+{
+  const WaterfallHistoryRow *row;
+  uint64_t capacity;
+
+  if (level >= this->levels.size()
+      || seq >= this->getEnd(level))
+    return false;
+
+  capacity = this->levels[level].capacity;
+  if (seq + capacity <= this->getEnd(level))
+    return false;
+
+  row  = this->slot(level, seq);
+  info = *row;
+  memcpy(data, row->getData(), this->getRowSize(level));
+
+  std::atomic_thread_fence(std::memory_order_acquire);
+
+  return seq + capacity > this->getEnd(level);
+}
+
+std::unique_ptr<WaterfallHistorySnapshot>
+WaterfallHistory::snapshot(uint64_t begin, uint64_t end)
+{
+  std::unique_ptr<WaterfallHistorySnapshot> snapshot;
+
+  begin = std::max(begin, this->getFirst());
+  end   = std::min(end, this->getEnd());
+  if (begin > end)
+    begin = end;
+
+  snapshot.reset(new WaterfallHistorySnapshot(this, begin, end));
+  this->snapshots.push_back(snapshot.get());
+
+  return snapshot;
+}
+
+// Timestamps only go forward
+uint64_t
+WaterfallHistory::findRow(int64_t timestamp) const
+{
+  uint64_t lo = this->getFirst();
+  uint64_t hi = this->getEnd();
+
+  while (lo < hi) {
+    uint64_t mid = lo + (hi - lo) / 2;
+
+    if (this->slot(0, mid)->timestamp < timestamp)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  return lo;
+}
+
+// Builds row `seq' of `level' from rows 2 * seq and 2 * seq + 1 below it
+void
+WaterfallHistory::reduce(unsigned int level, uint64_t seq)
+{
+  const WaterfallHistoryRow *a = this->slot(level - 1, 2 * seq);
+  const WaterfallHistoryRow *b = this->slot(level - 1, 2 * seq + 1);
+  WaterfallHistoryRow *row = this->slot(level, seq);
+  size_t width = this->levels[level].width;
+  const uint8_t *__restrict__ aMax  = a->getData();
+  const uint8_t *__restrict__ bMax  = b->getData();
+  const uint8_t *__restrict__ aMean = this->getMean(level - 1, a);
+  const uint8_t *__restrict__ bMean = this->getMean(level - 1, b);
+  uint8_t *__restrict__ max  = reinterpret_cast<uint8_t *>(row + 1);
+  uint8_t *__restrict__ mean = max + width;
+
+#pragma omp simd
+  for (size_t j = 0; j < width; ++j) {
+    uint8_t p = aMax[2 * j] > aMax[2 * j + 1] ? aMax[2 * j] : aMax[2 * j + 1];
+    uint8_t q = bMax[2 * j] > bMax[2 * j + 1] ? bMax[2 * j] : bMax[2 * j + 1];
+
+    max[j]  = p > q ? p : q;
+    mean[j] = static_cast<uint8_t>(
+          (aMean[2 * j] + aMean[2 * j + 1] + bMean[2 * j] + bMean[2 * j + 1]
+           + 2) >> 2);
+  }
+
+  // Blocks are labelled after their first row
+  row->timestamp = a->timestamp;
+  row->fc        = a->fc;
+  row->rate      = a->rate;
+  row->reserved  = 0;
+}
+
+void
+WaterfallHistory::append(
+    const float *psd,
+    size_t size,
+    int64_t fc,
+    unsigned int rate,
+    int64_t timestamp)
+{
+  unsigned int width = this->header->width;
+  float *__restrict__ line = this->line.data();
+  uint8_t *__restrict__ out;
+  WaterfallHistoryRow *row;
+  uint64_t seq;
+  float min = this->header->dbMin;
+  float k = 255.f / (this->header->dbMax - this->header->dbMin);
+
+  if (size == 0)
+    return;
+
+  peakResample(psd, size, line, width);
+
+  seq = this->written.load(std::memory_order_relaxed);
+  row = this->slot(0, seq);
+
+  // Readers that see any of the writes below also see `written' reach
+  // seq, so they can tell the oldest row was being replaced
+  std::atomic_thread_fence(std::memory_order_release);
+
+  // Copy on write: snapshots may still want the row being replaced
+  if (seq >= this->levels[0].capacity)
+    for (auto s : this->snapshots)
+      s->keep(seq - this->levels[0].capacity, row);
+  out = reinterpret_cast<uint8_t *>(row + 1);
+
+#pragma omp simd
+  for (unsigned int j = 0; j < width; ++j) {
+    float q = (line[j] - min) * k + .5f;
+    q = q < 0.f ? 0.f : q;
+    q = q > 255.f ? 255.f : q;
+    out[j] = static_cast<uint8_t>(q);
+  }
+
+  row->timestamp = timestamp;
+  row->fc        = fc;
+  row->rate      = rate;
+  row->reserved  = 0;
+
+  // Every 2^k rows, a block of level k is complete
+  for (unsigned int k = 1;
+       k < this->levels.size() && ((seq + 1) & ((1ull << k) - 1)) == 0;
+       ++k)
+    this->reduce(k, seq >> k);
+
+  // Publish the rows only once they are complete
+  this->header->written = seq + 1;
+  this->written.store(seq + 1, std::memory_order_release);
+}
@@ -0,0 +1,287 @@
+//
+//    WaterfallTileCache.cpp: Threaded waterfall history rasterizer
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+#include "WaterfallTileCache.h"
+#include "PeakResample.h"
+#include <QPainter>
+#include <cstring>
+#include <algorithm>
+
+using namespace SigDigger;
+
+/////////////////////////////// Tile worker ////////////////////////////////////
+WaterfallTileWorker::WaterfallTileWorker(WaterfallTileCache *instance)
+{
+  this->instance = instance;
+}
+
+// Runs without the cache lock. Nobody else touches a RENDERING tile.
+void
+WaterfallTileWorker::render(
+    WaterfallTile &tile,
+    const QRgb *lut,
+    bool mean,
+    unsigned int width)
+{
+  WaterfallHistory *history = this->instance->history;
+  unsigned int bins = history->getWidth(tile.level);
+  quint64 base = tile.index * SIGDIGGER_TILE_ROWS;
+
+  if (tile.image.width() != static_cast<int>(width)
+      || tile.image.height() != SIGDIGGER_TILE_ROWS)
+    tile.image = QImage(
+          static_cast<int>(width),
+          SIGDIGGER_TILE_ROWS,
+          QImage::Format_RGB32);
+
+  this->peaks.resize(width);
+
+  // Rows are appended by the GUI thread meanwhile, so they are copied
+  // out of the ring, and left blank if they were overwritten while copied
+  this->row.resize(history->getRowSize(tile.level));
+
+  // Newest row of the tile on top
+  for (int i = 0; i < SIGDIGGER_TILE_ROWS; ++i) {
+    quint64 seq = base + static_cast<quint64>(SIGDIGGER_TILE_ROWS - 1 - i);
+    QRgb *line = reinterpret_cast<QRgb *>(tile.image.scanLine(i));
+    WaterfallHistoryRow info;
+    const uint8_t *data;
+
+    if (seq >= base + tile.rows
+        || !history->readRow(seq, tile.level, info, this->row.data())) {
+      memset(line, 0, width * sizeof(QRgb));
+      continue;
+    }
+
+    data = this->row.data();
+    if (mean && tile.level > 0)
+      data += bins;
+
+    peakResample(data, bins, this->peaks.data(), width);
+
+    for (unsigned int x = 0; x < width; ++x)
+      line[x] = lut[this->peaks[x]];
+  }
+}
+
+void
+WaterfallTileWorker::onWake(void)
+{
+  WaterfallTileCache *cache = this->instance;
+  QRgb lut[256];
+
+  for (;;) {
+    QMutexLocker renderLocker(&cache->renderMutex);
+    WaterfallTile *tile = nullptr;
+    unsigned int width;
+    bool mean;
+
+    {
+      QMutexLocker locker(&cache->mutex);
+      WaterfallTileCache::Request req;
+
+      if (cache->queue.empty() || cache->history == nullptr)
+        return;
+
+      req = cache->queue.front();
+      cache->queue.erase(cache->queue.begin());
+
+      // Least recently drawn tile, outdated ones first. Tiles drawn in
+      // the last paint are kept.
+      for (auto &t : cache->tiles) {
+        if (t.state == WaterfallTile::RENDERING)
+          continue;
+
+        if (t.state == WaterfallTile::FREE
+            || t.generation != cache->generation) {
+          tile = &t;
+          break;
+        }
+
+        if (t.lastUsed != cache->frame
+            && (tile == nullptr || t.lastUsed < tile->lastUsed))
+          tile = &t;
+      }
+
+      if (tile == nullptr)
+        continue;
+
+      tile->state      = WaterfallTile::RENDERING;
+      tile->level      = req.level;
+      tile->index      = req.index;
+      tile->rows       = req.rows;
+      tile->generation = cache->generation;
+
+      width = cache->width;
+      mean  = cache->mean;
+      memcpy(lut, cache->lut, sizeof(lut));
+    }
+
+    this->render(*tile, lut, mean, width);
+
+    {
+      QMutexLocker locker(&cache->mutex);
+
+      tile->state = tile->generation == cache->generation
+          ? WaterfallTile::READY
+          : WaterfallTile::FREE;
+    }
+
+    emit cache->tileReady();
+  }
+}
+
+//////////////////////////////// Tile cache ////////////////////////////////////
+WaterfallTileCache::WaterfallTileCache(QObject *parent) :
+  QObject(parent),
+  workerObject(this)
+{
+  this->tiles.resize(SIGDIGGER_TILE_COUNT);
+
+  for (int i = 0; i < 256; ++i)
+    this->lut[i] = qRgb(i, i, i);
+
+  QObject::connect(
+        this,
+        SIGNAL(wake(void)),
+        &this->workerObject,
+        SLOT(onWake(void)));
+
+  this->workerObject.moveToThread(&this->workerThread);
+  this->workerThread.start();
+}
+
+WaterfallTileCache::~WaterfallTileCache()
+{
+  this->workerThread.quit();
+  this->workerThread.wait();
+}
+
+// Protected by mutex
+void
+WaterfallTileCache::invalidate(void)
+{
+  ++this->generation;
+  this->queue.clear();
+}
+
+void
+WaterfallTileCache::setHistory(WaterfallHistory *history)
+{
+  // Wait for the tile being drawn from the previous history
+  QMutexLocker renderLocker(&this->renderMutex);
+  QMutexLocker locker(&this->mutex);
+
+  this->history = history;
+  this->invalidate();
+}
+
+void
+WaterfallTileCache::setLut(const QRgb *lut)
+{
+  QMutexLocker locker(&this->mutex);
+
+  memcpy(this->lut, lut, sizeof(this->lut));
+  this->invalidate();
+}
+
+void
+WaterfallTileCache::setMean(bool mean)
+{
+  QMutexLocker locker(&this->mutex);
+
+  if (this->mean != mean) {
+    this->mean = mean;
+    this->invalidate();
+  }
+}
+
+void
+WaterfallTileCache::draw(
+    QPainter &painter,
+    int width,
+    int height,
+    unsigned int level,
+    quint64 top)
+{
+  QMutexLocker locker(&this->mutex);
+  quint64 first, end, index;
+  bool queued;
+
+  if (this->history == nullptr || width <= 0)
+    return;
+
+  if (this->width != static_cast<unsigned int>(width)) {
+    this->width = static_cast<unsigned int>(width);
+    this->invalidate();
+  }
+
+  first = this->history->getFirst(level);
+  end   = this->history->getEnd(level);
+
+  if (top >= end)
+    return;
+
+  ++this->frame;
+  this->queue.clear();
+
+  for (index = top / SIGDIGGER_TILE_ROWS; ; --index) {
+    quint64 base = index * SIGDIGGER_TILE_ROWS;
+    qint64 y = static_cast<qint64>(top)
+        - static_cast<qint64>(base + SIGDIGGER_TILE_ROWS - 1);
+    unsigned int rows = static_cast<unsigned int>(
+          std::min<quint64>(end - base, SIGDIGGER_TILE_ROWS));
+    WaterfallTile *best = nullptr;
+
+    if (y >= height || base + SIGDIGGER_TILE_ROWS <= first)
+      break;
+
+    queued = false;
+
+    for (auto &t : this->tiles) {
+      if (t.generation != this->generation
+          || t.level != level
+          || t.index != index
+          || t.state == WaterfallTile::FREE)
+        continue;
+
+      if (t.state == WaterfallTile::RENDERING) {
+        queued = queued || t.rows >= rows;
+      } else if (best == nullptr || t.rows > best->rows) {
+        best = &t;
+      }
+    }
+
+    // The newest tile keeps growing. Until it is drawn again, the
+    // previous version of it is shown.
+    if (best != nullptr) {
+      painter.drawImage(0, static_cast<int>(y), best->image);
+      best->lastUsed = this->frame;
+    }
+
+    if (!queued && (best == nullptr || best->rows < rows))
+      this->queue.push_back(Request{level, index, rows});
+
+    if (index == 0)
+      break;
+  }
+
+  if (!this->queue.empty())
+    emit wake();
+}
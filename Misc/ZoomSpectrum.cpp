@@ -0,0 +1,67 @@
+//
+//    ZoomSpectrum.cpp: High resolution spectrum of the visible span
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+#include "ZoomSpectrum.h"
+#include "PowerMath.h"
+
+using namespace SigDigger;
+
+unsigned int
+ZoomSpectrum::getSpan(unsigned int sampleRate, unsigned int zoom)
+{
+  if (zoom < SIGDIGGER_ZOOM_SPECTRUM_MIN_ZOOM)
+    return 0;
+
+  return sampleRate / zoom;
+}
+
+//
+// Swapping the halves and converting to dB are done in the same pass,
+// one vectorized loop per half.
+//
+void
+ZoomSpectrum::feed(const float *power, size_t size, unsigned int rate)
+{
+  const float *__restrict__ in = power;
+  float *__restrict__ out;
+  size_t i, half = size / 2, rest = size - half;
+
+  if (size != this->psd.size())
+    this->psd.resize(size);
+
+  out = this->psd.data();
+
+  // Negative frequencies: upper half of the FFT
+#pragma omp simd
+  for (i = 0; i < half; ++i)
+    out[i] = SIGDIGGER_LOG2_TO_DB * log2FromPower(in[rest + i]);
+
+#pragma omp simd
+  for (i = 0; i < rest; ++i)
+    out[half + i] = SIGDIGGER_LOG2_TO_DB * log2FromPower(in[i]);
+
+  this->rate = rate;
+}
+
+void
+ZoomSpectrum::reset(void)
+{
+  this->psd.clear();
+  this->rate = 0;
+}
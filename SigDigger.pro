@@ -31,6 +31,10 @@ equals(QT_MAJOR_VERSION, 5):lessThan(QT_MINOR_VERSION, 9) {
 CONFIG(release, debug|release): QMAKE_CXXFLAGS+=-D__FILENAME__=\\\"SigDigger\\\"
 CONFIG(debug, debug|release):   QMAKE_CXXFLAGS+=-D__FILENAME__=__FILE__
 
+# Hot DSP loops are annotated with "omp simd" and left to the
+# auto-vectorizer. This does not pull in the OpenMP runtime.
+QMAKE_CXXFLAGS += -fopenmp-simd -ftree-vectorize
+
 isEmpty(SUWIDGETS_PREFIX) {
   SUWIDGETS_INSTALL_LIBS=$$[QT_INSTALL_LIBS]
   SUWIDGETS_INSTALL_HEADERS=$$[QT_INSTALL_HEADERS]/SuWidgets
@@ -52,11 +56,24 @@ SOURCES += \
     App/AppConfig.cpp \
     App/Application.cpp \
     App/AppUI.cpp \
+    App/AlertConfig.cpp \
+    App/BandMeterConfig.cpp \
     App/ColorConfig.cpp \
     App/Loader.cpp \
     Audio/AudioPlayback.cpp \
+    Audio/AudioBackend.cpp \
+    Audio/AlsaAudioBackend.cpp \
+    Audio/PulseAudioBackend.cpp \
+    Audio/FileAudioBackend.cpp \
+    Audio/AudioOutputStage.cpp \
+    Audio/AudioMixer.cpp \
     Components/AboutDialog.cpp \
+    Components/AlertDialog.cpp \
     Components/AudioPanel.cpp \
+    Components/BandMeterDialog.cpp \
+    Components/BandMeterView.cpp \
+    Components/BookmarkDialog.cpp \
+    Components/BookmarkView.cpp \
     Components/ConfigDialog.cpp \
     Components/DataSaverUI.cpp \
     Components/DeviceGain.cpp \
@@ -65,9 +82,15 @@ SOURCES += \
     Components/InspectorPanel.cpp \
     Components/MainSpectrum.cpp \
     Components/MainWindow.cpp \
+    Components/OccupancyDialog.cpp \
+    Components/PeakTrackerDialog.cpp \
+    Components/PersistenceView.cpp \
     Components/PersistentWidget.cpp \
+    Components/ReferenceDialog.cpp \
+    Components/ReferenceView.cpp \
     Components/SaveProfileDialog.cpp \
     Components/SourcePanel.cpp \
+    Components/WaterfallHistoryView.cpp \
     Inspector/Inspector.cpp \
     Inspector/InspectorUI.cpp \
     InspectorCtl/AfcControl.cpp \
@@ -78,10 +101,28 @@ SOURCES += \
     InspectorCtl/InspectorCtl.cpp \
     InspectorCtl/MfControl.cpp \
     InspectorCtl/ToneControl.cpp \
+    Misc/AlertEngine.cpp \
+    Misc/AlertNotifier.cpp \
     Misc/AutoGain.cpp \
     Misc/Averager.cpp \
+    Misc/BandMeter.cpp \
+    Misc/BookmarkStore.cpp \
+    Misc/FftGovernor.cpp \
+    Misc/FftwWisdom.cpp \
+    Misc/NoiseFloor.cpp \
+    Misc/Occupancy.cpp \
+    Misc/OccupancyExporter.cpp \
     Misc/Palette.cpp \
+    Misc/PeakTracker.cpp \
+    Misc/Persistence.cpp \
+    Misc/ReferenceTrace.cpp \
+    Misc/WaterfallHistory.cpp \
+    Misc/WaterfallTileCache.cpp \
     Misc/SNREstimator.cpp \
+    Misc/SnapshotExporter.cpp \
+    Misc/SpectrumPlayer.cpp \
+    Misc/SpectrumRecorder.cpp \
+    Misc/ZoomSpectrum.cpp \
     Suscan/Messages/ChannelMessage.cpp \
     Suscan/Messages/GenericMessage.cpp \
     Suscan/Messages/InspectorMessage.cpp \
@@ -108,6 +149,7 @@ SOURCES += \
     Components/EstimatorControl.cpp \
     Misc/GenericDataSaver.cpp \
     Misc/FileDataSaver.cpp \
+    Misc/AudioFileSaver.cpp \
     UDP/SocketForwarder.cpp \
     Components/NetForwarderUI.cpp \
     Components/WaitingSpinnerWidget.cpp \
@@ -138,14 +180,28 @@ HEADERS += \
     include/Suscan/SpectrumSource.h \
     include/AboutDialog.h \
     include/AfcControl.h \
+    include/AlertConfig.h \
+    include/AlertDialog.h \
+    include/AlertEngine.h \
+    include/AlertNotifier.h \
     include/AppConfig.h \
     include/Application.h \
     include/AppUI.h \
     include/AskControl.h \
     include/AudioPanel.h \
     include/AudioPlayback.h \
+    include/AudioBackend.h \
+    include/AudioOutputStage.h \
+    include/AudioMixer.h \
     include/AutoGain.h \
     include/Averager.h \
+    include/BandMeter.h \
+    include/BandMeterConfig.h \
+    include/BandMeterDialog.h \
+    include/BandMeterView.h \
+    include/BookmarkDialog.h \
+    include/BookmarkStore.h \
+    include/BookmarkView.h \
     include/ClockRecovery.h \
     include/ColorConfig.h \
     include/ConfigDialog.h \
@@ -153,6 +209,8 @@ HEADERS += \
     include/DefaultGradient.h \
     include/DeviceGain.h \
     include/EqualizerControl.h \
+    include/FftGovernor.h \
+    include/FftwWisdom.h \
     include/FftPanel.h \
     include/GainControl.h \
     include/GainSlider.h \
@@ -164,16 +222,37 @@ HEADERS += \
     include/MainSpectrum.h \
     include/MainWindow.h \
     include/MfControl.h \
+    include/NoiseFloor.h \
+    include/Occupancy.h \
+    include/OccupancyDialog.h \
+    include/OccupancyExporter.h \
     include/Palette.h \
+    include/PeakTracker.h \
+    include/PeakTrackerDialog.h \
+    include/Persistence.h \
+    include/PersistenceView.h \
     include/PersistentWidget.h \
+    include/PeakResample.h \
+    include/PowerMath.h \
+    include/ReferenceDialog.h \
+    include/ReferenceTrace.h \
+    include/ReferenceView.h \
     include/SaveProfileDialog.h \
     include/SNREstimator.h \
+    include/SnapshotExporter.h \
     include/SourcePanel.h \
+    include/SpectrumPlayer.h \
+    include/SpectrumRecorder.h \
     include/ToneControl.h \
     include/UIMediator.h \
+    include/WaterfallHistory.h \
+    include/WaterfallHistoryView.h \
+    include/WaterfallTileCache.h \
+    include/ZoomSpectrum.h \
     include/EstimatorControl.h \
     include/GenericDataSaver.h \
     include/FileDataSaver.h \
+    include/AudioFileSaver.h \
     include/SocketForwarder.h \
     include/NetForwarderUI.h \
     include/WaitingSpinnerWidget.h \
@@ -183,8 +262,11 @@ HEADERS += \
 FORMS += \
     ui/AboutDialog.ui \
     ui/AfcControl.ui \
+    ui/AlertDialog.ui \
     ui/AskControl.ui \
     ui/AudioPanel.ui \
+    ui/BandMeterDialog.ui \
+    ui/BookmarkDialog.ui \
     ui/ClockRecovery.ui \
     ui/Config.ui \
     ui/DataSaverUI.ui \
@@ -198,8 +280,12 @@ FORMS += \
     ui/MainSpectrum.ui \
     ui/MainWindow.ui \
     ui/MfControl.ui \
+    ui/OccupancyDialog.ui \
+    ui/ReferenceDialog.ui \
     ui/SourcePanel.ui \
     ui/ToneControl.ui \
+    ui/PeakTrackerDialog.ui \
+    ui/WaterfallHistoryDialog.ui \
     ui/SaveProfileDialog.ui \
     ui/EstimatorControl.ui \
     ui/NetForwarderUI.ui \
@@ -211,15 +297,23 @@ RESOURCES += \
     icons/Icons.qrc
 
 unix: CONFIG += link_pkgconfig
-unix: PKGCONFIG += suscan
+unix: PKGCONFIG += suscan fftw3f
 
 packagesExist(alsa) {
   PKGCONFIG += alsa
   DEFINES += SIGDIGGER_HAVE_ALSA
 }
 
+packagesExist(libpulse-simple) {
+  PKGCONFIG += libpulse-simple
+  DEFINES += SIGDIGGER_HAVE_PULSEAUDIO
+}
+
 unix: LIBS += -L$$SUWIDGETS_INSTALL_LIBS -lsuwidgets
 
+# Thread safe planner, for the FFT warm-up
+unix: LIBS += -lfftw3f_threads
+
 DISTFILES += \
     icons/icon-alpha.png \
     icons/icon-color-about.png \
@@ -45,9 +45,19 @@ Analyzer::AsyncThread::run()
     data = this->owner->read(type);
 
     switch (type) {
+      // Heavy lifting is done here: the GUI thread gets the PSD in dB,
+      // along with the bins the spectrum is going to paint.
+      case SUSCAN_ANALYZER_MESSAGE_TYPE_PSD: {
+        PSDMessage msg(static_cast<struct suscan_analyzer_psd_msg *>(data));
+        msg.prepare(this->owner->psdBins, this->owner->psdDetector);
+        ++this->owner->pending;
+        emit psd(msg);
+        break;
+      }
+
       case SUSCAN_ANALYZER_MESSAGE_TYPE_INSPECTOR:
-      case SUSCAN_ANALYZER_MESSAGE_TYPE_PSD:
       case SUSCAN_ANALYZER_MESSAGE_TYPE_SAMPLES:
+        ++this->owner->pending;
         emit message(type, data);
         break;
 
@@ -157,6 +167,13 @@ Analyzer::setAGC(bool enabled)
 
 }
 
+void
+Analyzer::setPSDDecimation(SUSCOUNT bins, PSDMessage::Detector detector)
+{
+  this->psdBins     = bins;
+  this->psdDetector = detector;
+}
+
 SUSCOUNT
 Analyzer::getSampleRate(void) const
 {
@@ -170,6 +187,13 @@ Analyzer::getMeasuredSampleRate(void) const
         suscan_analyzer_get_measured_samp_rate(this->instance));
 }
 
+// Messages queued for the GUI thread, a measure of how far behind it is
+unsigned int
+Analyzer::getPendingMessages(void) const
+{
+  return this->pending;
+}
+
 void
 Analyzer::halt(void)
 {
@@ -183,14 +207,12 @@ Analyzer::captureMessage(quint32 type, void *data)
   switch (type) {
     // Data messages
     case SUSCAN_ANALYZER_MESSAGE_TYPE_INSPECTOR:
+      --this->pending;
       emit inspector_message(InspectorMessage(static_cast<struct suscan_analyzer_inspector_msg *>(data)));
       break;
 
-    case SUSCAN_ANALYZER_MESSAGE_TYPE_PSD:
-      emit psd_message(PSDMessage(static_cast<struct suscan_analyzer_psd_msg *>(data)));
-      break;
-
     case SUSCAN_ANALYZER_MESSAGE_TYPE_SAMPLES:
+      --this->pending;
       emit samples_message(SamplesMessage(static_cast<struct suscan_analyzer_sample_batch_msg *>(data)));
       break;
 
@@ -213,6 +235,13 @@ Analyzer::captureMessage(quint32 type, void *data)
   }
 }
 
+void
+Analyzer::capturePSD(const Suscan::PSDMessage &message)
+{
+  --this->pending;
+  emit psd_message(message);
+}
+
 bool Analyzer::registered = false; // Yes, C++!
 
 void
@@ -383,6 +412,13 @@ Analyzer::Analyzer(AnalyzerParams &params, Source::Config const &config)
         SLOT(captureMessage(quint32, void *)),
         Qt::QueuedConnection);
 
+  connect(
+        this->asyncThread,
+        SIGNAL(psd(const Suscan::PSDMessage &)),
+        this,
+        SLOT(capturePSD(const Suscan::PSDMessage &)),
+        Qt::QueuedConnection);
+
   this->asyncThread->start();
 }
 
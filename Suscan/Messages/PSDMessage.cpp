@@ -18,6 +18,8 @@
 //
 
 #include <Suscan/Messages/PSDMessage.h>
+#include <PeakResample.h>
+#include <algorithm>
 
 using namespace Suscan;
 
@@ -26,18 +28,102 @@ PSDMessage::PSDMessage() : Message() { }
 PSDMessage::PSDMessage(struct suscan_analyzer_psd_msg *msg) :
   Message(SUSCAN_ANALYZER_MESSAGE_TYPE_PSD, msg)
 {
-  unsigned int i;
-  SUSCOUNT half_size{msg->psd_size / 2};
-  SUFLOAT tmp;
   this->message = msg;
+}
+
+template<PSDMessage::Detector D> static inline SUFLOAT
+reduce(const SUFLOAT *__restrict__ data, SUSCOUNT len)
+{
+  SUFLOAT acc = data[0];
+
+  switch (D) {
+    case PSDMessage::DETECTOR_MIN:
+#pragma omp simd reduction(min:acc)
+      for (SUSCOUNT i = 1; i < len; ++i)
+        acc = data[i] < acc ? data[i] : acc;
+      return acc;
+
+    case PSDMessage::DETECTOR_MEAN:
+#pragma omp simd reduction(+:acc)
+      for (SUSCOUNT i = 1; i < len; ++i)
+        acc += data[i];
+      return acc / static_cast<SUFLOAT>(len);
+
+    default:
+      break;
+  }
+
+  return acc;
+}
+
+// Bin j takes the input range [j * size / bins, (j + 1) * size / bins),
+// as in peakResample(), which does the peak detector
+template<PSDMessage::Detector D> static void
+decimateAs(
+    const SUFLOAT *__restrict__ data,
+    SUSCOUNT size,
+    SUFLOAT *__restrict__ out,
+    SUSCOUNT bins)
+{
+  SUSCOUNT start = 0, end;
+
+  for (SUSCOUNT j = 0; j < bins; ++j) {
+    end = (j + 1) * size / bins;
+    out[j] = reduce<D>(data + start, end - start);
+    start = end;
+  }
+}
+
+void
+PSDMessage::decimate(
+    const SUFLOAT *data,
+    SUSCOUNT size,
+    SUFLOAT *out,
+    SUSCOUNT bins,
+    Detector detector)
+{
+  switch (detector) {
+    case DETECTOR_PEAK:
+      peakResample(data, size, out, bins);
+      break;
+
+    case DETECTOR_MEAN:
+      decimateAs<DETECTOR_MEAN>(data, size, out, bins);
+      break;
 
-  for (i = 0; i < half_size; ++i) {
-    tmp = msg->psd_data[i + half_size];
-    msg->psd_data[i + half_size] = SU_POWER_DB(msg->psd_data[i]);
-    msg->psd_data[i] = SU_POWER_DB(tmp);
+    case DETECTOR_MIN:
+      decimateAs<DETECTOR_MIN>(data, size, out, bins);
+      break;
   }
 }
 
+void
+PSDMessage::prepare(SUSCOUNT bins, Detector detector)
+{
+  SUSCOUNT size = this->message->psd_size;
+  SUSCOUNT half_size = size / 2;
+  SUFLOAT *data = this->message->psd_data;
+  SUFLOAT *out;
+
+  std::swap_ranges(data, data + half_size, data + half_size);
+
+  // Merging is done in linear power, so the mean detector averages
+  // energy and not decibels. The message itself is left at full
+  // resolution: only the spectrum display wants fewer bins.
+  if (bins > 0 && bins < size) {
+    this->display = std::make_shared<std::vector<SUFLOAT>>(bins);
+    out = this->display->data();
+
+    decimate(data, size, out, bins, detector);
+
+    for (SUSCOUNT i = 0; i < bins; ++i)
+      out[i] = SU_POWER_DB(out[i]);
+  }
+
+  for (SUSCOUNT i = 0; i < size; ++i)
+    data[i] = SU_POWER_DB(data[i]);
+}
+
 SUSCOUNT
 PSDMessage::size(void) const
 {
@@ -61,3 +147,15 @@ PSDMessage::get(void) const
       = static_cast<struct suscan_analyzer_psd_msg *>(this->c_message.get());
   return msg->psd_data;
 }
+
+SUSCOUNT
+PSDMessage::getDisplaySize(void) const
+{
+  return this->display ? this->display->size() : this->size();
+}
+
+const SUFLOAT *
+PSDMessage::getDisplay(void) const
+{
+  return this->display ? this->display->data() : this->get();
+}
@@ -29,6 +29,30 @@ UIMediator::connectAudioPanel(void)
         SIGNAL(changed(void)),
         this,
         SLOT(onAudioChanged(void)));
+
+  connect(
+        this->ui->audioPanel,
+        SIGNAL(toggleRecord(void)),
+        this,
+        SLOT(onToggleAudioRecord(void)));
+
+  connect(
+        this->ui->audioPanel,
+        SIGNAL(pinChannel(void)),
+        this,
+        SLOT(onPinAudioChannel(void)));
+
+  connect(
+        this->ui->audioPanel,
+        SIGNAL(channelsChanged(void)),
+        this,
+        SLOT(onAudioChannelsChanged(void)));
+
+  connect(
+        this->ui->audioPanel,
+        SIGNAL(mixChanged(void)),
+        this,
+        SLOT(onAudioMixChanged(void)));
 }
 
 void
@@ -36,3 +60,27 @@ UIMediator::onAudioChanged(void)
 {
   emit audioChanged();
 }
+
+void
+UIMediator::onToggleAudioRecord(void)
+{
+  emit toggleAudioRecord();
+}
+
+void
+UIMediator::onPinAudioChannel(void)
+{
+  emit pinAudioChannel();
+}
+
+void
+UIMediator::onAudioChannelsChanged(void)
+{
+  emit audioChannelsChanged();
+}
+
+void
+UIMediator::onAudioMixChanged(void)
+{
+  emit audioMixChanged();
+}
@@ -18,6 +18,15 @@
 //
 
 #include "UIMediator.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QMessageBox>
+#include <cmath>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
 
 using namespace SigDigger;
 
@@ -42,6 +51,24 @@ UIMediator::connectFftPanel(void)
         this,
         SLOT(onAveragerChanged(void)));
 
+  connect(
+        this->ui->fftPanel,
+        SIGNAL(persistenceChanged(void)),
+        this,
+        SLOT(onPersistenceChanged(void)));
+
+  connect(
+        this->ui->fftPanel,
+        SIGNAL(autoFftChanged(void)),
+        this,
+        SLOT(onAutoFftChanged(void)));
+
+  connect(
+        this->ui->fftPanel,
+        SIGNAL(zoomSpectrumChanged(void)),
+        this,
+        SLOT(onZoomSpectrumChanged(void)));
+
   connect(
         this->ui->fftPanel,
         SIGNAL(fftSizeChanged(void)),
@@ -65,6 +92,60 @@ UIMediator::connectFftPanel(void)
         SIGNAL(windowFunctionChanged(void)),
         this,
         SLOT(onWindowFunctionChanged(void)));
+
+  connect(
+        this->ui->fftPanel,
+        SIGNAL(historyChanged(void)),
+        this,
+        SLOT(onHistoryChanged(void)));
+
+  connect(
+        this->ui->fftPanel,
+        SIGNAL(browseHistory(void)),
+        this,
+        SLOT(onBrowseHistory(void)));
+
+  connect(
+        this->ui->fftPanel,
+        SIGNAL(spectrumLogChanged(void)),
+        this,
+        SLOT(onSpectrumLogChanged(void)));
+
+  connect(
+        this->ui->fftPanel,
+        SIGNAL(replayChanged(void)),
+        this,
+        SLOT(onReplayChanged(void)));
+
+  connect(
+        &this->player,
+        SIGNAL(frame(float *, int, qint64, unsigned int, qint64)),
+        this,
+        SLOT(onReplayFrame(float *, int, qint64, unsigned int, qint64)));
+
+  connect(
+        &this->player,
+        SIGNAL(finished(void)),
+        this,
+        SLOT(onReplayFinished(void)));
+
+  connect(
+        this->ui->fftPanel,
+        SIGNAL(trackPeaks(void)),
+        this,
+        SLOT(onTrackPeaks(void)));
+
+  connect(
+        this->ui->fftPanel,
+        SIGNAL(autoRange(void)),
+        this,
+        SLOT(onAutoRange(void)));
+
+  connect(
+        this->ui->peakDialog,
+        SIGNAL(tune(qint64)),
+        this,
+        SLOT(onTunePeak(qint64)));
 }
 
 void
@@ -72,6 +153,12 @@ UIMediator::onPaletteChanged(void)
 {
   this->ui->spectrum->setPaletteGradient(
         this->ui->fftPanel->getPaletteGradient());
+  this->ui->historyDialog->setColorPalette(
+        this->ui->fftPanel->getSelectedPalette());
+  this->ui->spectrum->setPersistencePalette(
+        this->ui->fftPanel->getSelectedPalette());
+  this->ui->occupancyDialog->setColorPalette(
+        this->ui->fftPanel->getSelectedPalette());
 }
 
 void
@@ -84,18 +171,64 @@ UIMediator::onRangesChanged(void)
   this->ui->spectrum->setWfRange(
         this->ui->fftPanel->getWfRangeMin(),
         this->ui->fftPanel->getWfRangeMax());
+  this->ui->historyDialog->setRange(
+        this->ui->fftPanel->getWfRangeMin(),
+        this->ui->fftPanel->getWfRangeMax());
 
   this->ui->spectrum->setPanWfRatio(this->ui->fftPanel->getPanWfRatio());
   this->ui->spectrum->setZoom(this->ui->fftPanel->getFreqZoom());
 
   this->ui->spectrum->setPeakDetect(this->ui->fftPanel->getPeakDetect());
   this->ui->spectrum->setPeakHold(this->ui->fftPanel->getPeakHold());
+
+  this->updateZoomSpectrum();
+}
+
+static void
+configureAverager(Averager &averager, const FftPanel *panel)
+{
+  averager.setMode(panel->getAveragerMode());
+  averager.setAlpha(panel->getAveraging());
+  averager.setWindow(panel->getAveragerWindow());
+  averager.setDecay(panel->getAveragerDecay());
+  averager.setLinear(panel->getAveragerLinear());
 }
 
 void
 UIMediator::onAveragerChanged(void)
 {
-  this->averager.setAlpha(this->ui->fftPanel->getAveraging());
+  configureAverager(this->averager, this->ui->fftPanel);
+  configureAverager(this->displayAverager, this->ui->fftPanel);
+}
+
+void
+UIMediator::onPersistenceChanged(void)
+{
+  this->ui->spectrum->setPersistenceTime(
+        this->ui->fftPanel->getPersistenceTime());
+  this->ui->spectrum->setPersistence(this->ui->fftPanel->getPersistence());
+}
+
+void
+UIMediator::onZoomSpectrumChanged(void)
+{
+  this->updateZoomSpectrum();
+}
+
+void
+UIMediator::onAutoFftChanged(void)
+{
+  bool enabled = this->ui->fftPanel->getAutoFft();
+
+  this->governor.setTarget(
+        static_cast<qreal>(this->ui->fftPanel->getCpuTarget()));
+
+  if (enabled != this->autoFft) {
+    this->autoFft = enabled;
+    this->governor.reset();
+    this->governorClock.invalidate();
+    emit analyzerParamsChanged();
+  }
 }
 
 void
@@ -126,3 +259,306 @@ UIMediator::onWindowFunctionChanged(void)
 
   emit analyzerParamsChanged();
 }
+
+void
+UIMediator::onHistoryChanged(void)
+{
+  bool enabled = this->ui->fftPanel->getHistoryEnabled();
+
+  if (enabled && this->history == nullptr) {
+    std::string path = this->ui->fftPanel->getHistoryPath();
+
+    try {
+      QDir().mkpath(QFileInfo(QString::fromStdString(path)).absolutePath());
+      this->history = std::make_unique<WaterfallHistory>(
+            path,
+            WaterfallHistory::capacityFor(
+              this->ui->fftPanel->getHistorySize()));
+    } catch (std::runtime_error const &e) {
+      QMessageBox::warning(
+            this->ui->main->centralWidget,
+            "Waterfall history",
+            "Cannot open waterfall history file. Error was:<p /><pre>"
+            + QString(e.what()) + "</pre>",
+            QMessageBox::Ok);
+      this->ui->fftPanel->setHistoryEnabled(false);
+    }
+  } else if (!enabled && this->history != nullptr) {
+    this->ui->historyDialog->setHistory(nullptr);
+    this->history = nullptr;
+  }
+
+  if (this->history != nullptr)
+    this->ui->historyDialog->setHistory(this->history.get());
+}
+
+void
+UIMediator::onBrowseHistory(void)
+{
+  this->ui->historyDialog->setHistory(this->history.get());
+  this->ui->historyDialog->show();
+  this->ui->historyDialog->raise();
+}
+
+void
+UIMediator::onSpectrumLogChanged(void)
+{
+  bool enabled = this->ui->fftPanel->getSpectrumLogEnabled();
+
+  if (enabled && this->spectrumLog == nullptr) {
+    std::string path =
+        this->ui->fftPanel->getSpectrumLogFolder()
+        + "/spectrum-"
+        + QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss").toStdString()
+        + ".sslog";
+    int fd = open(path.c_str(), O_CREAT | O_TRUNC | O_WRONLY, 0644);
+
+    if (fd == -1) {
+      QMessageBox::critical(
+            this->ui->fftPanel,
+            "Spectrum log",
+            "Cannot create spectrum log file <pre>"
+            + QString::fromStdString(path)
+            + "</pre>: "
+            + QString(strerror(errno)),
+            QMessageBox::Close);
+      this->ui->fftPanel->setSpectrumLogEnabled(false);
+      return;
+    }
+
+    this->spectrumLog = std::make_unique<SpectrumRecorder>(
+          fd,
+          this->ui->fftPanel->getSpectrumLogBits());
+
+    connect(
+          this->spectrumLog.get(),
+          SIGNAL(stopped(void)),
+          this,
+          SLOT(onSpectrumLogStopped(void)));
+  } else if (!enabled && this->spectrumLog != nullptr) {
+    // Flushes whatever is left and closes the file
+    this->spectrumLog = nullptr;
+  }
+
+  if (this->spectrumLog != nullptr) {
+    this->spectrumLog->setMode(this->ui->fftPanel->getSpectrumLogMode());
+    this->spectrumLog->setInterval(
+          this->ui->fftPanel->getSpectrumLogInterval());
+    this->spectrumLog->setMaxWidth(this->ui->fftPanel->getSpectrumLogWidth());
+  }
+}
+
+void
+UIMediator::onSpectrumLogStopped(void)
+{
+  QMessageBox::critical(
+        this->ui->fftPanel,
+        "Spectrum log",
+        "Spectrum log stopped: " + this->spectrumLog->getLastError(),
+        QMessageBox::Close);
+
+  this->ui->fftPanel->setSpectrumLogEnabled(false);
+  this->onSpectrumLogChanged();
+}
+
+// Replay feeds the spectrum directly, so it would fight a running capture
+void
+UIMediator::onReplayChanged(void)
+{
+  QString path;
+
+  if (!this->ui->fftPanel->getReplaying()) {
+    if (this->player.isPlaying()) {
+      this->player.stop();
+      this->onReplayFinished();
+    }
+    return;
+  }
+
+  if (this->state != HALTED) {
+    QMessageBox::warning(
+          this->ui->fftPanel,
+          "Spectrum log",
+          "Stop the capture before replaying a spectrum log.",
+          QMessageBox::Ok);
+    this->ui->fftPanel->setReplaying(false);
+    return;
+  }
+
+  path = QFileDialog::getOpenFileName(
+        this->ui->fftPanel,
+        "Replay spectrum log",
+        QString::fromStdString(this->ui->fftPanel->getSpectrumLogFolder()),
+        "Spectrum logs (*.sslog);;All files (*)");
+
+  if (path.isEmpty()) {
+    this->ui->fftPanel->setReplaying(false);
+    return;
+  }
+
+  this->player.setSpeed(this->ui->fftPanel->getReplaySpeed());
+
+  if (!this->player.open(path)) {
+    QMessageBox::critical(
+          this->ui->fftPanel,
+          "Spectrum log",
+          this->player.getLastError(),
+          QMessageBox::Close);
+    this->ui->fftPanel->setReplaying(false);
+  }
+}
+
+void
+UIMediator::onReplayFrame(
+    float *data,
+    int size,
+    qint64 fc,
+    unsigned int rate,
+    qint64)
+{
+  if (this->ui->spectrum->getCenterFreq() != fc)
+    this->ui->spectrum->setCenterFreq(fc);
+  this->ui->spectrum->setSampleRate(rate);
+  this->ui->spectrum->feed(data, size);
+}
+
+// Back to the tuning of the current profile
+void
+UIMediator::onReplayFinished(void)
+{
+  this->ui->fftPanel->setReplaying(false);
+  this->ui->spectrum->setCenterFreq(
+        static_cast<qint64>(this->appConfig->profile.getFreq()));
+  if (this->rate > 0)
+    this->ui->spectrum->setSampleRate(this->rate);
+}
+
+//
+// Only the PSD is copied here. Waterfall rows are left in the history
+// and copied by it only if they are about to be overwritten before the
+// exporter gets to them.
+//
+void
+UIMediator::onTriggerSnapshot(bool)
+{
+  SpectrumSnapshot snapshot;
+  unsigned int span = this->ui->fftPanel->getTimeSpan();
+  uint64_t begin, end;
+  QString path;
+
+  if (this->snapshotExporter.isBusy()) {
+    QMessageBox::information(
+          this->owner,
+          "Export snapshot",
+          "The previous snapshot is still being written.",
+          QMessageBox::Ok);
+    return;
+  }
+
+  if (this->averager.size() == 0) {
+    QMessageBox::information(
+          this->owner,
+          "Export snapshot",
+          "There is no spectrum to export yet.",
+          QMessageBox::Ok);
+    return;
+  }
+
+  path = QFileDialog::getSaveFileName(
+        this->owner,
+        "Export snapshot",
+        QString(),
+        "PNG images (*.png)");
+
+  if (path.isEmpty())
+    return;
+
+  if (!path.endsWith(".png", Qt::CaseInsensitive))
+    path += ".png";
+
+  // Taken once the dialog is closed: what is on screen now
+  snapshot.psd.assign(
+        this->averager.get(),
+        this->averager.get() + this->averager.size());
+  snapshot.fc        = this->ui->spectrum->getCenterFreq();
+  snapshot.rate      = this->rate;
+  snapshot.timestamp = QDateTime::currentMSecsSinceEpoch() * 1000;
+  snapshot.psdMin    = this->ui->fftPanel->getPandRangeMin();
+  snapshot.psdMax    = this->ui->fftPanel->getPandRangeMax();
+  snapshot.wfMin     = this->ui->fftPanel->getWfRangeMin();
+  snapshot.wfMax     = this->ui->fftPanel->getWfRangeMax();
+
+  // The rows of the waterfall time span, or a screenful in auto
+  if (this->history != nullptr && this->history->getEnd() > 0) {
+    end = this->history->getEnd();
+
+    if (span == 0)
+      begin = end > SIGDIGGER_SNAPSHOT_AUTO_ROWS
+          ? end - SIGDIGGER_SNAPSHOT_AUTO_ROWS
+          : 0;
+    else
+      begin = this->history->findRow(
+            this->history->getRow(end - 1)->timestamp
+            - static_cast<int64_t>(span) * 1000000);
+
+    if (end - begin > SIGDIGGER_SNAPSHOT_MAX_ROWS)
+      begin = end - SIGDIGGER_SNAPSHOT_MAX_ROWS;
+
+    snapshot.waterfall = this->history->snapshot(begin, end);
+  }
+
+  this->snapshotExporter.exportTo(
+        snapshot,
+        path,
+        this->ui->fftPanel->getSelectedPalette());
+}
+
+void
+UIMediator::onSnapshotFinished(QString path, QString error)
+{
+  if (!error.isEmpty())
+    QMessageBox::critical(
+          this->owner,
+          "Export snapshot",
+          "Snapshot could not be written to " + path + ": " + error,
+          QMessageBox::Ok);
+}
+
+void
+UIMediator::onTrackPeaks(void)
+{
+  this->ui->peakDialog->setTracker(&this->peakTracker);
+  this->ui->peakDialog->setNoiseFloor(&this->noiseFloor);
+  this->ui->peakDialog->show();
+  this->ui->peakDialog->raise();
+}
+
+void
+UIMediator::onAutoRange(void)
+{
+  float floor;
+
+  if (!this->noiseFloor.isValid())
+    return;
+
+  floor = std::round(this->noiseFloor.getFloor());
+
+  this->ui->fftPanel->setPandRangeMin(floor - SIGDIGGER_AUTO_RANGE_BELOW);
+  this->ui->fftPanel->setPandRangeMax(floor + SIGDIGGER_AUTO_RANGE_PAND);
+  this->ui->fftPanel->setWfRangeMin(floor - SIGDIGGER_AUTO_RANGE_BELOW);
+  this->ui->fftPanel->setWfRangeMax(floor + SIGDIGGER_AUTO_RANGE_WF);
+
+  this->onRangesChanged();
+}
+
+void
+UIMediator::onTunePeak(qint64 freq)
+{
+  qint64 lo = freq - this->ui->spectrum->getCenterFreq();
+  qint64 half = this->rate / 2;
+
+  if (lo >= -half && lo <= half) {
+    this->ui->spectrum->setLoFreq(lo);
+    this->onLoChanged(lo);
+  }
+}
@@ -18,6 +18,9 @@
 //
 
 #include "UIMediator.h"
+#include <QDateTime>
+#include <QDir>
+#include <QMessageBox>
 
 using namespace SigDigger;
 
@@ -59,6 +62,60 @@ UIMediator::connectSpectrum(void)
         SIGNAL(zoomChanged(float)),
         this,
         SLOT(onZoomChanged(float)));
+
+  connect(
+        this->ui->bandMeterDialog,
+        SIGNAL(addBand(void)),
+        this,
+        SLOT(onAddBandMeter(void)));
+
+  connect(
+        this->ui->bandMeterDialog,
+        SIGNAL(bandsChanged(void)),
+        this,
+        SLOT(onBandMetersChanged(void)));
+
+  connect(
+        this->ui->alertDialog,
+        SIGNAL(addRule(void)),
+        this,
+        SLOT(onAddAlertRule(void)));
+
+  connect(
+        this->ui->alertDialog,
+        SIGNAL(rulesChanged(void)),
+        this,
+        SLOT(onAlertRulesChanged(void)));
+
+  connect(
+        this->ui->alertDialog,
+        SIGNAL(settingsChanged(void)),
+        this,
+        SLOT(onAlertSettingsChanged(void)));
+
+  connect(
+        this->ui->bookmarkDialog,
+        SIGNAL(addBookmark(QString)),
+        this,
+        SLOT(onAddBookmark(QString)));
+
+  connect(
+        this->ui->bookmarkDialog,
+        SIGNAL(bookmarksChanged(void)),
+        this,
+        SLOT(onBookmarksChanged(void)));
+
+  connect(
+        this->ui->bookmarkDialog,
+        SIGNAL(tune(qint64)),
+        this,
+        SLOT(onTuneBookmark(qint64)));
+
+  connect(
+        this->ui->spectrum,
+        SIGNAL(bookmarkSelected(qint64)),
+        this,
+        SLOT(onTuneBookmark(qint64)));
 }
 
 void
@@ -103,6 +160,7 @@ UIMediator::onRangeChanged(float min, float max)
 
   if (this->ui->fftPanel->getRangeLock()) {
     this->ui->spectrum->setWfRange(min, max);
+    this->ui->historyDialog->setRange(min, max);
     this->ui->fftPanel->setWfRangeMin(static_cast<int>(min));
     this->ui->fftPanel->setWfRangeMax(static_cast<int>(max));
   }
@@ -113,3 +171,216 @@ UIMediator::onZoomChanged(float level)
 {
   this->ui->fftPanel->setFreqZoom(static_cast<int>(level));
 }
+
+void
+UIMediator::onAddBandMeter(void)
+{
+  std::vector<BandMeterBand> &bands = this->appConfig->bandMeters.bands;
+  BandMeterBand band;
+
+  if (bands.size() >= SIGDIGGER_BAND_METER_MAX_BANDS)
+    return;
+
+  // Over the current channel
+  band.name = "Band " + std::to_string(bands.size() + 1);
+  band.freq = this->ui->spectrum->getCenterFreq()
+      + this->ui->spectrum->getLoFreq();
+  band.bandwidth = this->ui->spectrum->getBandwidth();
+
+  if (band.bandwidth <= 0)
+    return;
+
+  bands.push_back(band);
+
+  this->ui->bandMeterDialog->setBands(bands);
+  this->bandMeter.setBands(bands);
+  this->ui->spectrum->setBandMeter(&this->bandMeter);
+}
+
+void
+UIMediator::onBandMetersChanged(void)
+{
+  this->appConfig->bandMeters.bands = this->ui->bandMeterDialog->getBands();
+  this->bandMeter.setBands(this->appConfig->bandMeters.bands);
+  this->ui->spectrum->setBandMeter(&this->bandMeter);
+}
+
+void
+UIMediator::applyAlertSettings(void)
+{
+  AlertConfig const &config = this->appConfig->alerts;
+  QString error;
+
+  this->alerts.setHoldoff(static_cast<qint64>(config.holdoff) * 1000);
+
+  if (!this->notifier.setLogFile(config.logPath))
+    error = QString::fromStdString(this->notifier.getLastError());
+
+  if (!this->notifier.setTarget(config.notify))
+    error = QString::fromStdString(this->notifier.getLastError());
+
+  this->ui->alertDialog->setError(error);
+}
+
+//
+// Rules asking for a recording start the capture to disk when the first
+// of them is raised, unless a capture was already running, and stop it
+// once none of them is.
+//
+void
+UIMediator::feedAlerts(const Suscan::PSDMessage &msg)
+{
+  std::vector<AlertEvent> const &events = this->alerts.feed(
+        msg.get(),
+        this->noiseFloor.getTrace(),
+        msg.size(),
+        this->ui->spectrum->getCenterFreq(),
+        msg.getSampleRate(),
+        QDateTime::currentMSecsSinceEpoch());
+  bool recordRaised = this->alerts.isRecordRaised();
+
+  for (auto const &event : events) {
+    std::string line = AlertNotifier::format(
+          event,
+          this->alerts.getRules()[event.rule]);
+
+    this->notifier.notify(line);
+    this->ui->alertDialog->addEvent(QString::fromStdString(line).trimmed());
+  }
+
+  if (!events.empty() && !this->notifier.getLastError().empty())
+    this->ui->alertDialog->setError(
+          QString::fromStdString(this->notifier.getLastError()));
+
+  if (recordRaised != this->alertRecordRaised) {
+    this->alertRecordRaised = recordRaised;
+
+    if (recordRaised && !this->ui->sourcePanel->getRecordState()) {
+      this->alertRecording = true;
+      this->setRecordState(true);
+      emit toggleRecord();
+    } else if (!recordRaised && this->alertRecording) {
+      this->alertRecording = false;
+      if (this->ui->sourcePanel->getRecordState()) {
+        this->setRecordState(false);
+        emit toggleRecord();
+      }
+    }
+  }
+}
+
+void
+UIMediator::onAddAlertRule(void)
+{
+  std::vector<AlertRule> &rules = this->appConfig->alerts.rules;
+  AlertRule rule;
+
+  if (rules.size() >= SIGDIGGER_ALERT_MAX_RULES)
+    return;
+
+  // Over the current channel
+  rule.name = "Alert " + std::to_string(rules.size() + 1);
+  rule.freq = this->ui->spectrum->getCenterFreq()
+      + this->ui->spectrum->getLoFreq();
+  rule.bandwidth = this->ui->spectrum->getBandwidth();
+
+  if (rule.bandwidth <= 0)
+    return;
+
+  rules.push_back(rule);
+
+  this->ui->alertDialog->setRules(rules);
+  this->alerts.setRules(rules);
+}
+
+void
+UIMediator::onAlertRulesChanged(void)
+{
+  this->appConfig->alerts.rules = this->ui->alertDialog->getRules();
+  this->alerts.setRules(this->appConfig->alerts.rules);
+}
+
+void
+UIMediator::onAlertSettingsChanged(void)
+{
+  AlertConfig &config = this->appConfig->alerts;
+  std::string logPath = this->ui->alertDialog->getLogPath().toStdString();
+  std::string notify = this->ui->alertDialog->getNotifyTarget().toStdString();
+  bool reopen = logPath != config.logPath || notify != config.notify;
+
+  config.enabled = this->ui->alertDialog->getAlertsEnabled();
+  config.holdoff = this->ui->alertDialog->getHoldoff();
+  config.logPath = logPath;
+  config.notify  = notify;
+
+  // Nothing will clear the rules that started a capture
+  if (!config.enabled && this->alertRecordRaised) {
+    this->alertRecordRaised = false;
+    if (this->alertRecording && this->ui->sourcePanel->getRecordState()) {
+      this->setRecordState(false);
+      emit toggleRecord();
+    }
+    this->alertRecording = false;
+  }
+
+  // Editing a field and leaving it as it was does not reopen anything
+  if (reopen)
+    this->applyAlertSettings();
+  else
+    this->alerts.setHoldoff(static_cast<qint64>(config.holdoff) * 1000);
+}
+
+QString
+UIMediator::getBookmarksPath(void)
+{
+  return QDir::homePath() + "/.suscan/" SIGDIGGER_BOOKMARKS_FILE;
+}
+
+void
+UIMediator::onAddBookmark(QString name)
+{
+  Bookmark bookmark;
+
+  // At the current channel
+  bookmark.name = name.toStdString();
+  bookmark.lo = this->ui->spectrum->getCenterFreq()
+      + this->ui->spectrum->getLoFreq();
+  bookmark.hi = bookmark.lo;
+
+  this->bookmarks.add(bookmark);
+  this->onBookmarksChanged();
+}
+
+void
+UIMediator::onBookmarksChanged(void)
+{
+  QString error;
+
+  this->ui->bookmarkDialog->refresh();
+  this->ui->spectrum->setBookmarks(&this->bookmarks);
+
+  if (!this->bookmarks.save(getBookmarksPath(), error))
+    QMessageBox::critical(
+          this->owner,
+          "Cannot save bookmarks",
+          "Bookmarks could not be saved to "
+          + getBookmarksPath()
+          + ": "
+          + error,
+          QMessageBox::Ok);
+}
+
+// Retunes the center frequency if the bookmark is out of the span
+void
+UIMediator::onTuneBookmark(qint64 freq)
+{
+  qint64 half = this->rate / 2;
+
+  if (freq - this->ui->spectrum->getCenterFreq() < -half
+      || freq - this->ui->spectrum->getCenterFreq() > half) {
+    this->ui->spectrum->setCenterFreq(freq);
+    this->onFrequencyChanged(freq);
+  }
+
+  this->onTunePeak(freq);
+}
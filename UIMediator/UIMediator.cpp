@@ -27,8 +27,10 @@
 #include <QDockWidget>
 #include <QMessageBox>
 #include <QScreen>
+#include <QDateTime>
 
 #include <fstream>
+#include <cmath>
 
 using namespace SigDigger;
 
@@ -289,6 +291,41 @@ UIMediator::onTriggerDevices(bool)
   this->ui->deviceDialog->run();
 }
 
+void
+UIMediator::onTriggerBandMeters(bool)
+{
+  this->ui->bandMeterDialog->show();
+  this->ui->bandMeterDialog->raise();
+}
+
+void
+UIMediator::onTriggerOccupancy(bool)
+{
+  this->ui->occupancyDialog->show();
+  this->ui->occupancyDialog->raise();
+}
+
+void
+UIMediator::onTriggerReference(bool)
+{
+  this->ui->referenceDialog->show();
+  this->ui->referenceDialog->raise();
+}
+
+void
+UIMediator::onTriggerAlerts(bool)
+{
+  this->ui->alertDialog->show();
+  this->ui->alertDialog->raise();
+}
+
+void
+UIMediator::onTriggerBookmarks(bool)
+{
+  this->ui->bookmarkDialog->show();
+  this->ui->bookmarkDialog->raise();
+}
+
 void
 UIMediator::onTriggerClear(bool)
 {
@@ -339,12 +376,54 @@ UIMediator::connectMainWindow(void)
         this,
         SLOT(onTriggerExport(bool)));
 
+  connect(
+        this->ui->main->actionExportSnapshot,
+        SIGNAL(triggered(bool)),
+        this,
+        SLOT(onTriggerSnapshot(bool)));
+
+  connect(
+        &this->snapshotExporter,
+        SIGNAL(finished(QString, QString)),
+        this,
+        SLOT(onSnapshotFinished(QString, QString)));
+
   connect(
         this->ui->main->actionDevices,
         SIGNAL(triggered(bool)),
         this,
         SLOT(onTriggerDevices(bool)));
 
+  connect(
+        this->ui->main->actionBandMeters,
+        SIGNAL(triggered(bool)),
+        this,
+        SLOT(onTriggerBandMeters(bool)));
+
+  connect(
+        this->ui->main->actionOccupancy,
+        SIGNAL(triggered(bool)),
+        this,
+        SLOT(onTriggerOccupancy(bool)));
+
+  connect(
+        this->ui->main->actionReference,
+        SIGNAL(triggered(bool)),
+        this,
+        SLOT(onTriggerReference(bool)));
+
+  connect(
+        this->ui->main->actionAlerts,
+        SIGNAL(triggered(bool)),
+        this,
+        SLOT(onTriggerAlerts(bool)));
+
+  connect(
+        this->ui->main->actionBookmarks,
+        SIGNAL(triggered(bool)),
+        this,
+        SLOT(onTriggerBookmarks(bool)));
+
   connect(
         this->ui->main->actionStart_capture,
         SIGNAL(triggered(bool)),
@@ -439,9 +518,16 @@ UIMediator::setBandwidth(unsigned int bw)
 void
 UIMediator::setProcessRate(unsigned int rate)
 {
+  this->processRate = rate;
   this->ui->sourcePanel->setProcessRate(rate);
 }
 
+void
+UIMediator::setMessageBacklog(unsigned int pending)
+{
+  this->backlog = pending;
+}
+
 void
 UIMediator::setSampleRate(unsigned int rate)
 {
@@ -462,6 +548,8 @@ UIMediator::setSampleRate(unsigned int rate)
 
     this->ui->audioPanel->setBandwidth(static_cast<float>(audioBw));
     this->rate = rate;
+
+    this->updateZoomSpectrum();
   }
 }
 
@@ -470,6 +558,10 @@ UIMediator::setState(State state)
 {
   this->state = state;
   this->refreshUI();
+  this->updateZoomSpectrum();
+
+  // Time without PSDs does not count as idle time
+  this->governorClock.invalidate();
 }
 
 UIMediator::State
@@ -488,11 +580,211 @@ UIMediator::refreshDevicesDone(void)
 void
 UIMediator::feedPSD(const Suscan::PSDMessage &msg)
 {
+  QElapsedTimer timer;
+  float *frame;
+
+  timer.start();
+
+  if (this->player.isPlaying()) {
+    this->player.stop();
+    this->onReplayFinished();
+  }
+
   this->setSampleRate(msg.getSampleRate());
   this->averager.feed(msg);
+  this->displayAverager.feed(msg.getDisplay(), msg.getDisplaySize());
+  this->noiseFloor.feed(msg);
+  this->ui->spectrum->setNoiseFloor(
+        this->noiseFloor.getTrace(),
+        static_cast<int>(this->noiseFloor.size()));
+
+  // Raw frames: the capture is an average of its own
+  if (this->reference.isCapturing())
+    this->reference.feed(
+          msg.get(),
+          msg.size(),
+          this->ui->spectrum->getCenterFreq(),
+          msg.getSampleRate(),
+          QDateTime::currentMSecsSinceEpoch());
+
+  // Only the spectrum shows the difference, the rest wants levels. The
+  // spectrum is also the only one painting the decimated PSD: everything
+  // below works on the full resolution one.
+  frame = this->displayAverager.get();
+  if (this->ui->referenceDialog->isDiffEnabled()) {
+    // The reference was captured at full resolution, and so is the
+    // difference. Only then is it reduced to the display bins, by the
+    // same detector that reduced the levels.
+    frame = this->reference.diff(
+          this->averager.get(),
+          this->averager.size(),
+          this->ui->spectrum->getCenterFreq(),
+          msg.getSampleRate());
+    if (this->displayAverager.size() < this->averager.size()) {
+      if (this->displayDiff.size() < this->displayAverager.size())
+        this->displayDiff.resize(this->displayAverager.size());
+      Suscan::PSDMessage::decimate(
+            frame,
+            this->averager.size(),
+            this->displayDiff.data(),
+            this->displayAverager.size(),
+            this->ui->fftPanel->getDetector());
+      frame = this->displayDiff.data();
+    }
+    this->ui->spectrum->setReferenceDiff(
+          frame,
+          static_cast<int>(this->displayAverager.size()),
+          this->reference.getThreshold());
+  } else {
+    this->ui->spectrum->setReferenceDiff(nullptr, 0, 0);
+  }
+
   this->ui->spectrum->feed(
+        frame,
+        static_cast<int>(this->displayAverager.size()));
+
+  this->bandMeter.feed(
+        this->averager.get(),
+        this->averager.size(),
+        this->ui->spectrum->getCenterFreq(),
+        msg.getSampleRate(),
+        QDateTime::currentMSecsSinceEpoch());
+
+  if (this->appConfig->alerts.enabled)
+    this->feedAlerts(msg);
+
+  // Raw frames: averaging would smear short bursts over time
+  if (this->ui->occupancyDialog->isRunning())
+    this->occupancy.feed(
+          msg.get(),
+          this->noiseFloor.getTrace(),
+          msg.size(),
+          this->ui->spectrum->getCenterFreq(),
+          msg.getSampleRate(),
+          QDateTime::currentMSecsSinceEpoch());
+
+  // Tracked whether the list is shown or not, so peak lifetimes and
+  // drifts stay true across hiding and showing it
+  this->peakTracker.feed(
         this->averager.get(),
-        static_cast<int>(this->averager.size()));
+        this->noiseFloor.getTrace(),
+        this->averager.size(),
+        this->ui->spectrum->getCenterFreq(),
+        msg.getSampleRate(),
+        QDateTime::currentMSecsSinceEpoch());
+
+  if (this->spectrumLog != nullptr)
+    this->spectrumLog->feed(
+          this->averager.get(),
+          this->averager.size(),
+          this->ui->spectrum->getCenterFreq(),
+          msg.getSampleRate(),
+          QDateTime::currentMSecsSinceEpoch() * 1000);
+
+  if (this->history != nullptr)
+    this->history->append(
+          this->averager.get(),
+          this->averager.size(),
+          this->ui->spectrum->getCenterFreq(),
+          msg.getSampleRate(),
+          QDateTime::currentMSecsSinceEpoch() * 1000);
+
+  this->feedNs += timer.nsecsElapsed();
+
+  if (this->autoFft)
+    this->updateGovernor();
+}
+
+//
+// GUI thread load is the time spent in feedPSD and painting the
+// spectrum, over the wall time between evaluations. Everything else
+// the GUI thread does is out of our hands.
+//
+void
+UIMediator::updateGovernor(void)
+{
+  static const char *reasons[] = {
+    "",
+    "analyzer behind",
+    "GUI backlog",
+    "GUI load",
+    "headroom"
+  };
+  qint64 elapsed, renderNs;
+  qreal processed = 1, load;
+  QString reason;
+
+  if (!this->governorClock.isValid()) {
+    this->governorClock.start();
+    this->feedNs = 0;
+    this->lastRenderNs = this->ui->spectrum->getRenderTime();
+    return;
+  }
+
+  elapsed = this->governorClock.elapsed();
+  if (elapsed < SIGDIGGER_FFT_GOVERNOR_PERIOD_MS)
+    return;
+
+  renderNs = this->ui->spectrum->getRenderTime();
+  load = 1e-6 * (this->feedNs + renderNs - this->lastRenderNs) / elapsed;
+
+  if (this->rate > 0)
+    processed = static_cast<qreal>(this->processRate) / this->rate;
+
+  this->governorClock.restart();
+  this->feedNs = 0;
+  this->lastRenderNs = renderNs;
+
+  if (this->governor.update(processed, load, this->backlog))
+    emit analyzerParamsChanged();
+
+  reason = reasons[this->governor.getReason()];
+  if (this->governor.getLevel() == 0)
+    reason = "";
+
+  this->ui->fftPanel->setGovernorDecision(
+        this->governor.getFftSize(),
+        this->governor.getRefreshRate(),
+        (reason.isEmpty() ? "" : reason + ", ")
+        + "GUI "
+        + QString::number(qRound(100 * load))
+        + "%");
+}
+
+//
+// Zoom spectrum frames only land here while the span they were opened
+// for is still wanted. Until the first frame of a new span arrives, the
+// full-span PSD is painted instead.
+//
+void
+UIMediator::feedZoomSpectrum(const float *power, size_t size, unsigned int rate)
+{
+  if (this->zoomSpan == 0 || size == 0)
+    return;
+
+  this->zoomSpectrum.feed(power, size, rate);
+  this->ui->spectrum->feedZoomSpectrum(
+        this->zoomSpectrum.get(),
+        static_cast<int>(this->zoomSpectrum.size()),
+        this->zoomSpectrum.getRate());
+}
+
+void
+UIMediator::updateZoomSpectrum(void)
+{
+  unsigned int span = 0;
+
+  if (this->state == RUNNING && this->ui->fftPanel->getZoomSpectrum())
+    span = ZoomSpectrum::getSpan(
+          this->rate,
+          this->ui->fftPanel->getFreqZoom());
+
+  if (span != this->zoomSpan) {
+    this->zoomSpan = span;
+    this->zoomSpectrum.reset();
+    this->ui->spectrum->leaveZoomSpectrum();
+    emit zoomSpectrumChanged();
+  }
 }
 
 void
@@ -600,12 +892,45 @@ UIMediator::getAnalyzerParams(void) const
   return &this->appConfig->analyzerParams;
 }
 
+Suscan::AnalyzerParams *
+UIMediator::getEffectiveParams(void)
+{
+  Suscan::AnalyzerParams const &params = this->appConfig->analyzerParams;
+  unsigned int rate = 0;
+
+  this->effectiveParams = params;
+
+  if (params.psdUpdateInterval > 0)
+    rate = static_cast<unsigned int>(std::round(1.f / params.psdUpdateInterval));
+
+  if (this->autoFft && rate > 0) {
+    this->governor.setLimits(params.windowSize, rate);
+    this->effectiveParams.windowSize = this->governor.getFftSize();
+    this->effectiveParams.psdUpdateInterval =
+        1.f / this->governor.getRefreshRate();
+  }
+
+  return &this->effectiveParams;
+}
+
 unsigned int
 UIMediator::getFftSize(void) const
 {
   return this->appConfig->analyzerParams.windowSize;
 }
 
+std::vector<unsigned int> const &
+UIMediator::getFftSizes(void) const
+{
+  return this->ui->fftPanel->getFftSizes();
+}
+
+unsigned int
+UIMediator::getZoomSpectrumSpan(void) const
+{
+  return this->zoomSpan;
+}
+
 Suscan::Serializable *
 UIMediator::allocConfig(void)
 {
@@ -663,11 +988,36 @@ UIMediator::applyConfig(void)
   if (savedBw > 0)
     this->setBandwidth(savedBw);
 
+  this->bandMeter.setBands(this->appConfig->bandMeters.bands);
+  this->ui->bandMeterDialog->setMeter(&this->bandMeter);
+  this->ui->occupancyDialog->setOccupancy(&this->occupancy);
+  this->ui->referenceDialog->setReference(&this->reference);
+  this->ui->bandMeterDialog->setBands(this->appConfig->bandMeters.bands);
+  this->ui->spectrum->setBandMeter(&this->bandMeter);
+
+  this->alerts.setRules(this->appConfig->alerts.rules);
+  this->ui->alertDialog->setEngine(&this->alerts);
+  this->ui->alertDialog->setRules(this->appConfig->alerts.rules);
+  this->ui->alertDialog->setAlertsEnabled(this->appConfig->alerts.enabled);
+  this->ui->alertDialog->setLogPath(
+        QString::fromStdString(this->appConfig->alerts.logPath));
+  this->ui->alertDialog->setNotifyTarget(
+        QString::fromStdString(this->appConfig->alerts.notify));
+  this->ui->alertDialog->setHoldoff(this->appConfig->alerts.holdoff);
+  this->applyAlertSettings();
+
+  this->bookmarks.load(getBookmarksPath());
+  this->ui->bookmarkDialog->setStore(&this->bookmarks);
+  this->ui->spectrum->setBookmarks(&this->bookmarks);
+
   // Artificially trigger slots to synchronize UI
   this->onPaletteChanged();
   this->onRangesChanged();
   this->onAveragerChanged();
+  this->onPersistenceChanged();
+  this->onAutoFftChanged();
   this->onThrottleConfigChanged();
+  this->onHistoryChanged();
   this->onTimeSpanChanged();
 }
 
@@ -0,0 +1,59 @@
+//
+//    AlertConfig.h: Band alert rules
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+
+#ifndef ALERTCONFIG_H
+#define ALERTCONFIG_H
+
+#include <Suscan/Serializable.h>
+#include <QtGlobal>
+#include <string>
+#include <vector>
+
+#define SIGDIGGER_ALERT_MAX_RULES 1024
+
+namespace SigDigger {
+  struct AlertRule {
+    std::string name;
+    qint64 freq = 0;           // Center, absolute (Hz)
+    qint64 bandwidth = 0;      // Hz
+    float threshold = 10;      // dB
+    bool relative = true;      // Threshold above the noise floor
+    unsigned int duration = 0; // ms above the threshold before alerting
+    bool record = false;       // Start a capture when raised
+  };
+
+  class AlertConfig : public Suscan::Serializable {
+    public:
+      std::vector<AlertRule> rules;
+      bool enabled = false;
+      std::string logPath;       // Empty: no log
+      std::string notify;        // udp:host:port, unix:path or empty
+      unsigned int holdoff = 60; // s between alerts of the same rule
+
+      AlertConfig();
+      AlertConfig(Suscan::Object const &conf);
+
+      // Overriden methods
+      void deserialize(Suscan::Object const &conf) override;
+      Suscan::Object &&serialize(void) override;
+  };
+}
+
+#endif // ALERTCONFIG_H
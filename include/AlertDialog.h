@@ -0,0 +1,94 @@
+//
+//    AlertDialog.h: Band alert rules and recent alerts
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+
+#ifndef ALERTDIALOG_H
+#define ALERTDIALOG_H
+
+#include <QDialog>
+#include <QTimer>
+
+#include "AlertEngine.h"
+
+// How often rule levels are refreshed (ms)
+#define SIGDIGGER_ALERT_DIALOG_REFRESH_MS 250
+
+// Recent alerts kept in the dialog
+#define SIGDIGGER_ALERT_DIALOG_HISTORY    200
+
+namespace Ui {
+  class AlertDialog;
+}
+
+namespace SigDigger {
+  //
+  // Editable list of alert rules with their current level, where alerts
+  // are sent and the last alerts raised. Rules are edited in place, as
+  // band meters are.
+  //
+  class AlertDialog : public QDialog
+  {
+    Q_OBJECT
+
+    const AlertEngine *engine = nullptr; // Weak
+    QTimer *refreshTimer = nullptr;
+
+    void connectAll(void);
+    void refreshUi(void);
+
+  public:
+    explicit AlertDialog(QWidget *parent = nullptr);
+    ~AlertDialog() override;
+
+    void setEngine(const AlertEngine *engine);
+    void setRules(std::vector<AlertRule> const &rules);
+    std::vector<AlertRule> getRules(void) const;
+
+    void setAlertsEnabled(bool enabled);
+    void setLogPath(QString const &path);
+    void setNotifyTarget(QString const &target);
+    void setHoldoff(unsigned int seconds);
+    void setError(QString const &error);
+    void addEvent(QString const &line);
+
+    bool getAlertsEnabled(void) const;
+    QString getLogPath(void) const;
+    QString getNotifyTarget(void) const;
+    unsigned int getHoldoff(void) const;
+
+  public slots:
+    void onRefresh(void);
+    void onItemChanged(void);
+    void onSelectionChanged(void);
+    void onAdd(void);
+    void onRemove(void);
+    void onBrowseLog(void);
+    void onSettingsChanged(void);
+
+  signals:
+    void addRule(void);
+    void rulesChanged(void);
+    void settingsChanged(void);
+
+  private:
+    Ui::AlertDialog *ui = nullptr;
+  };
+}
+
+#endif // ALERTDIALOG_H
@@ -0,0 +1,144 @@
+//
+//    AlertEngine.h: Band threshold alerts
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+
+#ifndef ALERTENGINE_H
+#define ALERTENGINE_H
+
+#include <QtGlobal>
+#include <vector>
+
+#include "AlertConfig.h"
+
+// Notifications allowed in a burst, and refilled per minute
+#define SIGDIGGER_ALERT_BURST       10
+#define SIGDIGGER_ALERT_PER_MINUTE  30
+
+namespace SigDigger {
+  struct AlertEvent {
+    enum Type {
+      RAISED,
+      CLEARED
+    };
+
+    Type type;
+    size_t rule;
+    qint64 time;     // ms since epoch
+    float level;     // Peak in the band, relative if the rule is
+  };
+
+  //
+  // Evaluates threshold rules over bands on every PSD. Rule edges split
+  // the spectrum into elementary segments, and each rule is the range of
+  // segments it spans. A frame costs one max-reduction per segment that
+  // is covered by some rule (bins outside all rules are not read) and a
+  // look at the segments of each rule: with hundreds of narrow rules this
+  // is far less than a pass per rule. The index is rebuilt only when the
+  // rules or the span change.
+  //
+  // A rule is raised after its peak stays above the threshold for its
+  // duration, and cleared when it falls below or leaves the span.
+  // Notifications are rate limited per rule (hold-off) and globally
+  // (token bucket); a raise that is not notified does not notify its
+  // clear either.
+  //
+  class AlertEngine {
+      struct RuleState {
+        bool inSpan = false;
+        bool raised = false;
+        bool notified = false;
+        qint64 since = -1;
+        qint64 lastNotified = -1;
+        float level = 0;
+        unsigned int first = 0;  // Segments [first, last)
+        unsigned int last = 0;
+      };
+
+      std::vector<AlertRule> rules;
+      std::vector<RuleState> states;
+      qint64 holdoff = 60000;
+
+      // Segment index
+      size_t bins = 0;
+      qint64 fc = 0;
+      unsigned int rate = 0;
+      std::vector<size_t> edges;      // Segment i is [edges[i], edges[i + 1])
+      std::vector<bool> covered;
+      std::vector<float> absMax;
+      std::vector<float> relMax;
+
+      float tokens = SIGDIGGER_ALERT_BURST;
+      qint64 lastRefill = -1;
+      quint64 suppressed = 0;
+
+      std::vector<AlertEvent> events;
+
+      void rebuild(size_t size, qint64 fc, unsigned int rate);
+      bool allow(RuleState &state, qint64 now);
+
+    public:
+      void setRules(std::vector<AlertRule> const &rules);
+      void setHoldoff(qint64 ms);
+
+      // Events of this frame, valid until the next call
+      std::vector<AlertEvent> const &feed(
+          const float *psd,
+          const float *floor,
+          size_t size,
+          qint64 fc,
+          unsigned int rate,
+          qint64 now);
+
+      std::vector<AlertRule> const &
+      getRules(void) const
+      {
+        return this->rules;
+      }
+
+      bool
+      isInSpan(size_t rule) const
+      {
+        return this->states[rule].inSpan;
+      }
+
+      bool
+      isRaised(size_t rule) const
+      {
+        return this->states[rule].raised;
+      }
+
+      float
+      getLevel(size_t rule) const
+      {
+        return this->states[rule].level;
+      }
+
+      // Some raised rule asks for a recording
+      bool isRecordRaised(void) const;
+
+      // Raises not notified because of either rate limit
+      quint64
+      getSuppressed(void) const
+      {
+        return this->suppressed;
+      }
+  };
+}
+
+#endif // ALERTENGINE_H
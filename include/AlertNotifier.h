@@ -0,0 +1,66 @@
+//
+//    AlertNotifier.h: Alert log and socket notifications
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+
+#ifndef ALERTNOTIFIER_H
+#define ALERTNOTIFIER_H
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <string>
+
+#include "AlertEngine.h"
+
+namespace SigDigger {
+  //
+  // Sends alert events as single text lines of key=value pairs to a log
+  // file (appended to) and to a local datagram socket, either UDP
+  // ("udp:host:port") or Unix ("unix:/path"). Sends never block: if
+  // nobody is listening, the datagram is simply lost.
+  //
+  class AlertNotifier {
+      int logFd = -1;
+      int sockFd = -1;
+      struct sockaddr_storage addr;
+      socklen_t addrLen = 0;
+      std::string lastError;
+
+      void closeLog(void);
+      void closeSocket(void);
+
+    public:
+      AlertNotifier();
+      ~AlertNotifier();
+
+      // Empty paths or targets turn the corresponding output off
+      bool setLogFile(std::string const &path);
+      bool setTarget(std::string const &target);
+
+      static std::string format(AlertEvent const &event, AlertRule const &rule);
+      void notify(std::string const &line);
+
+      std::string
+      getLastError(void) const
+      {
+        return this->lastError;
+      }
+  };
+}
+
+#endif // ALERTNOTIFIER_H
@@ -26,6 +26,8 @@
 #include <AppUI.h>
 
 #include "ColorConfig.h"
+#include "BandMeterConfig.h"
+#include "AlertConfig.h"
 
 #define SIGDIGGER_FFT_WINDOW_SIZE  4096u
 #define SIGDIGGER_FFT_REFRESH_RATE 25u
@@ -36,6 +38,30 @@
 #define SIGDIGGER_AUDIO_INSPECTOR_BANDWIDTH   200000
 #define SIGDIGGER_AUDIO_INSPECTOR_REQID       0xaaaaaaaa
 
+// Pinned audio channels (k = 1, 2...) get consecutive IDs. Their open
+// requests also carry the generation (g) of the set of channels they
+// belong to, so late replies to a set that was since reopened can be
+// told apart.
+#define SIGDIGGER_AUDIO_CHANNEL_MAGIC_ID(k) (SIGDIGGER_AUDIO_INSPECTOR_MAGIC_ID + (k))
+#define SIGDIGGER_AUDIO_CHANNEL_GENERATIONS 256
+#define SIGDIGGER_AUDIO_CHANNEL_REQID(g, k)                \
+  (SIGDIGGER_AUDIO_INSPECTOR_REQID                         \
+   + ((g) % SIGDIGGER_AUDIO_CHANNEL_GENERATIONS) * 256 + (k))
+#define SIGDIGGER_AUDIO_CHANNEL_REQID_GEN(id)              \
+  (((id) - SIGDIGGER_AUDIO_INSPECTOR_REQID) / 256)
+#define SIGDIGGER_AUDIO_CHANNEL_REQID_INDEX(id)            \
+  (((id) - SIGDIGGER_AUDIO_INSPECTOR_REQID) % 256)
+
+// Audio health refresh period (ms)
+#define SIGDIGGER_AUDIO_HEALTH_INTERVAL_MS 1000
+
+// Channel behind the high resolution zoom spectrum. Any inspector class
+// will do, it is only opened for its spectrum.
+#define SIGDIGGER_ZOOM_INSPECTOR_CLASS    "ask"
+#define SIGDIGGER_ZOOM_INSPECTOR_SOURCE   "psd"
+#define SIGDIGGER_ZOOM_INSPECTOR_MAGIC_ID 0x2003f77f
+#define SIGDIGGER_ZOOM_INSPECTOR_REQID    0xbbbbbbbb
+
 #define SIGDIGGER_PROFILE_FILE_MAX_SIZE       (1 << 20)
 
 namespace SigDigger {  
@@ -44,6 +70,8 @@ namespace SigDigger {
       Suscan::Source::Config profile;
       Suscan::AnalyzerParams analyzerParams;
       ColorConfig colors;
+      BandMeterConfig bandMeters;
+      AlertConfig alerts;
       Suscan::Serializable *sourceConfig = nullptr;
       Suscan::Serializable *fftConfig = nullptr;
       Suscan::Serializable *inspectorConfig = nullptr;
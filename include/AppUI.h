@@ -34,6 +34,13 @@
 #include "ui_MainWindow.h"
 #include "ConfigDialog.h"
 #include "DeviceDialog.h"
+#include "WaterfallHistoryView.h"
+#include "PeakTrackerDialog.h"
+#include "BandMeterDialog.h"
+#include "OccupancyDialog.h"
+#include "ReferenceDialog.h"
+#include "AlertDialog.h"
+#include "BookmarkDialog.h"
 
 namespace SigDigger {
   struct AppUI {
@@ -46,6 +53,13 @@ namespace SigDigger {
     FftPanel *fftPanel = nullptr;
     AudioPanel *audioPanel = nullptr;
     AboutDialog *aboutDialog = nullptr;
+    WaterfallHistoryDialog *historyDialog = nullptr;
+    PeakTrackerDialog *peakDialog = nullptr;
+    BandMeterDialog *bandMeterDialog = nullptr;
+    OccupancyDialog *occupancyDialog = nullptr;
+    ReferenceDialog *referenceDialog = nullptr;
+    AlertDialog *alertDialog = nullptr;
+    BookmarkDialog *bookmarkDialog = nullptr;
     std::map<Suscan::InspectorId, Inspector *> inspectorTable;
     Suscan::InspectorId lastId = 0;
 
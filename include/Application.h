@@ -22,12 +22,15 @@
 
 #include <Suscan/Source.h>
 #include <Suscan/Analyzer.h>
+#include <QTimer>
 
 /* Local includes */
 #include "AppConfig.h"
 #include "UIMediator.h"
 #include "AudioPlayback.h"
 #include "FileDataSaver.h"
+#include "AudioFileSaver.h"
+#include "FftwWisdom.h"
 
 namespace SigDigger {
   class DeviceDetectWorker : public QObject {
@@ -65,6 +68,7 @@ namespace SigDigger {
 
     // Audio
     std::unique_ptr<AudioPlayback> playBack = nullptr;
+    std::unique_ptr<AudioFileSaver> audioSaver = nullptr;
     Suscan::Handle audioInspHandle = 0;
     unsigned int audioSampleRate = 0;
     suscan_config_t *audioCfgTemplate = nullptr;
@@ -72,6 +76,24 @@ namespace SigDigger {
     bool audioConfigured = false;
     SUFREQ maxAudioBw = SIGDIGGER_AUDIO_INSPECTOR_BANDWIDTH;
     SUFREQ lastAudioLo = 0;
+    QTimer *audioHealthTimer = nullptr;
+
+    // Pinned audio channels, channel k is audioChannels[k - 1]
+    struct AudioChannel {
+      Suscan::Handle handle = 0;
+      bool opened = false;
+    };
+
+    std::vector<AudioChannel> audioChannels;
+    unsigned int audioChannelGeneration = 0;
+
+    // Zoom spectrum channel. One open request at a time: the span is
+    // checked again when its reply arrives.
+    Suscan::Handle zoomInspHandle = 0;
+    bool zoomInspectorOpened = false;
+    bool zoomUnavailable = false;
+    unsigned int zoomRequestedSpan = 0;
+    unsigned int zoomOpenSpan = 0;
 
     // Delayed audio parameters
     unsigned int delayedRate = 0;
@@ -79,6 +101,9 @@ namespace SigDigger {
     SUFLOAT delayedVolume = 0;
     unsigned int delayedDemod = 0;
 
+    // Measures the FFT sizes the user can pick in the background
+    FftwWisdom wisdom;
+
     // Rediscover devices
     QThread *deviceDetectThread;
     DeviceDetectWorker *deviceDetectWorker;
@@ -92,19 +117,33 @@ namespace SigDigger {
     int  openCaptureFile(void);
     void installDataSaver(int fd);
     void uninstallDataSaver(void);
+    void connectAudioSaver(void);
+    void installAudioSaver(void);
+    void uninstallAudioSaver(void);
     void setAudioInspectorParams(
         unsigned int rate,
         SUFLOAT cutOff,
         SUFLOAT volume,
         unsigned int demod);
+    void openAudioChannels(void);
+    void closeAudioChannels(void);
+    void reopenAudioChannels(void);
+    void configureAudioChannel(unsigned int index);
+    void assertAudioChannelsLo(void);
+    void updateAudioMix(void);
+    void audioChannelOpened(const Suscan::InspectorMessage &msg);
     SUFREQ getAudioInspectorLo(void) const;
     SUFREQ getAudioInspectorBandwidth(void) const;
     void   assertAudioInspectorLo(void);
+    void updateZoomInspector(void);
+    void zoomInspectorReady(const Suscan::InspectorMessage &msg);
+    void resetZoomInspector(void);
 
   public:
     // Application methods
     Suscan::Object &&getConfig(void);
     void refreshConfig(void);
+    void saveWisdom(void);
     void run(Suscan::Object const &config);
 
     void updateRecent(void);
@@ -144,6 +183,12 @@ namespace SigDigger {
     void onLoChanged(qint64);
     void onChannelBandwidthChanged(qreal);
     void onAudioChanged(void);
+    void onToggleAudioRecord(void);
+    void onPinAudioChannel(void);
+    void onAudioChannelsChanged(void);
+    void onAudioMixChanged(void);
+    void onAudioHealthTimer(void);
+    void onZoomSpectrumChanged(void);
     void onAntennaChanged(QString antenna);
     void onBandwidthChanged(void);
     void onDeviceRefresh(void);
@@ -165,6 +210,12 @@ namespace SigDigger {
     void onSaveRate(qreal rate);
     void onCommit(void);
 
+    // Audio saver slots
+    void onAudioSaveError(void);
+    void onAudioSaveSwamped(void);
+    void onAudioSaveRate(qreal rate);
+    void onAudioCommit(void);
+
     // Device detect slots
     void onDetectFinished(void);
   };
@@ -0,0 +1,196 @@
+//
+//    AudioBackend.h: Audio output backends
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+#ifndef AUDIOBACKEND_H
+#define AUDIOBACKEND_H
+
+#include <string>
+#include <cstdio>
+#include <cstdint>
+#include <atomic>
+#include <sys/time.h>
+
+#ifdef SIGDIGGER_HAVE_ALSA
+#  include <alsa/asoundlib.h>
+#endif // SIGDIGGER_HAVE_ALSA
+
+#ifdef SIGDIGGER_HAVE_PULSEAUDIO
+#  include <pulse/simple.h>
+#endif // SIGDIGGER_HAVE_PULSEAUDIO
+
+//
+// Device specifications understood by AudioBackend::make:
+//
+//   default          First available soundcard backend (ALSA, then Pulse)
+//   alsa[:pcm]       ALSA PCM device (defaults to "default")
+//   pulse[:sink]     PulseAudio / PipeWire sink (defaults to server default)
+//   wav:path         WAV file, written as fast as samples arrive
+//   wav+clock:path   WAV file, throttled to wall-clock speed
+//
+// A path of "-" sends the WAV stream to the standard output.
+//
+
+#define SIGDIGGER_WAV_HEADER_SIZE    44
+#define SIGDIGGER_WAV_UNKNOWN_LENGTH 0xffffffffu
+
+namespace SigDigger {
+  enum AudioFormat {
+    AUDIO_FORMAT_FLOAT32,
+    AUDIO_FORMAT_S16,
+    AUDIO_FORMAT_S32
+  };
+
+  // Canonical 44-byte RIFF/WAVE header. Lengths are in bytes.
+  void composeWavHeader(
+      uint8_t *hdr,
+      unsigned int rate,
+      unsigned int channels,
+      AudioFormat format,
+      uint32_t dataLen);
+
+  class AudioBackend {
+    protected:
+      unsigned int sampRate = 0;
+      unsigned int channels = 1;
+      AudioFormat format = AUDIO_FORMAT_FLOAT32;
+      std::string lastError;
+      std::atomic<uint64_t> xruns;
+
+    public:
+      AudioBackend();
+
+      unsigned int
+      getSampleRate(void) const
+      {
+        return this->sampRate;
+      }
+
+      // Underruns the device reported (and we recovered from). Backends
+      // that cannot tell leave this at zero.
+      uint64_t
+      getXruns(void) const
+      {
+        return this->xruns;
+      }
+
+      unsigned int
+      getChannels(void) const
+      {
+        return this->channels;
+      }
+
+      AudioFormat
+      getFormat(void) const
+      {
+        return this->format;
+      }
+
+      size_t
+      getFrameSize(void) const
+      {
+        return this->channels * AudioBackend::formatSize(this->format);
+      }
+
+      static size_t
+      formatSize(AudioFormat format)
+      {
+        switch (format) {
+          case AUDIO_FORMAT_S16:
+            return sizeof(int16_t);
+
+          case AUDIO_FORMAT_S32:
+            return sizeof(int32_t);
+
+          default:
+            return sizeof(float);
+        }
+      }
+
+      std::string
+      getError(void) const
+      {
+        return this->lastError;
+      }
+
+      // Blocking write of interleaved frames in the format returned by
+      // getFormat(). Returns false on failure.
+      virtual bool write(const void *data, size_t frames) = 0;
+      virtual void drain(void);
+      virtual ~AudioBackend();
+
+      static AudioBackend *make(
+          std::string const &dev,
+          unsigned int rate,
+          unsigned int channels = 1);
+  };
+
+#ifdef SIGDIGGER_HAVE_ALSA
+  class AlsaAudioBackend : public AudioBackend {
+      snd_pcm_t *pcm = nullptr;
+
+      void negotiateFormat(snd_pcm_hw_params_t *params);
+
+    public:
+      AlsaAudioBackend(
+          std::string const &dev,
+          unsigned int rate,
+          unsigned int channels);
+      bool write(const void *data, size_t frames) override;
+      void drain(void) override;
+      ~AlsaAudioBackend() override;
+  };
+#endif // SIGDIGGER_HAVE_ALSA
+
+#ifdef SIGDIGGER_HAVE_PULSEAUDIO
+  class PulseAudioBackend : public AudioBackend {
+      pa_simple *stream = nullptr;
+
+    public:
+      PulseAudioBackend(
+          std::string const &sink,
+          unsigned int rate,
+          unsigned int channels);
+      bool write(const void *data, size_t frames) override;
+      void drain(void) override;
+      ~PulseAudioBackend() override;
+  };
+#endif // SIGDIGGER_HAVE_PULSEAUDIO
+
+  class FileAudioBackend : public AudioBackend {
+      FILE *fp = nullptr;
+      bool throttle = false;
+      bool seekable = false;
+      uint64_t written = 0;
+      struct timeval start;
+
+      bool writeHeader(void);
+
+    public:
+      FileAudioBackend(
+          std::string const &path,
+          unsigned int rate,
+          unsigned int channels,
+          bool throttle);
+      bool write(const void *data, size_t frames) override;
+      void drain(void) override;
+      ~FileAudioBackend() override;
+  };
+}
+
+#endif // AUDIOBACKEND_H
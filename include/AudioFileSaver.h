@@ -0,0 +1,54 @@
+//
+//    AudioFileSaver.h: Save demodulated audio to WAV files
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+#ifndef AUDIOFILESAVER_H
+#define AUDIOFILESAVER_H
+
+#include "GenericDataSaver.h"
+
+// Start a new file every hour of audio
+#define SIGDIGGER_AUDIO_SAVER_ROTATE_SECS 3600
+
+namespace SigDigger {
+  class AudioFileWriter;
+
+  //
+  // Records the audio inspector output as 16-bit mono WAV. Files are named
+  // after the given prefix and numbered, and a new one is started every
+  // SIGDIGGER_AUDIO_SAVER_ROTATE_SECS so that no single file grows past
+  // what a RIFF header can describe.
+  //
+  class AudioFileSaver : public GenericDataSaver {
+    Q_OBJECT
+
+    AudioFileWriter *getAudioWriter(void) const;
+
+  public:
+    AudioFileSaver(
+        std::string const &dir,
+        std::string const &prefix,
+        unsigned int rate,
+        QObject *parent = nullptr);
+    ~AudioFileSaver();
+
+    std::string getCurrentFile(void) const;
+  };
+}
+
+#endif // AUDIOFILESAVER_H
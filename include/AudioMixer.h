@@ -0,0 +1,72 @@
+//
+//    AudioMixer.h: Mix several audio channels into a stereo stream
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+#ifndef AUDIOMIXER_H
+#define AUDIOMIXER_H
+
+#include <sigutils/types.h>
+#include <vector>
+
+namespace SigDigger {
+  //
+  // Channel 0 is the master: it is the one driving the output clock, and
+  // every call to mix() consumes exactly as many samples from the other
+  // channels as it was given. Other channels are queued by feed() until
+  // then. A channel that falls behind is padded with silence, and one
+  // that gets ahead has its oldest samples dropped, so inspector clocks
+  // drifting apart never build up latency.
+  //
+  class AudioMixer {
+      struct Channel {
+        std::vector<SUFLOAT> queue;
+        SUSCOUNT avail = 0;
+        SUFLOAT gainL = 1;
+        SUFLOAT gainR = 1;
+      };
+
+      std::vector<Channel> channels;
+      std::vector<SUFLOAT> left;
+      std::vector<SUFLOAT> right;
+      std::vector<SUFLOAT> output;
+      SUSCOUNT maxLag;
+
+      void assertSize(SUSCOUNT len);
+
+    public:
+      AudioMixer(SUSCOUNT maxLag);
+
+      unsigned int
+      getChannelCount(void) const
+      {
+        return static_cast<unsigned int>(this->channels.size());
+      }
+
+      void setChannelCount(unsigned int count);
+
+      // Volume is linear, pan goes from -1 (left) to 1 (right)
+      void setMix(unsigned int channel, SUFLOAT volume, SUFLOAT pan);
+      void feed(unsigned int channel, const SUCOMPLEX *samples, SUSCOUNT len);
+
+      // Returns 2 * len interleaved stereo samples. Valid until the next
+      // call to mix().
+      const SUFLOAT *mix(const SUCOMPLEX *master, SUSCOUNT len);
+  };
+}
+
+#endif // AUDIOMIXER_H
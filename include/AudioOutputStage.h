@@ -0,0 +1,92 @@
+//
+//    AudioOutputStage.h: Final conversion stage before the soundcard
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+#ifndef AUDIOOUTPUTSTAGE_H
+#define AUDIOOUTPUTSTAGE_H
+
+#include <sigutils/types.h>
+#include "AudioBackend.h"
+
+//
+// Time constant of the DC blocker, in samples. It is applied once per
+// block, so it only has to be long compared to the block size.
+//
+#define SIGDIGGER_AUDIO_DC_TAU 8192.f
+
+// Soft clipping leaves samples below this level (full scale is 1) alone
+#define SIGDIGGER_AUDIO_CLIP_KNEE 0.75f
+
+namespace SigDigger {
+  //
+  // Takes the demodulator output (complex, audio in the real part) or the
+  // interleaved mixer output and turns it into soundcard samples: gain, DC removal, soft clipping and
+  // conversion to the backend format, all in a single pass. Soft clipping
+  // only bends samples above SIGDIGGER_AUDIO_CLIP_KNEE; without it, they
+  // are clamped to full scale.
+  //
+  class AudioOutputStage {
+      AudioFormat format = AUDIO_FORMAT_FLOAT32;
+      unsigned int channels = 1;
+      SUFLOAT gain = 1;
+      SUFLOAT dc[2] = {0, 0};
+      bool dcBlock = true;
+      bool softClip = true;
+
+      void updateDc(SUFLOAT &dc, SUFLOAT sum, SUSCOUNT len);
+
+      template<typename T, unsigned int Stride> void process(
+          T *__restrict__ out,
+          const SUFLOAT *__restrict__ in,
+          SUSCOUNT len);
+
+      template<unsigned int Stride> void dispatch(
+          void *out,
+          const SUFLOAT *in,
+          SUSCOUNT len);
+
+    public:
+      AudioOutputStage(AudioFormat format = AUDIO_FORMAT_FLOAT32);
+
+      void setFormat(AudioFormat format);
+      void setChannels(unsigned int channels);
+      void setGain(SUFLOAT gain);
+      void setDcBlock(bool enabled);
+      void setSoftClip(bool enabled);
+      void reset(void);
+
+      AudioFormat
+      getFormat(void) const
+      {
+        return this->format;
+      }
+
+      SUFLOAT
+      getGain(void) const
+      {
+        return this->gain;
+      }
+
+      // Both write len samples (not frames) to out, which must be at least
+      // len * AudioBackend::formatSize(getFormat()) bytes long.
+      void write(void *out, const SUCOMPLEX *samples, SUSCOUNT len);
+      void writeReal(void *out, const SUFLOAT *samples, SUSCOUNT len);
+  };
+}
+
+#endif // AUDIOOUTPUTSTAGE_H
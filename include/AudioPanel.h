@@ -20,6 +20,13 @@
 #define AUDIOPANEL_H
 
 #include <PersistentWidget.h>
+#include <vector>
+#include "DataSaverUI.h"
+
+// Pinned channels, on top of the main audio channel
+#define SIGDIGGER_AUDIO_MAX_EXTRA_CHANNELS 3
+
+class QTableWidgetItem;
 
 namespace Ui {
   class AudioPanel;
@@ -33,6 +40,16 @@ namespace SigDigger {
     LSB
   };
 
+  struct AudioHealth;
+
+  struct AudioChannelConfig {
+    qint64 freq = 0;
+    SUFLOAT bw = 0;
+    AudioDemod demod = AM;
+    SUFLOAT volume = 50; // Percent, 50 is unity gain
+    SUFLOAT pan = 0;     // Percent, -100 is left, 100 is right
+  };
+
   class AudioPanelConfig : public Suscan::Serializable {
   public:
     bool enabled = false;
@@ -40,6 +57,9 @@ namespace SigDigger {
     unsigned int rate = 44100;
     SUFLOAT cutOff = 15000;
     SUFLOAT volume = 50;
+    std::string device = "default";
+    std::string savePath;
+    std::vector<AudioChannelConfig> channels;
 
     // Overriden methods
     void deserialize(Suscan::Object const &conf) override;
@@ -56,15 +76,19 @@ namespace SigDigger {
     // Data
     SUFLOAT bandwidth = 200000;
 
+    // UI objects
+    DataSaverUI *saverUI = nullptr;
+
     // Private methods
     void connectAll(void);
     void populateRates(void);
+    void populateChannels(void);
     void refreshUi(void);
 
+  public:
     static AudioDemod strToDemod(std::string const &str);
     static std::string demodToStr(AudioDemod);
 
-  public:
     explicit AudioPanel(QWidget *parent = nullptr);
     ~AudioPanel() override;
 
@@ -75,6 +99,11 @@ namespace SigDigger {
     void setSampleRate(unsigned int);
     void setCutOff(SUFLOAT);
     void setVolume(SUFLOAT);
+    void setCaptureSize(quint64);
+    void setIORate(qreal);
+    void setRecordState(bool state);
+    void setHealth(AudioHealth const *health);
+    bool addChannel(AudioChannelConfig const &);
 
     // Getters
     SUFLOAT getBandwidth(void) const;
@@ -83,6 +112,10 @@ namespace SigDigger {
     unsigned int getSampleRate(void) const;
     SUFLOAT getCutOff(void) const;
     SUFLOAT getVolume(void) const;
+    std::string getDevice(void) const;
+    bool getRecordState(void) const;
+    std::string getRecordSavePath(void) const;
+    std::vector<AudioChannelConfig> const &getChannels(void) const;
 
     // Overriden methods
     Suscan::Serializable *allocConfig(void) override;
@@ -94,9 +127,18 @@ namespace SigDigger {
     void onFilterChanged(void);
     void onVolumeChanged(void);
     void onEnabledChanged(void);
+    void onChangeSavePath(void);
+    void onRecordStartStop(void);
+    void onPinChannel(void);
+    void onRemoveChannel(void);
+    void onChannelItemChanged(QTableWidgetItem *);
 
   signals:
     void changed(void);
+    void toggleRecord(void);
+    void pinChannel(void);
+    void channelsChanged(void);
+    void mixChanged(void);
 
   private:
     Ui::AudioPanel *ui = nullptr;
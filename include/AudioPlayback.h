@@ -26,34 +26,82 @@
 #include <string>
 #include <Suscan/Library.h>
 #include <unistd.h>
+#include <memory>
+#include <atomic>
+#include <climits>
 
-#ifdef SIGDIGGER_HAVE_ALSA
-#  include <alsa/asoundlib.h>
-#endif // SIGDIGGER_HAVE_ALSA
+#include "AudioBackend.h"
+#include "AudioOutputStage.h"
+#include "AudioMixer.h"
 
 #define SIGDIGGER_AUDIO_BUFFER_ALLOC static_cast<size_t>(4 * getpagesize())
+// Samples per buffer. Buffers are sized for the widest sample format.
 #define SIGDIGGER_AUDIO_BUFFER_SIZE (SIGDIGGER_AUDIO_BUFFER_ALLOC / sizeof (float))
+#define SIGDIGGER_AUDIO_CHANNELS            2
 #define SIGDIGGER_AUDIO_SAMPLE_RATE         44100
 #define SIGDIGGER_AUDIO_BUFFER_NUM          10
 #define SIGDIGGER_AUDIO_BUFFER_MIN          5
 #define SIGDIGGER_AUDIO_BUFFERING_WATERMARK 2
 
 namespace SigDigger {
-
-#ifdef SIGDIGGER_HAVE_ALSA
   class AudioBufferList;
 
+  //
+  // Snapshot of the health of the audio path. Counters are totals since
+  // the device was opened, fill levels and jitter cover the time elapsed
+  // since the previous snapshot.
+  //
+  struct AudioHealth {
+    uint64_t xruns = 0;       // Device underruns
+    uint64_t dropped = 0;     // Samples lost because all buffers were full
+    uint64_t rebuffers = 0;   // Playback stops to refill buffers
+    unsigned int minFill = 0; // Buffers queued for playback
+    unsigned int maxFill = 0;
+    unsigned int buffers = SIGDIGGER_AUDIO_BUFFER_NUM;
+    qreal jitter = 0;         // Worst write period deviation (ms)
+  };
+
+  // Updated from both the producer and the playback thread
+  struct AudioHealthCounters {
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<uint64_t> rebuffers{0};
+    std::atomic<unsigned int> minFill{UINT_MAX};
+    std::atomic<unsigned int> maxFill{0};
+    std::atomic<uint64_t> jitterUsec{0};
+
+    void
+    updateFill(unsigned int fill)
+    {
+      unsigned int curr = this->minFill;
+      while (fill < curr && !this->minFill.compare_exchange_weak(curr, fill));
+
+      curr = this->maxFill;
+      while (fill > curr && !this->maxFill.compare_exchange_weak(curr, fill));
+    }
+
+    void
+    updateJitter(uint64_t usec)
+    {
+      uint64_t curr = this->jitterUsec;
+      while (usec > curr && !this->jitterUsec.compare_exchange_weak(curr, usec));
+    }
+  };
+
   class PlaybackWorker : public QObject {
       Q_OBJECT
 
       bool halting = false;
-      snd_pcm_t *pcm = nullptr;  // Weak
-      AudioBufferList *instance; // Weak
+      AudioBackend *backend = nullptr;       // Weak
+      AudioBufferList *instance;             // Weak
+      AudioHealthCounters *health = nullptr; // Weak
+      size_t frames;
 
     public:
       PlaybackWorker(
           AudioBufferList *instance = nullptr,
-          snd_pcm_t *pcm = nullptr);
+          AudioBackend *backend = nullptr,
+          AudioHealthCounters *health = nullptr,
+          size_t frames = 0);
 
     public slots:
       void play(void);
@@ -68,7 +116,7 @@ namespace SigDigger {
   struct AudioBuffer {
     AudioBuffer *next = nullptr;
     AudioBuffer *prev = nullptr;
-    float *data = nullptr;
+    uint8_t *data = nullptr;
 
     AudioBuffer();
     ~AudioBuffer();
@@ -115,24 +163,21 @@ namespace SigDigger {
     void reset(void);
 
     // Takes one from the freelist, replaces current, returns pointer
-    float *reserve(void);
+    uint8_t *reserve(void);
 
     // Takes current and puts it in the playList
     void commit(void);
 
     // Takes one from the playList
-    float *next(void);
+    uint8_t *next(void);
 
     // Moves current playing buffer to the freeList
     void release(void);
   };
 
-#endif // SIGDIGGER_HAVE_ALSA
-
   class AudioPlayback : public QObject {
     Q_OBJECT
 
-#ifdef SIGDIGGER_HAVE_ALSA
     // Audio buffer list
     AudioBufferList bufferList;
     QThread *workerThread  = nullptr;
@@ -140,15 +185,19 @@ namespace SigDigger {
 
     bool buffering = true;
     bool failed = false;
-    float *current_buffer = nullptr;
-    snd_pcm_t *pcm = nullptr;
+    uint8_t *current_buffer = nullptr;
+    std::unique_ptr<AudioBackend> backend;
+    AudioHealthCounters health;
+    AudioMixer mixer;
+    AudioOutputStage stage;
+    size_t frameSize;
+    size_t bufferFrames;
 
     unsigned int completed = 0;
     unsigned int ptr = 0;
     unsigned int sampRate;
 
     void startWorker(void);
-#endif // SIGDIGGER_HAVE_ALSA
 
     public:
       AudioPlayback(
@@ -156,7 +205,15 @@ namespace SigDigger {
           unsigned int rate = SIGDIGGER_AUDIO_SAMPLE_RATE);
       virtual ~AudioPlayback();
       unsigned int getSampleRate(void) const;
+      AudioHealth getHealth(void);
+      void setVolume(SUFLOAT volume);
+      void setChannelCount(unsigned int count);
+      void setChannelMix(unsigned int channel, SUFLOAT volume, SUFLOAT pan);
+
+      // Channel 0 (the master) paces the output. Other channels are
+      // queued and mixed in as master samples arrive.
       void write(const SUCOMPLEX *samples, SUSCOUNT size);
+      void feed(unsigned int channel, const SUCOMPLEX *samples, SUSCOUNT size);
 
     public slots:
       void onError(void);
@@ -21,21 +21,81 @@
 
 #include <Suscan/Messages/PSDMessage.h>
 
+// Buffers start at, and are padded to, this many bytes
+#define SIGDIGGER_AVERAGER_ALIGN      64
+
+#define SIGDIGGER_AVERAGER_MAX_WINDOW 256
+
 namespace SigDigger {
+  //
+  // Smooths the PSD (dB) with one of several modes. Exponential and
+  // sliding window averages can be taken either over the dB values or
+  // over linear power. Max and min hold work in dB, and can also be
+  // enabled next to an average. Everything that is enabled is updated in
+  // a single vectorized pass, in buffers that are only reallocated when
+  // they grow: for a larger PSD, or a longer window. The ring of previous
+  // inputs only exists in the sliding window mode.
+  //
   class Averager {
-    float *last = nullptr;
-    unsigned long bufsiz = 0;
+  public:
+    enum Mode {
+      MODE_EXPONENTIAL,
+      MODE_WINDOW,
+      MODE_MAX_HOLD,
+      MODE_MIN_HOLD
+    };
+
+  private:
+    Mode mode = MODE_EXPONENTIAL;
     float alpha = 1.;
+    unsigned int window = 16;
+    float decay = 0;
+    bool linear = false;
+    bool holds = false;
+
+    float *block = nullptr;
+    size_t capacity = 0; // In floats
+    unsigned long bufsiz = 0;
+    size_t stride = 0;   // Padded bufsiz
+    bool restart = true;
+
+    // Views of block
+    float *mean = nullptr;
+    float *acc = nullptr;  // Linear power state, if averaging in linear
+    float *sum = nullptr;
+    float *ring = nullptr; // `window' previous inputs, window mode only
+    float *max = nullptr;
+    float *min = nullptr;
+    unsigned int slot = 0;
+
+    void allocate(unsigned long size);
 
   public:
     void feed(Suscan::PSDMessage const &m);
+    void feed(const float *psd, size_t size);
     void setAlpha(float alpha);
+    void setMode(Mode mode);
+    void setWindow(unsigned int frames);
+    void setDecay(float dBPerUpdate);
+    void setLinear(bool linear);
+    void setHoldsEnabled(bool enabled);
     ~Averager(void);
 
-    float *
-    get(void) const
+    // Output of the selected mode (dB). Stays valid, and is not written,
+    // until the next feed.
+    float *get(void) const;
+
+    // Only updated if holds are enabled or selected as the mode
+    const float *
+    getMax(void) const
+    {
+      return this->max;
+    }
+
+    const float *
+    getMin(void) const
     {
-      return this->last;
+      return this->min;
     }
 
     unsigned long
@@ -44,13 +104,11 @@ namespace SigDigger {
       return this->bufsiz;
     }
 
+    // Starts over with the next PSD. Buffers are kept.
     void
     reset(void)
     {
-      if (this->last != nullptr) {
-        delete [] this->last;
-        this->bufsiz = 0;
-      }
+      this->restart = true;
     }
   };
 }
@@ -0,0 +1,105 @@
+//
+//    BandMeter.h: Band power meters
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+#ifndef BANDMETER_H
+#define BANDMETER_H
+
+#include <QtGlobal>
+#include <vector>
+
+#include "BandMeterConfig.h"
+
+// PSD bins converted to linear power at a time
+#define SIGDIGGER_BAND_METER_BLOCK           1024
+
+// Log resolution and length (one hour at one entry per second)
+#define SIGDIGGER_BAND_METER_LOG_INTERVAL_MS 1000
+#define SIGDIGGER_BAND_METER_LOG_LENGTH      3600
+
+namespace SigDigger {
+  struct BandMeterReading {
+    bool  valid = false;   // Band (partly) inside the current span
+    float power = 0;       // Integrated over the band (dB)
+    float level = 0;       // Mean per FFT bin (dB), comparable to the PSD
+  };
+
+  //
+  // Integrated power of a set of user-defined bands. Every PSD is turned
+  // into a running sum of linear power once, after which each band costs
+  // a subtraction: O(bins + bands) per frame however wide or many the
+  // bands are. Band powers are also averaged over fixed intervals and
+  // kept in a ring, so they can be reviewed or exported later.
+  //
+  class BandMeter {
+      std::vector<BandMeterBand> bands;
+      std::vector<BandMeterReading> readings;
+      std::vector<double> prefix;
+      float block[SIGDIGGER_BAND_METER_BLOCK];
+
+      // Interval being averaged (linear)
+      std::vector<double> sums;
+      std::vector<unsigned int> hits;
+      qint64 start = -1;
+
+      // Log ring. One row of bands.size() floats per interval, NaN where
+      // the band was out of the span.
+      std::vector<float> log;
+      std::vector<qint64> times;
+      size_t head = 0;
+      size_t count = 0;
+
+      void integrate(const float *psd, size_t size);
+      double cumulative(const float *psd, size_t size, qreal u) const;
+      void flush(void);
+
+    public:
+      void setBands(std::vector<BandMeterBand> const &bands);
+      void feed(
+          const float *psd,
+          size_t size,
+          qint64 fc,
+          qreal rate,
+          qint64 now);
+      void clearLog(void);
+
+      std::vector<BandMeterBand> const &
+      getBands(void) const
+      {
+        return this->bands;
+      }
+
+      std::vector<BandMeterReading> const &
+      getReadings(void) const
+      {
+        return this->readings;
+      }
+
+      // Logged intervals, oldest first
+      size_t
+      getLogLength(void) const
+      {
+        return this->count;
+      }
+
+      qint64 getLogTime(size_t index) const;   // ms since epoch
+      float getLogPower(size_t index, size_t band) const;
+  };
+}
+
+#endif // BANDMETER_H
@@ -0,0 +1,50 @@
+//
+//    BandMeterConfig.h: Band power meter definitions
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+#ifndef BANDMETERCONFIG_H
+#define BANDMETERCONFIG_H
+
+#include <Suscan/Serializable.h>
+#include <QtGlobal>
+#include <string>
+#include <vector>
+
+#define SIGDIGGER_BAND_METER_MAX_BANDS 64
+
+namespace SigDigger {
+  struct BandMeterBand {
+    std::string name;
+    qint64 freq = 0;       // Center, absolute (Hz)
+    qint64 bandwidth = 0;  // Hz
+  };
+
+  class BandMeterConfig : public Suscan::Serializable {
+    public:
+      std::vector<BandMeterBand> bands;
+
+      BandMeterConfig();
+      BandMeterConfig(Suscan::Object const &conf);
+
+      // Overriden methods
+      void deserialize(Suscan::Object const &conf) override;
+      Suscan::Object &&serialize(void) override;
+  };
+}
+
+#endif // BANDMETERCONFIG_H
@@ -0,0 +1,78 @@
+//
+//    BandMeterDialog.h: Band power meter list
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+#ifndef BANDMETERDIALOG_H
+#define BANDMETERDIALOG_H
+
+#include <QDialog>
+#include <QTimer>
+
+#include "BandMeter.h"
+
+// How often readings are refreshed (ms)
+#define SIGDIGGER_BAND_METER_DIALOG_REFRESH_MS 250
+
+namespace Ui {
+  class BandMeterDialog;
+}
+
+namespace SigDigger {
+  //
+  // Editable list of band meters with their current power. Names,
+  // frequencies and widths are edited in place. The meter log can be
+  // exported as CSV, one column per band.
+  //
+  class BandMeterDialog : public QDialog
+  {
+    Q_OBJECT
+
+    BandMeter *meter = nullptr; // Weak
+    QTimer *refreshTimer = nullptr;
+
+    void connectAll(void);
+    void refreshUi(void);
+    bool exportLog(QString const &path) const;
+
+  public:
+    explicit BandMeterDialog(QWidget *parent = nullptr);
+    ~BandMeterDialog() override;
+
+    void setMeter(BandMeter *meter);
+    void setBands(std::vector<BandMeterBand> const &bands);
+    std::vector<BandMeterBand> getBands(void) const;
+
+  public slots:
+    void onRefresh(void);
+    void onItemChanged(void);
+    void onSelectionChanged(void);
+    void onAdd(void);
+    void onRemove(void);
+    void onExport(void);
+    void onClearLog(void);
+
+  signals:
+    void addBand(void);
+    void bandsChanged(void);
+
+  private:
+    Ui::BandMeterDialog *ui = nullptr;
+  };
+}
+
+#endif // BANDMETERDIALOG_H
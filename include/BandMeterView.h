@@ -0,0 +1,59 @@
+//
+//    BandMeterView.h: Band power meter strip
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+#ifndef BANDMETERVIEW_H
+#define BANDMETERVIEW_H
+
+#include <QFrame>
+
+#include "BandMeter.h"
+
+// Height of the strip (pixels)
+#define SIGDIGGER_BAND_METER_VIEW_HEIGHT 40
+
+namespace SigDigger {
+  //
+  // One bar per band meter, placed under its band and filled up to the
+  // mean level of the band within the pandapter range. Like the
+  // persistence display, it spans the whole sample rate.
+  //
+  class BandMeterView : public QFrame
+  {
+    Q_OBJECT
+
+    const BandMeter *meter = nullptr; // Weak
+    qint64 centerFreq = 0;
+    qint64 sampleRate = 0;
+    float min = -120;
+    float max = 0;
+
+  protected:
+    void paintEvent(QPaintEvent *) override;
+
+  public:
+    explicit BandMeterView(QWidget *parent = nullptr);
+
+    void setMeter(const BandMeter *meter);
+    void setCenterFreq(qint64 freq);
+    void setSampleRate(qint64 rate);
+    void setRange(float min, float max);
+  };
+}
+
+#endif // BANDMETERVIEW_H
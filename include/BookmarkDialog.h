@@ -0,0 +1,75 @@
+//
+//    BookmarkDialog.h: Bookmark and band plan list
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+
+#ifndef BOOKMARKDIALOG_H
+#define BOOKMARKDIALOG_H
+
+#include <QDialog>
+
+#include "BookmarkStore.h"
+
+// Rows listed at once. Narrow the filter to see the rest.
+#define SIGDIGGER_BOOKMARK_DIALOG_MAX_ROWS 1000
+
+namespace Ui {
+  class BookmarkDialog;
+}
+
+namespace SigDigger {
+  //
+  // Searchable list of bookmarks and band plan entries. New bookmarks
+  // are taken at the current channel; band plans are imported from CSV.
+  // Double clicking an entry asks to tune to it.
+  //
+  class BookmarkDialog : public QDialog
+  {
+    Q_OBJECT
+
+    BookmarkStore *store = nullptr; // Weak
+
+    void connectAll(void);
+    void refreshUi(void);
+
+  public:
+    explicit BookmarkDialog(QWidget *parent = nullptr);
+    ~BookmarkDialog() override;
+
+    void setStore(BookmarkStore *store);
+
+  public slots:
+    void refresh(void);
+    void onSelectionChanged(void);
+    void onAdd(void);
+    void onRemove(void);
+    void onImport(void);
+    void onClear(void);
+    void onDoubleClicked(int row, int column);
+
+  signals:
+    void addBookmark(QString name);
+    void bookmarksChanged(void);
+    void tune(qint64 freq);
+
+  private:
+    Ui::BookmarkDialog *ui = nullptr;
+  };
+}
+
+#endif // BOOKMARKDIALOG_H
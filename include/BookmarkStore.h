@@ -0,0 +1,102 @@
+//
+//    BookmarkStore.h: Frequency bookmarks and band plans
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+
+#ifndef BOOKMARKSTORE_H
+#define BOOKMARKSTORE_H
+
+#include <QColor>
+#include <QString>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Kept in the Suscan configuration directory
+#define SIGDIGGER_BOOKMARKS_FILE "bookmarks.csv"
+
+namespace SigDigger {
+  struct Bookmark {
+    std::string name;
+    qint64 lo = 0;     // Hz. Equal to hi for single frequencies.
+    qint64 hi = 0;
+    QColor color;      // Invalid: default
+  };
+
+  //
+  // Bookmarks (single frequencies) and band plan entries (ranges), kept
+  // sorted by their lower edge. On top of the sorted array lies an
+  // implicit balanced interval tree: the middle entry of every range
+  // of the array stores the highest upper edge of the range, so the
+  // entries overlapping a span are found in O(log n + k) without any
+  // extra node storage. The store is indexed again after every change,
+  // which costs a sort, so bulk changes go through addAll().
+  //
+  class BookmarkStore {
+      std::vector<Bookmark> entries;
+      std::vector<qint64> maxHi;
+
+      void index(void);
+      void query(
+          size_t begin,
+          size_t end,
+          qint64 from,
+          qint64 to,
+          std::vector<size_t> &out,
+          size_t max) const;
+
+    public:
+      void add(Bookmark const &bookmark);
+      void addAll(std::vector<Bookmark> &&bookmarks);
+      void remove(size_t index);
+      void clear(void);
+
+      // Entries overlapping [from, to], by lower edge, at most `max'
+      void query(
+          qint64 from,
+          qint64 to,
+          std::vector<size_t> &out,
+          size_t max = SIZE_MAX) const;
+
+      size_t
+      size(void) const
+      {
+        return this->entries.size();
+      }
+
+      Bookmark const &
+      operator[](size_t index) const
+      {
+        return this->entries[index];
+      }
+
+      // CSV: lo,hi,name,color. hi and color may be empty, and a line
+      // may also be just freq,name. Frequencies are in Hz, or with a
+      // k, M or G suffix. Lines whose first field is not a frequency
+      // (headers, comments) are skipped.
+      static bool parseCsv(
+          const char *data,
+          size_t size,
+          std::vector<Bookmark> &out);
+      bool importCsv(QString const &path, size_t &added, QString &error);
+      bool load(QString const &path);
+      bool save(QString const &path, QString &error) const;
+  };
+}
+
+#endif // BOOKMARKSTORE_H
@@ -0,0 +1,78 @@
+//
+//    BookmarkView.h: Bookmarks of the visible span
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+
+#ifndef BOOKMARKVIEW_H
+#define BOOKMARKVIEW_H
+
+#include <QFrame>
+#include <vector>
+
+#include "BookmarkStore.h"
+
+// Height of the strip (pixels)
+#define SIGDIGGER_BOOKMARK_VIEW_HEIGHT     32
+
+// Entries looked at per repaint, whatever the span holds
+#define SIGDIGGER_BOOKMARK_VIEW_MAX        1024
+
+// How close to a mark a click must land (pixels)
+#define SIGDIGGER_BOOKMARK_VIEW_CLICK_DIST 5
+
+namespace SigDigger {
+  //
+  // Band plan entries as bars along the top and bookmarks as ticks with
+  // their name along the bottom, for the span shown by the spectrum.
+  // Only the entries that overlap the span are looked up, on each
+  // repaint; labels that would overlap the previous one are left out.
+  // Clicking a mark selects its frequency.
+  //
+  class BookmarkView : public QFrame
+  {
+    Q_OBJECT
+
+    const BookmarkStore *store = nullptr; // Weak
+    qint64 centerFreq = 0;
+    qint64 span = 0;
+
+    struct Mark {
+      qreal x0, x1;
+      qint64 freq;
+    };
+
+    std::vector<size_t> visible;
+    std::vector<Mark> marks;
+
+  protected:
+    void paintEvent(QPaintEvent *) override;
+    void mousePressEvent(QMouseEvent *) override;
+
+  public:
+    explicit BookmarkView(QWidget *parent = nullptr);
+
+    void setStore(const BookmarkStore *store);
+    void setCenterFreq(qint64 freq);
+    void setSpan(qint64 span);
+
+  signals:
+    void bookmarkSelected(qint64 freq);
+  };
+}
+
+#endif // BOOKMARKVIEW_H
@@ -0,0 +1,128 @@
+//
+//    FftGovernor.h: Automatic FFT size and refresh rate
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+#ifndef FFTGOVERNOR_H
+#define FFTGOVERNOR_H
+
+#include <QtGlobal>
+
+// How often the measurements are evaluated (ms)
+#define SIGDIGGER_FFT_GOVERNOR_PERIOD_MS     1000
+
+// Nothing is stepped down below these
+#define SIGDIGGER_FFT_GOVERNOR_MIN_SIZE      512
+#define SIGDIGGER_FFT_GOVERNOR_MIN_RATE      5
+
+// The analyzer falls behind when it processes less than this fraction
+// of the sample rate. Below the severe mark, one evaluation is enough.
+#define SIGDIGGER_FFT_GOVERNOR_LAG           .95
+#define SIGDIGGER_FFT_GOVERNOR_SEVERE_LAG    .8
+
+// Messages waiting for the GUI thread
+#define SIGDIGGER_FFT_GOVERNOR_MAX_BACKLOG   4
+
+// Hysteresis: evaluations in a row before stepping down or up, and
+// evaluations ignored after a change while the measures settle.
+// Stepping up also requires the load to stay under this fraction of
+// the target, as one step roughly doubles the work.
+#define SIGDIGGER_FFT_GOVERNOR_DOWN_COUNT    2
+#define SIGDIGGER_FFT_GOVERNOR_UP_COUNT      5
+#define SIGDIGGER_FFT_GOVERNOR_SETTLE_COUNT  2
+#define SIGDIGGER_FFT_GOVERNOR_UP_MARGIN     .45
+
+namespace SigDigger {
+  //
+  // Picks the FFT size and PSD refresh rate from a ladder that starts at
+  // the ones chosen by the user. Every level down halves the refresh
+  // rate until it reaches its minimum, and then halves the FFT size.
+  // Levels go down when the analyzer cannot keep up with the sample
+  // rate, when PSD messages pile up before reaching the GUI thread or
+  // when the GUI thread spends more than the target fraction of its time
+  // on the spectrum. They go up again, in reverse order, once everything
+  // has been well within budget for a while.
+  //
+  class FftGovernor {
+    public:
+      enum Reason {
+        REASON_NONE,
+        REASON_ANALYZER,
+        REASON_BACKLOG,
+        REASON_GUI,
+        REASON_HEADROOM
+      };
+
+    private:
+      unsigned int maxSize = 0;
+      unsigned int maxRate = 0;
+      qreal target = .5;
+
+      unsigned int level = 0;
+      unsigned int maxLevel = 0;
+      unsigned int size = 0;
+      unsigned int rate = 0;
+
+      unsigned int over = 0;
+      unsigned int under = 0;
+      unsigned int settle = 0;
+      Reason reason = REASON_NONE;
+
+      void apply(void);
+
+    public:
+      // The choice of the user is the top of the ladder. Changing it
+      // starts over from there.
+      void setLimits(unsigned int fftSize, unsigned int refreshRate);
+
+      // Fraction of the GUI thread time
+      void setTarget(qreal target);
+      void reset(void);
+
+      // Returns true if the size or the rate changed. processed is the
+      // measured processing rate over the sample rate, load the fraction
+      // of GUI thread time spent on the spectrum.
+      bool update(qreal processed, qreal load, unsigned int backlog);
+
+      unsigned int
+      getFftSize(void) const
+      {
+        return this->size;
+      }
+
+      unsigned int
+      getRefreshRate(void) const
+      {
+        return this->rate;
+      }
+
+      unsigned int
+      getLevel(void) const
+      {
+        return this->level;
+      }
+
+      // Why the last change was made
+      Reason
+      getReason(void) const
+      {
+        return this->reason;
+      }
+  };
+}
+
+#endif // FFTGOVERNOR_H
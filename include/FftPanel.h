@@ -21,7 +21,10 @@
 
 #include <PersistentWidget.h>
 #include <Suscan/AnalyzerParams.h>
+#include <Suscan/Messages/PSDMessage.h>
 #include "Palette.h"
+#include "Averager.h"
+#include "SpectrumRecorder.h"
 
 namespace Ui {
   class FftPanel;
@@ -46,8 +49,31 @@ namespace SigDigger {
     bool rangeLock = false;
 
     std::string palette = "Suscan";
+    std::string detector = "peak";
+
+    std::string averager = "exponential";
+    unsigned int averagerWindow = 16;
+    float averagerDecay = .1f;
+    bool averagerLinear = false;
+
+    bool persistence = false;
+    float persistenceTime = 2; // Seconds
+
+    bool historyEnabled = false;
+    std::string historyPath;
+    unsigned int historySize = 512; // MiB
+
+    std::string spectrumLogFolder;
+    unsigned int spectrumLogInterval = 25;   // Frames per row
+    bool spectrumLogMax = false;
+    unsigned int spectrumLogBits = 8;
+    unsigned int spectrumLogWidth = 4096;    // 0: full resolution
+    unsigned int replaySpeed = 32;           // Rows per painted frame
 
     int zoom = 1;
+    bool zoomSpectrum = false;
+    bool autoFft = false;
+    unsigned int cpuTarget = 50; // % of the GUI thread
 
     // Overriden methods
     void deserialize(Suscan::Object const &conf) override;
@@ -95,6 +121,7 @@ namespace SigDigger {
 
     // Getters
     const QColor *getPaletteGradient(void) const;
+    Palette const &getSelectedPalette(void) const;
     std::string getPalette(void) const;
     float getPandRangeMin(void) const;
     float getPandRangeMax(void) const;
@@ -104,12 +131,34 @@ namespace SigDigger {
     float getPanWfRatio(void) const;
     unsigned int getFreqZoom(void) const;
     unsigned int getFftSize(void) const;
+    std::vector<unsigned int> const &getFftSizes(void) const;
     unsigned int getTimeSpan(void) const;
     unsigned int getRefreshRate(void) const;
     bool getPeakHold(void) const;
     bool getPeakDetect(void) const;
     bool getRangeLock(void) const;
     enum Suscan::AnalyzerParams::WindowFunction getWindowFunction(void) const;
+    enum Suscan::PSDMessage::Detector getDetector(void) const;
+    enum Averager::Mode getAveragerMode(void) const;
+    unsigned int getAveragerWindow(void) const;
+    float getAveragerDecay(void) const;
+    bool getAveragerLinear(void) const;
+    bool getAutoFft(void) const;
+    float getCpuTarget(void) const;
+    bool getZoomSpectrum(void) const;
+    bool getPersistence(void) const;
+    float getPersistenceTime(void) const;
+    bool getHistoryEnabled(void) const;
+    std::string getHistoryPath(void) const;
+    quint64 getHistorySize(void) const;
+    bool getSpectrumLogEnabled(void) const;
+    std::string getSpectrumLogFolder(void) const;
+    unsigned int getSpectrumLogInterval(void) const;
+    enum SpectrumRecorder::Mode getSpectrumLogMode(void) const;
+    unsigned int getSpectrumLogBits(void) const;
+    unsigned int getSpectrumLogWidth(void) const;
+    bool getReplaying(void) const;
+    unsigned int getReplaySpeed(void) const;
 
     // Setters
     void setPeakHold(bool);
@@ -130,6 +179,23 @@ namespace SigDigger {
     void setTimeSpan(unsigned int);
     void setSampleRate(unsigned int);
     void setWindowFunction(enum Suscan::AnalyzerParams::WindowFunction func);
+    void setDetector(enum Suscan::PSDMessage::Detector det);
+    void setAveragerMode(enum Averager::Mode mode);
+    void setAveragerWindow(unsigned int frames);
+    void setAveragerDecay(float dB);
+    void setAveragerLinear(bool linear);
+    void setAutoFft(bool enabled);
+    void setCpuTarget(unsigned int percent);
+    void setGovernorDecision(
+        unsigned int size,
+        unsigned int rate,
+        QString const &reason);
+    void setZoomSpectrum(bool enabled);
+    void setPersistence(bool enabled);
+    void setPersistenceTime(float seconds);
+    void setHistoryEnabled(bool);
+    void setSpectrumLogEnabled(bool);
+    void setReplaying(bool);
 
     // Overriden methods
     Suscan::Serializable *allocConfig(void) override;
@@ -148,15 +214,37 @@ namespace SigDigger {
     void onRangeLockChanged(void);
     void onPeakChanged(void);
     void onWindowFunctionChanged(void);
+    void onDetectorChanged(void);
+    void onAveragerModeChanged(void);
+    void onAveragerParamsChanged(void);
+    void onAutoFftChanged(void);
+    void onZoomSpectrumChanged(void);
+    void onPersistenceChanged(void);
+    void onHistoryToggled(void);
+    void onBrowseHistory(void);
+    void onSpectrumLogToggled(void);
+    void onSpectrumLogParamsChanged(void);
+    void onReplayToggled(void);
+    void onTrackPeaks(void);
+    void onAutoRange(void);
 
   signals:
     void paletteChanged(void);
     void rangesChanged(void);
     void averagerChanged(void);
+    void autoFftChanged(void);
+    void zoomSpectrumChanged(void);
+    void persistenceChanged(void);
     void fftSizeChanged(void);
     void windowFunctionChanged(void);
     void refreshRateChanged(void);
     void timeSpanChanged(void);
+    void historyChanged(void);
+    void browseHistory(void);
+    void spectrumLogChanged(void);
+    void replayChanged(void);
+    void trackPeaks(void);
+    void autoRange(void);
 
   };
 }
@@ -0,0 +1,103 @@
+//
+//    FftwWisdom.h: FFTW wisdom cache and plan warm-up
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+#ifndef FFTWWISDOM_H
+#define FFTWWISDOM_H
+
+#include <QObject>
+#include <QThread>
+#include <atomic>
+#include <vector>
+
+// Inside the Suscan config directory
+#define SIGDIGGER_FFTW_WISDOM_FILE "fftw.wisdom"
+
+// Inspector spectra and channel FFTs, powers of two in between
+#define SIGDIGGER_FFTW_WISDOM_INSPECTOR_MIN 256
+#define SIGDIGGER_FFTW_WISDOM_INSPECTOR_MAX 8192
+
+namespace SigDigger {
+  class FftwWisdom;
+
+  class FftwWisdomWorker : public QObject {
+      Q_OBJECT
+
+      FftwWisdom *instance;
+
+      bool measure(unsigned int size, int sign, void *in, void *out);
+
+    private slots:
+      void onWarmUp(void);
+
+    public:
+      FftwWisdomWorker(FftwWisdom *instance);
+
+    signals:
+      void finished(unsigned int planned);
+  };
+
+  //
+  // Suscan plans its FFTs with single precision FFTW. Wisdom is global to
+  // the process, so plans measured here are picked up by every later plan
+  // of the same size, whoever makes it. The wisdom file is loaded before
+  // Suscan starts, and the warm-up measures the sizes that are not in it
+  // yet in a low priority thread, saving the file as soon as it is done.
+  // Only sizes missing from the file cost anything after the first run.
+  //
+  class FftwWisdom : public QObject
+  {
+      Q_OBJECT
+
+      std::vector<unsigned int> sizes;
+      std::atomic<bool> cancelled;
+      bool busy = false;
+
+      QThread workerThread;
+      FftwWisdomWorker workerObject;
+
+    public:
+      FftwWisdom(QObject *parent = nullptr);
+      ~FftwWisdom() override;
+
+      // Also makes the planner thread safe. Call before any FFT is planned.
+      static bool load(void);
+      static bool save(void);
+      static QString getPath(void);
+
+      // Forward and backward complex plans for all these sizes, plus the
+      // common inspector sizes. False if a warm-up is in progress.
+      bool warmUp(std::vector<unsigned int> const &sizes);
+
+      // Waits for the plan being measured, if any, and drops the rest.
+      // No warm-up can be started afterwards.
+      void stop(void);
+      bool isBusy(void) const;
+
+      friend class FftwWisdomWorker;
+
+    signals:
+      void start(void);
+      void finished(unsigned int planned);
+
+    public slots:
+      void onFinished(unsigned int planned);
+  };
+}
+
+#endif // FFTWWISDOM_H
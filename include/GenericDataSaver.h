@@ -91,6 +91,17 @@ namespace SigDigger {
       // Private methods
       void doCommit(void);
 
+    protected:
+      // Stops the worker and closes the writer. Subclasses owning their
+      // writer must call this before deleting it.
+      void shutdown(void);
+
+      GenericDataWriter *
+      getWriter(void) const
+      {
+        return this->writer;
+      }
+
     public:
       explicit GenericDataSaver(
           GenericDataWriter *writer,
@@ -22,6 +22,18 @@
 #include <PersistentWidget.h>
 #include <Suscan/Messages/PSDMessage.h>
 #include <ColorConfig.h>
+#include <Palette.h>
+#include <BandMeter.h>
+#include <BookmarkStore.h>
+#include <QTimer>
+#include <QElapsedTimer>
+
+// Upper bound for the spectrum repaint rate, whatever the display does
+#define SIGDIGGER_SPECTRUM_MAX_FPS      60
+
+// Stop repainting if PSD updates stop for this long (and for no less
+// than three PSD intervals)
+#define SIGDIGGER_SPECTRUM_STALL_MS     250
 
 namespace Ui {
   class MainSpectrum;
@@ -29,6 +41,16 @@ namespace Ui {
 
 // Does it make sense to turn this into a PersistentWidget, anyways?
 namespace SigDigger {
+  // Render counters, covering the time since the previous query
+  struct SpectrumRenderStats {
+    quint64 rendered = 0;   // Frames handed to the widget
+    quint64 skipped = 0;    // PSD updates replaced before being painted
+    quint64 repeated = 0;   // Frames painted again to keep the time base
+    qreal fps = 0;
+    qreal meanMs = 0;       // Time spent in the widget per frame
+    qreal maxMs = 0;
+  };
+
   class MainSpectrum : public QWidget
   {
     Q_OBJECT
@@ -53,17 +75,53 @@ namespace SigDigger {
     unsigned int bandwidth = 0;
     unsigned int zoom = 1;
 
+    // Render scheduling. PSD updates land in a latest-frame slot, which
+    // is painted at a steady rate by renderTimer. The slot points to the
+    // caller's buffer, it is not copied.
+    QTimer *renderTimer = nullptr;
+    float *frame = nullptr;
+    int frameSize = 0;
+    bool fresh = false;
+    unsigned int renderRate = 0;
+    QElapsedTimer feedClock;
+    qreal psdInterval = 0;
+
+    // Width of the zoom spectrum frames being painted instead of the
+    // full-span ones, 0 if none.
+    unsigned int zoomRate = 0;
+
+    // Persistence display. Fed with every PSD, not every render tick.
+    bool persistence = false;
+    qreal persistenceTime = 2; // Seconds
+
+    // Render statistics
+    QElapsedTimer statsClock;
+    SpectrumRenderStats stats;
+    qint64 renderNs = 0;
+    qint64 maxRenderNs = 0;
+    qint64 totalRenderNs = 0;
+
     // Private methods
     void connectAll(void);
     void refreshUi(void);
+    void refreshRenderUi(SpectrumRenderStats const &stats);
+    void schedule(float *data, int size);
 
   public:
     explicit MainSpectrum(QWidget *parent = nullptr);
     ~MainSpectrum();
 
-    // Actions
+    // Actions. Data must stay valid and unchanged until the next feed,
+    // like the output of an Averager.
     void feed(float *data, int size);
 
+    // High resolution frames of the `rate' Hz around the center
+    // frequency. Once one arrives, full-span frames only feed the
+    // persistence display, until leaveZoomSpectrum() is called. The view
+    // is kept centered on the center frequency meanwhile.
+    void feedZoomSpectrum(float *data, int size, unsigned int rate);
+    void leaveZoomSpectrum(void);
+
     // Setters
     void setThrottling(bool);
     void setCaptureMode(CaptureMode mode);
@@ -79,10 +137,29 @@ namespace SigDigger {
     void setColorConfig(ColorConfig const &cfg);
     void setPeakHold(bool);
     void setPeakDetect(bool);
+    void setPersistence(bool);
+    void setPersistenceTime(qreal seconds);
+    void setPersistencePalette(Palette const &palette);
+
+    // Per-bin noise floor, same lifetime rules as feed
+    void setNoiseFloor(const float *floor, int size);
+
+    // Difference against a reference spectrum, same lifetime rules as
+    // feed. Bins beyond the threshold are highlighted below the
+    // waterfall, which is hidden again by a null diff.
+    void setReferenceDiff(const float *diff, int size, float threshold);
+
+    // Shown while it has bands. Repainted along with the spectrum.
+    void setBandMeter(const BandMeter *meter);
+
+    // Shown while it has entries, along the span set by the zoom.
+    // Repaint with setBookmarks() again after changing the store.
+    void setBookmarks(const BookmarkStore *store);
 
     void setZoom(unsigned int zoom);
     void setSampleRate(unsigned int rate);
     void setTimeSpan(quint64 ms);
+    void setRenderRate(unsigned int fps);
 
     // Getters
     bool getThrottling(void) const;
@@ -92,6 +169,14 @@ namespace SigDigger {
     qint64 getLnbFreq(void) const;
     unsigned int getBandwidth(void) const;
     unsigned int getZoom(void) const;
+    unsigned int getDisplayBins(void) const;
+    unsigned int getRenderRate(void) const;
+    bool getPersistence(void) const;
+    SpectrumRenderStats getRenderStats(void);
+
+    // Time spent painting since the widget was created (ns). Unlike the
+    // render statistics, reading it resets nothing.
+    qint64 getRenderTime(void) const;
 
     static int getFrequencyUnits(qint64 frew);
 
@@ -102,6 +187,7 @@ namespace SigDigger {
     void loChanged(qint64);
     void rangeChanged(float, float);
     void zoomChanged(float);
+    void bookmarkSelected(qint64);
 
   public slots:
     void onRangeChanged(float, float);
@@ -111,6 +197,7 @@ namespace SigDigger {
     void onLoChanged(void);
     void onNewZoomLevel(float);
     void onLnbFrequencyChanged(void);
+    void onRenderTick(void);
   };
 }
 
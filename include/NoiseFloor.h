@@ -0,0 +1,106 @@
+//
+//    NoiseFloor.h: Streaming noise floor estimator
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+#ifndef NOISEFLOOR_H
+#define NOISEFLOOR_H
+
+#include <Suscan/Messages/PSDMessage.h>
+#include <vector>
+
+// Bands the PSD is split into, whatever the FFT size
+#define SIGDIGGER_NOISE_FLOOR_BANDS   256
+
+// Observations after which older ones start to weigh half as much
+#define SIGDIGGER_NOISE_FLOOR_WINDOW  512
+
+namespace SigDigger {
+  //
+  // Tracks a low quantile over time of the mean level of each band of the
+  // PSD, with one P^2 sketch (five markers, no stored samples) per band.
+  // Marker counts are halved once they reach the window, so the estimate
+  // follows slow changes of the floor. The per-bin floor is interpolated
+  // between band centers. An update costs one pass over the PSD plus a
+  // constant amount of work per band. Meant to be fed the full resolution
+  // PSD: estimates start over whenever the number of bins changes.
+  //
+  class NoiseFloor {
+      struct Sketch {
+        float q[5];         // Marker heights
+        float n[5];         // Marker positions
+        float np[5];        // Desired positions
+        unsigned int count;
+      };
+
+      float quantile = .2f;
+      float dn[5];
+
+      size_t bins = 0;
+      size_t band = 1;      // Bins per band
+      size_t bands = 0;
+
+      std::vector<Sketch> sketches;
+      std::vector<float> estimates;  // Per band
+      std::vector<float> trace;      // Per bin
+      std::vector<float> scratch;
+      float floor = 0;
+
+      void resize(size_t size);
+      void update(Sketch &s, float x);
+      float estimate(Sketch const &s) const;
+      void interpolate(void);
+
+    public:
+      NoiseFloor();
+
+      void feed(Suscan::PSDMessage const &m);
+      void feed(const float *psd, size_t size);
+
+      // Quantile of the band levels taken as the floor, in (0, 1)
+      void setQuantile(float quantile);
+      void reset(void);
+
+      // dB, per bin of the last PSD. Valid until the next feed.
+      const float *
+      getTrace(void) const
+      {
+        return this->trace.data();
+      }
+
+      size_t
+      size(void) const
+      {
+        return this->bins;
+      }
+
+      // Median of the band floors
+      float
+      getFloor(void) const
+      {
+        return this->floor;
+      }
+
+      bool
+      isValid(void) const
+      {
+        return this->bins > 0;
+      }
+  };
+}
+
+#endif // NOISEFLOOR_H
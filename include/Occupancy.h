@@ -0,0 +1,172 @@
+//
+//    Occupancy.h: Spectrum occupancy and duty cycle statistics
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+
+#ifndef OCCUPANCY_H
+#define OCCUPANCY_H
+
+#include <QtGlobal>
+#include <vector>
+#include <cstdint>
+
+// Frames summed in single precision before being folded into the totals
+#define SIGDIGGER_OCCUPANCY_FOLD     256
+
+// Time x frequency heatmap size. Rows are merged in pairs when full.
+#define SIGDIGGER_OCCUPANCY_ROWS     512
+#define SIGDIGGER_OCCUPANCY_COLUMNS  1024
+
+// Time covered by a heatmap row before any merge
+#define SIGDIGGER_OCCUPANCY_SLOT_MS  1000
+
+namespace SigDigger {
+  //
+  // Copy of the statistics at some point, safe to hand to another thread
+  //
+  struct OccupancySnapshot {
+    qint64 fc = 0;
+    unsigned int rate = 0;
+    float threshold = 0;
+    bool relative = false;
+    qint64 start = 0;         // ms since epoch
+    qint64 end = 0;
+    quint64 frames = 0;
+
+    // Per bin, DC centered
+    std::vector<float> duty;  // Fraction of frames above the threshold
+    std::vector<float> mean;  // dB, averaged in linear power
+    std::vector<float> max;   // dB
+
+    // Duty cycle, rows x columns, oldest row first
+    unsigned int rows = 0;
+    unsigned int columns = 0;
+    qint64 slot = 0;          // ms per row
+    std::vector<float> heatmap;
+    std::vector<qint64> rowTimes;
+  };
+
+  //
+  // Accumulates, for every bin, how many frames were above a threshold
+  // (absolute, or relative to a noise floor trace), the sum of the linear
+  // power and the maximum. One branchless pass per frame. A coarse
+  // time x frequency duty cycle heatmap is kept too: each row closes
+  // after `slot' ms, and once all rows are used adjacent pairs are merged
+  // and the slot doubles. Memory depends on the FFT size only, however
+  // long it runs.
+  //
+  class Occupancy {
+    public:
+      // Why the statistics last started over on their own
+      enum Restart {
+        RESTART_NONE,
+        RESTART_RETUNED,   // Center frequency or sample rate
+        RESTART_FFT_SIZE
+      };
+
+    private:
+      float threshold = 10;
+      bool relative = true;
+
+      size_t bins = 0;
+      qint64 fc = 0;
+      unsigned int rate = 0;
+      quint64 frames = 0;
+      qint64 start = -1;
+      qint64 last = 0;
+      Restart restart = RESTART_NONE;
+      qint64 restartTime = 0;
+
+      std::vector<uint32_t> hits;
+      std::vector<float> acc;      // Linear, last frames not yet folded
+      std::vector<double> sums;    // Linear
+      std::vector<float> max;
+      unsigned int pending = 0;
+
+      // Heatmap
+      unsigned int columns = 0;
+      std::vector<uint32_t> mark;  // Hits when the current row started
+      quint64 markFrames = 0;
+      qint64 rowStart = 0;
+      qint64 slot = SIGDIGGER_OCCUPANCY_SLOT_MS;
+      std::vector<float> heatmap;
+      std::vector<quint64> rowFrames;
+      std::vector<qint64> rowTimes;
+      unsigned int rows = 0;
+
+      void resize(size_t size);
+      void fold(void);
+      void rowDuty(float *out) const;
+      void closeRow(qint64 now);
+      void mergeRows(void);
+
+    public:
+      void setThreshold(float threshold, bool relative);
+      void reset(void);
+
+      // floor may be null, and must have `size' entries otherwise
+      void feed(
+          const float *psd,
+          const float *floor,
+          size_t size,
+          qint64 fc,
+          unsigned int rate,
+          qint64 now);
+
+      void snapshot(OccupancySnapshot &snap) const;
+
+      quint64
+      getFrames(void) const
+      {
+        return this->frames;
+      }
+
+      // ms
+      qint64
+      getElapsed(void) const
+      {
+        return this->frames > 0 ? this->last - this->start : 0;
+      }
+
+      size_t
+      size(void) const
+      {
+        return this->bins;
+      }
+
+      // Cleared by reset(), so only restarts the user did not ask for
+      // are reported
+      Restart
+      getRestart(void) const
+      {
+        return this->restart;
+      }
+
+      // ms since epoch
+      qint64
+      getRestartTime(void) const
+      {
+        return this->restartTime;
+      }
+
+      // Duty cycle averaged over all bins
+      float getMeanDuty(void) const;
+  };
+}
+
+#endif // OCCUPANCY_H
@@ -0,0 +1,78 @@
+//
+//    OccupancyDialog.h: Spectrum occupancy statistics
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+
+#ifndef OCCUPANCYDIALOG_H
+#define OCCUPANCYDIALOG_H
+
+#include <QDialog>
+#include <QTimer>
+
+#include "Occupancy.h"
+#include "OccupancyExporter.h"
+#include "Palette.h"
+
+// How often the summary is refreshed (ms)
+#define SIGDIGGER_OCCUPANCY_DIALOG_REFRESH_MS 500
+
+namespace Ui {
+  class OccupancyDialog;
+}
+
+namespace SigDigger {
+  //
+  // Controls of the occupancy statistics. Once started they keep being
+  // accumulated with the dialog closed, and can be exported at any time
+  // without stopping them.
+  //
+  class OccupancyDialog : public QDialog
+  {
+    Q_OBJECT
+
+    Occupancy *occupancy = nullptr; // Weak
+    OccupancyExporter *exporter = nullptr;
+    Palette palette;
+    QTimer *refreshTimer = nullptr;
+
+    void connectAll(void);
+    void refreshUi(void);
+    void exportTo(OccupancyExporter::Format format);
+
+  public:
+    explicit OccupancyDialog(QWidget *parent = nullptr);
+    ~OccupancyDialog() override;
+
+    void setOccupancy(Occupancy *occupancy);
+    void setColorPalette(Palette const &palette);
+    bool isRunning(void) const;
+
+  public slots:
+    void onRefresh(void);
+    void onParamsChanged(void);
+    void onReset(void);
+    void onExportCsv(void);
+    void onExportPng(void);
+    void onExportFinished(QString path, QString error);
+
+  private:
+    Ui::OccupancyDialog *ui = nullptr;
+  };
+}
+
+#endif // OCCUPANCYDIALOG_H
@@ -0,0 +1,102 @@
+//
+//    OccupancyExporter.h: Background export of occupancy statistics
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+
+#ifndef OCCUPANCYEXPORTER_H
+#define OCCUPANCYEXPORTER_H
+
+#include <QObject>
+#include <QThread>
+
+#include "Occupancy.h"
+#include "Palette.h"
+
+namespace SigDigger {
+  class OccupancyExporter;
+
+  class OccupancyExporterWorker : public QObject {
+      Q_OBJECT
+
+      OccupancyExporter *instance;
+
+      QString writeCsv(void);
+      QString writePng(void);
+
+    private slots:
+      void onExport(void);
+
+    public:
+      OccupancyExporterWorker(OccupancyExporter *instance);
+
+    signals:
+      void finished(QString error);
+  };
+
+  //
+  // Writes an OccupancySnapshot to disk in a thread of its own, so that a
+  // long capture does not stall while a large table or image is being
+  // written. Either a CSV with one line per bin, or a PNG of the duty
+  // cycle heatmap (time downwards, frequency across). One export at a
+  // time.
+  //
+  class OccupancyExporter : public QObject
+  {
+      Q_OBJECT
+
+    public:
+      enum Format {
+        FORMAT_CSV,
+        FORMAT_PNG
+      };
+
+    private:
+      OccupancySnapshot snapshot;
+      Format format = FORMAT_CSV;
+      QString path;
+      Palette palette;
+      bool busy = false;
+
+      QThread workerThread;
+      OccupancyExporterWorker workerObject;
+
+    public:
+      OccupancyExporter(QObject *parent = nullptr);
+      ~OccupancyExporter() override;
+
+      // Takes the snapshot over. False if an export is in progress.
+      bool exportTo(
+          OccupancySnapshot &snapshot,
+          Format format,
+          QString const &path,
+          Palette const &palette);
+
+      bool isBusy(void) const;
+
+      friend class OccupancyExporterWorker;
+
+    signals:
+      void start(void);
+      void finished(QString path, QString error);
+
+    public slots:
+      void onFinished(QString error);
+  };
+}
+
+#endif // OCCUPANCYEXPORTER_H
@@ -27,6 +27,10 @@
 #define SIGDIGGER_PALETTE_MAX_STOPS 256
 #define SIGDIGGER_PALETTE_BITMAP_SZ ((SIGDIGGER_PALETTE_MAX_STOPS + 7) / 8)
 
+// Entries of the packed ARGB lookup table, interpolated between stops
+#define SIGDIGGER_PALETTE_LUT_SIZE  4096
+#define SIGDIGGER_PALETTE_MAP_BLOCK 256
+
 #define SIGDIGGER_PALETTE_THUMB_WIDTH  64
 #define SIGDIGGER_PALETTE_THUMB_HEIGHT 20
 
@@ -35,9 +39,11 @@ namespace SigDigger {
       std::string name;
       QColor gradient[SIGDIGGER_PALETTE_MAX_STOPS];
       uint8_t bitmap[SIGDIGGER_PALETTE_BITMAP_SZ];
+      QRgb lut[SIGDIGGER_PALETTE_LUT_SIZE];
       QImage thumbnail;
 
       void updateThumbnail(void);
+      void updateLut(void);
 
     public:
       Palette();
@@ -48,6 +54,14 @@ namespace SigDigger {
       void deserialize(const Suscan::Object &obj);
       void addStop(unsigned int stop, const QColor &color);
 
+      // Maps dB values in [min, max] to pixels, in a single pass
+      void map(
+          const float *db,
+          QRgb *pixels,
+          size_t size,
+          float min,
+          float max) const;
+
       const QImage &
       getThumbnail(void) const
       {
@@ -65,6 +79,12 @@ namespace SigDigger {
       {
         return this->gradient;
       }
+
+      const QRgb *
+      getLut(void) const
+      {
+        return this->lut;
+      }
   };
 }
 
@@ -0,0 +1,62 @@
+//
+//    PeakResample.h: Peak-preserving resample of spectrum rows
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+#ifndef PEAKRESAMPLE_H
+#define PEAKRESAMPLE_H
+
+#include <cstddef>
+
+//
+// Column j of `width' takes the peak of the input range
+// [j * size / width, (j + 1) * size / width), so narrow carriers survive
+// any reduction. When there are fewer bins than columns, every column
+// takes the bin it falls on. Only columns [first, first + count) are
+// written, out[0] being column `first'.
+//
+template <typename T>
+static inline void
+peakResample(
+    const T *__restrict__ in,
+    size_t size,
+    T *__restrict__ out,
+    size_t width,
+    size_t first,
+    size_t count)
+{
+  for (size_t j = 0; j < count; ++j) {
+    size_t start = (first + j) * size / width;
+    size_t end   = (first + j + 1) * size / width;
+    T acc = in[start];
+
+#pragma omp simd reduction(max:acc)
+    for (size_t i = start + 1; i < end; ++i)
+      acc = in[i] > acc ? in[i] : acc;
+
+    out[j] = acc;
+  }
+}
+
+template <typename T>
+static inline void
+peakResample(const T *in, size_t size, T *out, size_t width)
+{
+  peakResample(in, size, out, width, 0, width);
+}
+
+#endif // PEAKRESAMPLE_H
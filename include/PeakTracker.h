@@ -0,0 +1,126 @@
+//
+//    PeakTracker.h: Spectral peak tracker
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+#ifndef PEAKTRACKER_H
+#define PEAKTRACKER_H
+
+#include <QtGlobal>
+#include <vector>
+#include <cstddef>
+
+#define SIGDIGGER_PEAK_TRACKER_MAX_PEAKS  256
+
+// A track follows a peak as long as it moves less than this per update
+#define SIGDIGGER_PEAK_TRACKER_MATCH_BINS 3
+
+// Updates a track survives without a matching peak
+#define SIGDIGGER_PEAK_TRACKER_HOLD       10
+
+namespace SigDigger {
+  struct TrackedPeak {
+    quint64 id = 0;
+    bool active = false;
+    qreal freq = 0;       // Absolute, Hz
+    qreal firstFreq = 0;
+    float power = 0;      // dB
+    float maxPower = 0;
+    float snr = 0;        // Above the noise floor
+    qint64 start = 0;     // ms since epoch
+    qint64 last = 0;
+    unsigned int misses = 0;
+
+    qreal
+    getDrift(void) const
+    {
+      return this->freq - this->firstFreq;
+    }
+  };
+
+  //
+  // Follows the strongest local maxima of the PSD from one update to the
+  // next. A peak starts a track when it rises `threshold' dB above the
+  // local noise floor, and keeps it while it stays above threshold -
+  // hysteresis.
+  // Every update is a single scan of the PSD plus work proportional to the
+  // number of tracks; buffers are only reallocated when the PSD grows or
+  // the number of tracks changes.
+  //
+  class PeakTracker {
+      struct Candidate {
+        float bin;        // Interpolated
+        float power;
+        float floor;
+        bool used;
+      };
+
+      unsigned int maxPeaks = 16;
+      float threshold = 10;
+      float hysteresis = 3;
+      quint64 nextId = 1;
+
+      std::vector<TrackedPeak> tracks;
+      std::vector<Candidate> candidates; // Min-heap by power
+
+      void collect(const float *psd, const float *floor, size_t size);
+
+    public:
+      PeakTracker();
+
+      void setMaxPeaks(unsigned int peaks);
+      void setThreshold(float dB);
+      void setHysteresis(float dB);
+      void clear(void);
+
+      // floor is the noise floor of each bin of psd, in dB
+      void feed(
+          const float *psd,
+          const float *floor,
+          size_t size,
+          qint64 fc,
+          unsigned int rate,
+          qint64 now);
+
+      // All track slots. Only those marked active are current.
+      std::vector<TrackedPeak> const &
+      getPeaks(void) const
+      {
+        return this->tracks;
+      }
+
+      float
+      getThreshold(void) const
+      {
+        return this->threshold;
+      }
+
+      float
+      getHysteresis(void) const
+      {
+        return this->hysteresis;
+      }
+
+      unsigned int
+      getMaxPeaks(void) const
+      {
+        return this->maxPeaks;
+      }
+  };
+}
+
+#endif // PEAKTRACKER_H
@@ -0,0 +1,72 @@
+//
+//    PeakTrackerDialog.h: Tracked peak list
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+#ifndef PEAKTRACKERDIALOG_H
+#define PEAKTRACKERDIALOG_H
+
+#include <QDialog>
+#include <QTimer>
+
+#include "PeakTracker.h"
+#include "NoiseFloor.h"
+
+// How often the table is refreshed (ms)
+#define SIGDIGGER_PEAK_DIALOG_REFRESH_MS 250
+
+namespace Ui {
+  class PeakTrackerDialog;
+}
+
+namespace SigDigger {
+  //
+  // Sortable table of the peaks followed by a PeakTracker. The tracker is
+  // only fed while this dialog is visible. Clicking a peak asks to tune
+  // to it.
+  //
+  class PeakTrackerDialog : public QDialog
+  {
+    Q_OBJECT
+
+    PeakTracker *tracker = nullptr; // Weak
+    const NoiseFloor *noiseFloor = nullptr; // Weak
+    QTimer *refreshTimer = nullptr;
+
+    void connectAll(void);
+
+  public:
+    explicit PeakTrackerDialog(QWidget *parent = nullptr);
+    ~PeakTrackerDialog() override;
+
+    void setTracker(PeakTracker *tracker);
+    void setNoiseFloor(const NoiseFloor *noiseFloor);
+
+  public slots:
+    void onRefresh(void);
+    void onParamsChanged(void);
+    void onPeakClicked(int row, int column);
+
+  signals:
+    void tune(qint64 freq);
+
+  private:
+    Ui::PeakTrackerDialog *ui = nullptr;
+  };
+}
+
+#endif // PEAKTRACKERDIALOG_H
@@ -0,0 +1,88 @@
+//
+//    Persistence.h: Decaying (frequency, power) histogram
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+#ifndef PERSISTENCE_H
+#define PERSISTENCE_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "Palette.h"
+
+// PSD bins are processed in tiles of this many columns
+#define SIGDIGGER_PERSISTENCE_TILE      1024
+
+// Renormalize the cells once the hit weight grows past this
+#define SIGDIGGER_PERSISTENCE_MAX_GAIN  1e20f
+
+// Densities shown, in powers of two below a hit on every update
+#define SIGDIGGER_PERSISTENCE_RANGE_LOG2 12.f
+
+namespace SigDigger {
+  //
+  // Histogram of the PSD: cell (x, y) counts how often column x was at
+  // the power level of row y, with old hits fading exponentially. Rather
+  // than scaling every cell on each update, the weight of new hits grows
+  // by 1 / decay and the cells are rescaled once in a while, so an update
+  // only touches one cell per column.
+  //
+  class Persistence {
+      unsigned int width = 0;
+      unsigned int height = 0;
+      float min = -120;
+      float max = 0;
+      float decay = .95f;
+      float gain = 1;
+
+      std::vector<float> cells;     // Row 0 is the top of the range
+      std::vector<float> column;    // Per tile
+      std::vector<int32_t> rows;    // Per tile
+      std::vector<float> line;      // Per rendered row
+
+      void renormalize(void);
+
+    public:
+      void resize(unsigned int width, unsigned int height);
+      void setRange(float min, float max);
+      void setDecay(float decay);
+      void clear(void);
+
+      // Peak of the bins falling in each column goes to the histogram
+      void feed(const float *psd, size_t size);
+
+      // Density of row y, through the palette. Cells hit on every update
+      // get the top color.
+      void render(unsigned int y, QRgb *pixels, Palette const &palette);
+
+      unsigned int
+      getWidth(void) const
+      {
+        return this->width;
+      }
+
+      unsigned int
+      getHeight(void) const
+      {
+        return this->height;
+      }
+  };
+}
+
+#endif // PERSISTENCE_H
@@ -0,0 +1,71 @@
+//
+//    PersistenceView.h: Persistence spectrum display
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+#ifndef PERSISTENCEVIEW_H
+#define PERSISTENCEVIEW_H
+
+#include <QFrame>
+#include <QImage>
+#include <QVector>
+#include <QPointF>
+
+#include "Persistence.h"
+#include "Palette.h"
+
+// dB between horizontal grid lines
+#define SIGDIGGER_PERSISTENCE_VIEW_GRID_DB 10
+
+namespace SigDigger {
+  //
+  // Shows how often each frequency sits at each power level, over the
+  // whole sample rate. The histogram has one cell per pixel, so it is
+  // reset whenever the widget is resized.
+  //
+  class PersistenceView : public QFrame
+  {
+    Q_OBJECT
+
+    Persistence persistence;
+    Palette palette;
+    QImage image;
+    float min = -120;
+    float max = 0;
+
+    // Noise floor overlay. Owned by the caller, like PSD frames.
+    const float *floor = nullptr;
+    int floorSize = 0;
+    QVector<QPointF> floorLine;
+
+  protected:
+    void paintEvent(QPaintEvent *) override;
+    void resizeEvent(QResizeEvent *) override;
+
+  public:
+    explicit PersistenceView(QWidget *parent = nullptr);
+
+    void feed(const float *data, int size);
+    void setColorPalette(Palette const &palette);
+    void setRange(float min, float max);
+    void setDecay(float decay);
+    void setNoiseFloor(const float *floor, int size);
+    void clear(void);
+  };
+}
+
+#endif // PERSISTENCEVIEW_H
@@ -0,0 +1,88 @@
+//
+//    PowerMath.h: Vectorizable dB / linear power conversions
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+#ifndef POWERMATH_H
+#define POWERMATH_H
+
+#include <cstdint>
+#include <cstring>
+
+// 10^(x / 10) = 2^(x * log2(10) / 10)
+#define SIGDIGGER_DB_TO_LOG2 .332192809f
+#define SIGDIGGER_LOG2_TO_DB 3.01029996f
+
+// Bit pattern of 1e-30f, which keeps the log away from rounding noise in
+// sums. Positive floats sort like their bit patterns.
+#define SIGDIGGER_POWER_MIN_POWER_BITS 0x0da24260
+
+// Adding 1.5 * 2^23 rounds to an integer, left in the low mantissa bits
+#define SIGDIGGER_POWER_ROUND_MAGIC 12582912.f
+#define SIGDIGGER_POWER_ROUND_BITS  0x4b400000
+
+//
+// Library exp / log calls keep the loops from vectorizing (unless we
+// build with -ffast-math), so linear power conversions use these. Errors
+// are below 1e-6 relative, far under the dB resolution of any display.
+// Clamping is done on integers: float selects followed by arithmetic are
+// not if-converted while FP traps are honored.
+//
+static inline float
+powerFromLog2(float y)
+{
+  int32_t bits, n;
+  float t, f, e;
+
+  t = y + SIGDIGGER_POWER_ROUND_MAGIC;
+  memcpy(&bits, &t, sizeof(float));
+
+  n = bits - SIGDIGGER_POWER_ROUND_BITS;
+  n = n < -126 ? -126 : n;
+  n = n > 127 ? 127 : n;
+
+  // e^f, f in [-ln(2) / 2, ln(2) / 2]
+  f = (y - (t - SIGDIGGER_POWER_ROUND_MAGIC)) * .693147181f;
+  bits = (n + 127) << 23;
+  memcpy(&e, &bits, sizeof(float));
+
+  return e * (1.f + f * (1.f + f * (.5f + f * (1.f / 6 + f * (1.f / 24
+      + f * (1.f / 120 + f * (1.f / 720)))))));
+}
+
+static inline float
+log2FromPower(float x)
+{
+  int32_t bits, e;
+  float m, t, t2;
+
+  memcpy(&bits, &x, sizeof(float));
+  bits = bits < SIGDIGGER_POWER_MIN_POWER_BITS ? SIGDIGGER_POWER_MIN_POWER_BITS : bits;
+
+  e = ((bits >> 23) & 0xff) - 127;
+  bits = (bits & 0x7fffff) | 0x3f800000;
+  memcpy(&m, &bits, sizeof(float));
+
+  // ln(m) = 2 atanh((m - 1) / (m + 1)), m in [1, 2)
+  t  = (m - 1.f) / (m + 1.f);
+  t2 = t * t;
+
+  return e + 2.88539008f * t * (1.f + t2 * (1.f / 3 + t2 * (1.f / 5
+      + t2 * (1.f / 7 + t2 * (1.f / 9)))));
+}
+
+#endif // POWERMATH_H
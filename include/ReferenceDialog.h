@@ -0,0 +1,73 @@
+//
+//    ReferenceDialog.h: Reference spectrum controls
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+#ifndef REFERENCEDIALOG_H
+#define REFERENCEDIALOG_H
+
+#include <QDialog>
+#include <QTimer>
+
+#include "ReferenceTrace.h"
+
+// How often the status is refreshed (ms)
+#define SIGDIGGER_REFERENCE_DIALOG_REFRESH_MS 250
+
+namespace Ui {
+  class ReferenceDialog;
+}
+
+namespace SigDigger {
+  //
+  // Captures, loads and saves the reference spectrum, and turns the
+  // difference view on and off. Both the capture and the difference
+  // view go on with the dialog closed.
+  //
+  class ReferenceDialog : public QDialog
+  {
+    Q_OBJECT
+
+    ReferenceTrace *reference = nullptr; // Weak
+    QTimer *refreshTimer = nullptr;
+
+    void connectAll(void);
+    void refreshUi(void);
+
+  public:
+    explicit ReferenceDialog(QWidget *parent = nullptr);
+    ~ReferenceDialog() override;
+
+    void setReference(ReferenceTrace *reference);
+
+    // Checked, and there is a reference to compare with
+    bool isDiffEnabled(void) const;
+
+  public slots:
+    void onRefresh(void);
+    void onThresholdChanged(void);
+    void onCapture(void);
+    void onLoad(void);
+    void onSave(void);
+    void onClear(void);
+
+  private:
+    Ui::ReferenceDialog *ui = nullptr;
+  };
+}
+
+#endif // REFERENCEDIALOG_H
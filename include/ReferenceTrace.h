@@ -0,0 +1,161 @@
+//
+//    ReferenceTrace.h: Reference spectrum and live difference
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+#ifndef REFERENCETRACE_H
+#define REFERENCETRACE_H
+
+#include <QString>
+#include <vector>
+#include <cstdint>
+
+#define SIGDIGGER_REFERENCE_TRACE_MAGIC   0x46455253 // "SREF"
+#define SIGDIGGER_REFERENCE_TRACE_VERSION 1
+
+namespace SigDigger {
+  // Native byte order, followed by `width' floats (dB, DC centered). A
+  // swapped magic tells a foreign file.
+  struct ReferenceTraceHeader {
+    uint32_t magic;
+    uint32_t version;
+    int64_t  timestamp; // End of the capture, ms since the epoch
+    int64_t  fc;        // Center frequency (Hz)
+    uint32_t rate;      // Sample rate (sps)
+    uint32_t width;
+    uint32_t frames;    // PSDs averaged
+    uint32_t duration;  // Length of the capture (ms)
+  };
+
+  //
+  // A reference spectrum, averaged in linear power over a number of
+  // seconds, and the difference of the live PSD against it. The live PSD
+  // does not need to have the bins, center or rate of the reference: it
+  // is resampled once to the live bins whenever these change, so that
+  // every difference is a single vectorized pass. Bins outside the
+  // reference read as no difference.
+  //
+  class ReferenceTrace {
+      ReferenceTraceHeader header;
+      std::vector<float> level;
+
+      // Capture in progress
+      bool capturing = false;
+      qint64 captureStart = 0;
+      qint64 captureLength = 0;
+      std::vector<float> acc;  // Linear power
+      unsigned int count = 0;
+      int64_t captureFc = 0;
+      unsigned int captureRate = 0;
+
+      // Reference resampled to the live PSD, over [first, last)
+      std::vector<float> aligned;
+      size_t first = 0;
+      size_t last = 0;
+      size_t alignedSize = 0;
+      int64_t alignedFc = 0;
+      unsigned int alignedRate = 0;
+      bool dirty = true;
+
+      // Written on every diff, never shrunk: it may still be on screen
+      std::vector<float> delta;
+      float threshold = 6;
+      size_t deviating = 0;
+
+      void finishCapture(qint64 now);
+      void align(size_t size, int64_t fc, unsigned int rate);
+
+    public:
+      ReferenceTrace();
+
+      // Averages the PSDs fed during the next `ms' milliseconds. Starts
+      // over if the bins, center or rate change in the meantime.
+      void startCapture(qint64 ms, qint64 now);
+      void cancelCapture(void);
+
+      // True when it completes a capture
+      bool feed(
+          const float *psd,
+          size_t size,
+          int64_t fc,
+          unsigned int rate,
+          qint64 now);
+
+      // psd - reference (dB). Valid until the next diff.
+      float *diff(
+          const float *psd,
+          size_t size,
+          int64_t fc,
+          unsigned int rate);
+
+      void clear(void);
+
+      // Empty on success, the reason otherwise
+      QString save(QString const &path) const;
+      QString load(QString const &path);
+
+      // |difference| beyond which a bin counts as deviating (dB)
+      void
+      setThreshold(float threshold)
+      {
+        this->threshold = threshold;
+      }
+
+      float
+      getThreshold(void) const
+      {
+        return this->threshold;
+      }
+
+      // Of the last diff
+      size_t
+      getDeviating(void) const
+      {
+        return this->deviating;
+      }
+
+      // Bins of the last diff covered by the reference
+      size_t
+      getOverlap(void) const
+      {
+        return this->last - this->first;
+      }
+
+      bool
+      isCapturing(void) const
+      {
+        return this->capturing;
+      }
+
+      // In [0, 1]
+      qreal getCaptureProgress(qint64 now) const;
+
+      bool
+      isValid(void) const
+      {
+        return !this->level.empty();
+      }
+
+      ReferenceTraceHeader const &
+      getHeader(void) const
+      {
+        return this->header;
+      }
+  };
+}
+
+#endif // REFERENCETRACE_H
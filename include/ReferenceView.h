@@ -0,0 +1,58 @@
+//
+//    ReferenceView.h: Bins deviating from the reference spectrum
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+#ifndef REFERENCEVIEW_H
+#define REFERENCEVIEW_H
+
+#include <QFrame>
+
+// Height of the strip (pixels)
+#define SIGDIGGER_REFERENCE_VIEW_HEIGHT   32
+
+// Excess over the threshold that fills half the strip (dB)
+#define SIGDIGGER_REFERENCE_VIEW_RANGE_DB 20
+
+namespace SigDigger {
+  //
+  // Highlights the bins of the live spectrum that deviate from the
+  // reference by more than the threshold: above it in red, upwards from
+  // the middle, and below it in blue, downwards. Every pixel column shows
+  // the largest deviation of its bins. Like the persistence display, it
+  // spans the whole sample rate.
+  //
+  class ReferenceView : public QFrame
+  {
+    Q_OBJECT
+
+    // Owned by the caller, like PSD frames
+    const float *diff = nullptr;
+    int size = 0;
+    float threshold = 6;
+
+  protected:
+    void paintEvent(QPaintEvent *) override;
+
+  public:
+    explicit ReferenceView(QWidget *parent = nullptr);
+
+    void setDiff(const float *diff, int size, float threshold);
+  };
+}
+
+#endif // REFERENCEVIEW_H
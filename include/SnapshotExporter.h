@@ -0,0 +1,122 @@
+//
+//    SnapshotExporter.h: Background export of spectrum snapshots
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+#ifndef SNAPSHOTEXPORTER_H
+#define SNAPSHOTEXPORTER_H
+
+#include <QObject>
+#include <QThread>
+#include <QImage>
+#include <memory>
+#include <vector>
+
+#include "WaterfallHistory.h"
+#include "Palette.h"
+
+// Height of the spectrum plot on top of the image (pixels)
+#define SIGDIGGER_SNAPSHOT_PSD_HEIGHT  256
+
+// Waterfall rows exported when the time span is automatic, and at most
+#define SIGDIGGER_SNAPSHOT_AUTO_ROWS   1024
+#define SIGDIGGER_SNAPSHOT_MAX_ROWS    16384
+
+namespace SigDigger {
+  struct SpectrumSnapshot {
+    std::vector<float> psd;   // dB, DC centered
+    int64_t fc = 0;
+    unsigned int rate = 0;
+    int64_t timestamp = 0;    // Microseconds since the epoch
+
+    // Null without waterfall history
+    std::unique_ptr<WaterfallHistorySnapshot> waterfall;
+
+    float psdMin = -120;      // Plot range (dB)
+    float psdMax = 0;
+    float wfMin = -120;       // Waterfall color range (dB)
+    float wfMax = 0;
+  };
+
+  class SnapshotExporter;
+
+  class SnapshotExporterWorker : public QObject {
+      Q_OBJECT
+
+      SnapshotExporter *instance;
+      std::vector<WaterfallHistoryRow> rows; // Of the last export
+
+      void drawPsd(QImage &image);
+      QString writeWaterfall(QString const &base, QImage &image);
+      QString writePsd(QString const &base);
+      QString writeMetadata(QString const &base);
+
+    private slots:
+      void onExport(void);
+
+    public:
+      SnapshotExporterWorker(SnapshotExporter *instance);
+
+    signals:
+      void finished(QString error);
+  };
+
+  //
+  // Writes a SpectrumSnapshot in a thread of its own: a PNG with the
+  // spectrum plot over the waterfall rows (newest on top), the raw dB
+  // values as float32 matrices, and their frequency and time axes as
+  // JSON. The waterfall rows are read from a copy-on-write snapshot of
+  // the history, so the capture goes on while they are encoded. One
+  // export at a time.
+  //
+  class SnapshotExporter : public QObject
+  {
+      Q_OBJECT
+
+      SpectrumSnapshot snapshot;
+      QString path;
+      Palette palette;
+      bool busy = false;
+
+      QThread workerThread;
+      SnapshotExporterWorker workerObject;
+
+    public:
+      SnapshotExporter(QObject *parent = nullptr);
+      ~SnapshotExporter() override;
+
+      // Takes the snapshot over. `path' is that of the PNG, the other
+      // files are named after it. False if an export is in progress.
+      bool exportTo(
+          SpectrumSnapshot &snapshot,
+          QString const &path,
+          Palette const &palette);
+
+      bool isBusy(void) const;
+
+      friend class SnapshotExporterWorker;
+
+    signals:
+      void start(void);
+      void finished(QString path, QString error);
+
+    public slots:
+      void onFinished(QString error);
+  };
+}
+
+#endif // SNAPSHOTEXPORTER_H
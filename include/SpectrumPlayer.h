@@ -0,0 +1,103 @@
+//
+//    SpectrumPlayer.h: PSD log replay
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+#ifndef SPECTRUMPLAYER_H
+#define SPECTRUMPLAYER_H
+
+#include <QObject>
+#include <QTimer>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "SpectrumRecorder.h"
+
+// Replay tick (about 60 frames per second)
+#define SIGDIGGER_SPECTRUM_PLAYER_INTERVAL_MS 16
+
+namespace SigDigger {
+  //
+  // Sequential reader of the files written by SpectrumRecorder
+  //
+  class SpectrumLogReader {
+      FILE *fp = nullptr;
+      SpectrumLogHeader header;
+      std::vector<uint8_t> raw;
+      std::string lastError;
+
+    public:
+      ~SpectrumLogReader();
+
+      bool open(std::string const &path);
+      void close(void);
+
+      // Next row, back in dB. False at the end of the file.
+      bool read(SpectrumLogRow &row, std::vector<float> &data);
+
+      std::string
+      getError(void) const
+      {
+        return this->lastError;
+      }
+  };
+
+  //
+  // Replays a spectrum log as fast as the screen allows: every tick
+  // merges up to `speed' rows (per-bin maximum, so short bursts are not
+  // lost) into one frame. Rows are only merged while the tuning and
+  // width stay the same.
+  //
+  class SpectrumPlayer : public QObject
+  {
+      Q_OBJECT
+
+      SpectrumLogReader reader;
+      QTimer *timer = nullptr;
+      unsigned int speed = 32;
+
+      std::vector<float> merged;
+      std::vector<float> data;
+      SpectrumLogRow next;
+      bool pending = false;
+      QString lastError;
+
+    public:
+      explicit SpectrumPlayer(QObject *parent = nullptr);
+
+      bool open(QString const &path);
+      void setSpeed(unsigned int rows);
+      void stop(void);
+      bool isPlaying(void) const;
+      QString getLastError(void) const;
+
+    signals:
+      void frame(
+          float *data,
+          int size,
+          qint64 fc,
+          unsigned int rate,
+          qint64 timestamp);
+      void finished(void);
+
+    private slots:
+      void onTimeout(void);
+  };
+}
+
+#endif // SPECTRUMPLAYER_H
@@ -0,0 +1,166 @@
+//
+//    SpectrumRecorder.h: Compact long-term PSD log
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+#ifndef SPECTRUMRECORDER_H
+#define SPECTRUMRECORDER_H
+
+#include <QObject>
+#include <QThread>
+#include <QMutex>
+#include <atomic>
+#include <vector>
+#include <cstdint>
+
+#define SIGDIGGER_SPECTRUM_LOG_MAGIC     0x4c505353 // "SSPL"
+#define SIGDIGGER_SPECTRUM_LOG_VERSION   1
+
+// Same quantization range as the waterfall history. Steps are ~0.8 dB
+// with 8 bits and ~0.003 dB with 16.
+#define SIGDIGGER_SPECTRUM_LOG_DB_MIN    -160.f
+#define SIGDIGGER_SPECTRUM_LOG_DB_MAX    40.f
+
+// Each of the two buffers (bytes)
+#define SIGDIGGER_SPECTRUM_LOG_BUFFER    (4 << 20)
+
+// Buffered rows are handed to the writer at least this often, so a slow
+// log does not sit in memory
+#define SIGDIGGER_SPECTRUM_LOG_FLUSH_MS  1000
+
+namespace SigDigger {
+  // Native byte order. A swapped magic tells a foreign file.
+  struct SpectrumLogHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t bits;      // 8 or 16
+    uint32_t reserved;
+    float    dbMin;
+    float    dbMax;
+  };
+
+  struct SpectrumLogRow {
+    int64_t  timestamp; // Microseconds since the epoch
+    int64_t  fc;        // Center frequency (Hz)
+    uint32_t rate;      // Sample rate (sps)
+    uint32_t width;     // Bins that follow, DC centered
+  };
+
+  class SpectrumRecorder;
+
+  class SpectrumRecorderWorker : public QObject {
+      Q_OBJECT
+
+      bool failed = false;
+      SpectrumRecorder *instance;
+
+    private slots:
+      void onCommit(void);
+
+    public:
+      SpectrumRecorderWorker(SpectrumRecorder *instance);
+
+    signals:
+      void writeFinished(quint64 bytes);
+      void error(QString);
+  };
+
+  //
+  // Writes quantized PSD rows to a file, with the double buffer and worker
+  // thread scheme of GenericDataSaver: rows are packed into one buffer in
+  // the GUI thread while the other one is written. Only one row every
+  // `interval' PSDs is kept, either the last one or the per-bin maximum
+  // of all of them, at no more than `width' bins (peak preserving).
+  // Whatever is left is written when the recorder is destroyed.
+  //
+  class SpectrumRecorder : public QObject
+  {
+      Q_OBJECT
+
+    public:
+      enum Mode {
+        MODE_DECIMATE,
+        MODE_MAX
+      };
+
+    private:
+      int fd = -1;
+      unsigned int bits;
+      Mode mode = MODE_DECIMATE;
+      unsigned int interval = 1;
+      unsigned int maxWidth = 0;   // 0: full resolution
+
+      // Row in progress
+      std::vector<float> row;
+      std::vector<float> line;
+      std::vector<uint16_t> quantized;
+      unsigned int frames = 0;
+      int64_t fc = 0;
+      unsigned int rate = 0;
+
+      std::vector<uint8_t> buffers[2];
+      unsigned int buffer = 0;
+      size_t ptr = 0;
+      size_t committedSize = 0;
+      std::atomic<bool> bufferReady;
+      int64_t lastCommit = 0;
+      QString lastError;
+      bool failed = false;
+
+      QThread workerThread;
+      SpectrumRecorderWorker workerObject;
+      QMutex dataMutex;
+
+      quint64 size = 0;
+      quint64 rows = 0;
+
+      bool writeAll(const uint8_t *data, size_t len);
+      void append(int64_t timestamp);
+      void doCommit(int64_t now);
+
+    public:
+      SpectrumRecorder(int fd, unsigned int bits, QObject *parent = nullptr);
+      ~SpectrumRecorder() override;
+
+      void setMode(Mode mode);
+      void setInterval(unsigned int frames);
+      void setMaxWidth(unsigned int width);
+
+      void feed(
+          const float *psd,
+          size_t size,
+          int64_t fc,
+          unsigned int rate,
+          int64_t timestamp);
+
+      quint64 getSize(void) const;
+      quint64 getRows(void) const;
+      QString getLastError(void) const;
+
+      friend class SpectrumRecorderWorker;
+
+    signals:
+      void commit(void);
+      void stopped(void);
+      void swamped(void);
+
+    public slots:
+      void onError(QString);
+  };
+}
+
+#endif // SPECTRUMRECORDER_H
@@ -22,6 +22,7 @@
 
 #include <QObject>
 #include <QThread>
+#include <atomic>
 
 #include <Suscan/Compat.h>
 #include <Suscan/Source.h>
@@ -50,6 +51,13 @@ namespace Suscan {
     AsyncThread *asyncThread = nullptr;
     MQ mq;
 
+    // PSD decimation, applied by the async thread
+    std::atomic<SUSCOUNT> psdBins{0};
+    std::atomic<PSDMessage::Detector> psdDetector{PSDMessage::DETECTOR_PEAK};
+
+    // Data messages emitted by the async thread and not yet delivered
+    std::atomic<unsigned int> pending{0};
+
     static bool registered;
     static void assertTypeRegistration(void);
 
@@ -63,10 +71,12 @@ namespace Suscan {
 
   public slots:
     void captureMessage(quint32 type, void *data);
+    void capturePSD(const Suscan::PSDMessage &message);
 
   public:
     SUSCOUNT getSampleRate(void) const;
     SUSCOUNT getMeasuredSampleRate(void) const;
+    unsigned int getPendingMessages(void) const;
 
     void *read(uint32_t &type);
     void registerBaseBandFilter(suscan_analyzer_baseband_filter_func_t, void *);
@@ -79,6 +89,7 @@ namespace Suscan {
     void setDCRemove(bool remove);
     void setIQReverse(bool reverse);
     void setAGC(bool enabled);
+    void setPSDDecimation(SUSCOUNT bins, PSDMessage::Detector detector);
 
     void halt(void);
 
@@ -114,6 +125,7 @@ namespace Suscan {
 
   signals:
     void message(quint32 type, void *data);
+    void psd(const Suscan::PSDMessage &message);
   };
 
 };
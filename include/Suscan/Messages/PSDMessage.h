@@ -24,16 +24,47 @@
 
 #include <analyzer/analyzer.h>
 
+#include <memory>
+#include <vector>
+
 namespace Suscan {
   class PSDMessage: public Message {
   private:
     struct suscan_analyzer_psd_msg *message = nullptr; // Convenience reference
+    std::shared_ptr<std::vector<SUFLOAT>> display;     // Decimated copy (dB)
 
   public:
+    // How bins are merged when the PSD is decimated
+    enum Detector {
+      DETECTOR_PEAK,
+      DETECTOR_MEAN,
+      DETECTOR_MIN
+    };
+
+    // Full resolution PSD (dB, DC centered)
     SUSCOUNT size(void) const;
     unsigned int getSampleRate(void) const;
     const SUFLOAT *get(void) const;
 
+    // PSD reduced for display. Same as the above if it was not reduced.
+    SUSCOUNT getDisplaySize(void) const;
+    const SUFLOAT *getDisplay(void) const;
+
+    // Centers DC and converts the PSD to dB in place. If it has more than
+    // `bins' bins (and bins is not 0), a copy reduced to that many bins
+    // is kept for display. Meant to be called once, before the message
+    // is handed to other threads.
+    void prepare(SUSCOUNT bins, Detector detector);
+
+    // Reduces `size' values to `bins' (bins <= size) as prepare() does,
+    // on whatever units they come in
+    static void decimate(
+        const SUFLOAT *data,
+        SUSCOUNT size,
+        SUFLOAT *out,
+        SUSCOUNT bins,
+        Detector detector);
+
     PSDMessage();
     PSDMessage(struct suscan_analyzer_psd_msg *msg);
   };
@@ -20,9 +20,30 @@
 #define APPLICATIONUI_H
 
 #include <QMainWindow>
+#include <QElapsedTimer>
 #include <Suscan/Messages/PSDMessage.h>
 #include <map>
+#include <memory>
 #include <AppConfig.h>
+#include "WaterfallHistory.h"
+#include "PeakTracker.h"
+#include "NoiseFloor.h"
+#include "BandMeter.h"
+#include "Occupancy.h"
+#include "ReferenceTrace.h"
+#include "AlertEngine.h"
+#include "AlertNotifier.h"
+#include "BookmarkStore.h"
+#include "ZoomSpectrum.h"
+#include "FftGovernor.h"
+#include "SpectrumRecorder.h"
+#include "SpectrumPlayer.h"
+#include "SnapshotExporter.h"
+
+// Ranges set by "Auto", relative to the noise floor (dB)
+#define SIGDIGGER_AUTO_RANGE_BELOW     10
+#define SIGDIGGER_AUTO_RANGE_PAND      60
+#define SIGDIGGER_AUTO_RANGE_WF        40
 
 namespace SigDigger {
 
@@ -50,7 +71,33 @@ namespace SigDigger {
     QDockWidget *audioPanelDock = nullptr;
 
     // UI Data
-    Averager averager;
+    Averager averager;         // Full resolution, for the analysis
+    Averager displayAverager;  // Decimated, for the spectrum only
+    std::unique_ptr<WaterfallHistory> history;
+    std::unique_ptr<SpectrumRecorder> spectrumLog;
+    SpectrumPlayer player;
+    SnapshotExporter snapshotExporter;
+    PeakTracker peakTracker;
+    NoiseFloor noiseFloor;
+    BandMeter bandMeter;
+    Occupancy occupancy;
+    ReferenceTrace reference;
+    std::vector<float> displayDiff; // Never shrunk: it may be on screen
+    AlertEngine alerts;
+    AlertNotifier notifier;
+    bool alertRecordRaised = false;
+    bool alertRecording = false;
+    BookmarkStore bookmarks;
+    ZoomSpectrum zoomSpectrum;
+    unsigned int zoomSpan = 0;
+    FftGovernor governor;
+    Suscan::AnalyzerParams effectiveParams;
+    bool autoFft = false;
+    QElapsedTimer governorClock;
+    qint64 feedNs = 0;        // Spent in feedPSD since the last evaluation
+    qint64 lastRenderNs = 0;
+    unsigned int processRate = 0;
+    unsigned int backlog = 0;
     unsigned int rate = 0;
     unsigned int recentCount = 0;
 
@@ -72,6 +119,11 @@ namespace SigDigger {
     void setSampleRate(unsigned int rate);
     void setBandwidth(unsigned int bandwidth);
     void refreshProfile(void);
+    void applyAlertSettings(void);
+    void feedAlerts(const Suscan::PSDMessage &msg);
+    static QString getBookmarksPath(void);
+    void updateZoomSpectrum(void);
+    void updateGovernor(void);
 
     void setCurrentAutoGain(void);
     static QString getInspectorTabTitle(Suscan::InspectorMessage const &msg);
@@ -88,7 +140,9 @@ namespace SigDigger {
 
     // Data methods
     void setProcessRate(unsigned int rate);
+    void setMessageBacklog(unsigned int pending);
     void feedPSD(const Suscan::PSDMessage &msg);
+    void feedZoomSpectrum(const float *power, size_t size, unsigned int rate);
     void setCaptureSize(quint64 size);
     void refreshDevicesDone(void);
 
@@ -103,7 +157,15 @@ namespace SigDigger {
     // Convenience getters
     Suscan::Source::Config *getProfile(void) const;
     Suscan::AnalyzerParams *getAnalyzerParams(void) const;
+
+    // The configured ones, with the FFT size and refresh rate picked by
+    // the governor in Auto mode. This is what the analyzer should get.
+    Suscan::AnalyzerParams *getEffectiveParams(void);
     unsigned int getFftSize(void) const;
+    std::vector<unsigned int> const &getFftSizes(void) const;
+
+    // Bandwidth of the zoom spectrum channel wanted now, 0 for none
+    unsigned int getZoomSpectrumSpan(void) const;
 
     // Mediated setters
     void setRecordState(bool state);
@@ -147,6 +209,11 @@ namespace SigDigger {
     void recentSelected(QString);
     void recentCleared(void);
     void audioChanged(void);
+    void toggleAudioRecord(void);
+    void pinAudioChannel(void);
+    void audioChannelsChanged(void);
+    void audioMixChanged(void);
+    void zoomSpectrumChanged(void);
 
   public slots:
     // Main Window slots
@@ -159,6 +226,12 @@ namespace SigDigger {
     void onTriggerImport(bool);
     void onTriggerExport(bool);
     void onTriggerDevices(bool);
+    void onTriggerBandMeters(bool);
+    void onTriggerOccupancy(bool);
+    void onTriggerReference(bool);
+    void onTriggerSnapshot(bool);
+    void onTriggerAlerts(bool);
+    void onTriggerBookmarks(bool);
     void onTriggerQuit(bool);
     void onTriggerClear(bool);
     void onTriggerRecent(bool);
@@ -169,6 +242,14 @@ namespace SigDigger {
     void onLoChanged(qint64);
     void onRangeChanged(float, float);
     void onZoomChanged(float);
+    void onAddBandMeter(void);
+    void onBandMetersChanged(void);
+    void onAddAlertRule(void);
+    void onAlertRulesChanged(void);
+    void onAlertSettingsChanged(void);
+    void onAddBookmark(QString name);
+    void onBookmarksChanged(void);
+    void onTuneBookmark(qint64 freq);
 
     // Source panel
     void onToggleRecord(void);
@@ -184,13 +265,36 @@ namespace SigDigger {
     void onPaletteChanged(void);
     void onRangesChanged(void);
     void onAveragerChanged(void);
+    void onPersistenceChanged(void);
+    void onZoomSpectrumChanged(void);
+    void onAutoFftChanged(void);
     void onFftSizeChanged(void);
     void onWindowFunctionChanged(void);
     void onRefreshRateChanged(void);
     void onTimeSpanChanged(void);
+    void onHistoryChanged(void);
+    void onBrowseHistory(void);
+    void onSpectrumLogChanged(void);
+    void onSpectrumLogStopped(void);
+    void onReplayChanged(void);
+    void onReplayFrame(
+        float *data,
+        int size,
+        qint64 fc,
+        unsigned int rate,
+        qint64 timestamp);
+    void onReplayFinished(void);
+    void onSnapshotFinished(QString path, QString error);
+    void onTrackPeaks(void);
+    void onAutoRange(void);
+    void onTunePeak(qint64 freq);
 
     // Audio panel
     void onAudioChanged(void);
+    void onToggleAudioRecord(void);
+    void onPinAudioChannel(void);
+    void onAudioChannelsChanged(void);
+    void onAudioMixChanged(void);
 
     // Inspector
     void onInspBandwidthChanged(void);
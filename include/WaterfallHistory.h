@@ -0,0 +1,281 @@
+//
+//    WaterfallHistory.h: Disk-backed waterfall history
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+#ifndef WATERFALLHISTORY_H
+#define WATERFALLHISTORY_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+#define SIGDIGGER_HISTORY_MAGIC       0x48465753 // "SWFH"
+#define SIGDIGGER_HISTORY_VERSION     2
+
+// Bins per stored row, over the full sample rate
+#define SIGDIGGER_HISTORY_WIDTH       2048
+
+// Quantization range. 256 levels over 200 dB gives ~0.8 dB steps
+#define SIGDIGGER_HISTORY_DB_MIN      -160.f
+#define SIGDIGGER_HISTORY_DB_MAX      40.f
+
+#define SIGDIGGER_HISTORY_HEADER_SIZE 4096
+
+// Detail levels, including the full resolution one. Level k reduces
+// blocks of 2^k rows by 2^k bins.
+#define SIGDIGGER_HISTORY_MAX_LEVELS  8
+#define SIGDIGGER_HISTORY_MIN_BINS    16
+
+namespace SigDigger {
+  struct WaterfallHistoryHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t width;
+    uint32_t rowSize;
+    uint64_t capacity;  // Rows in the ring
+    uint64_t written;   // Rows ever written. Row n lives in slot n % capacity
+    float    dbMin;
+    float    dbMax;
+    uint32_t levels;
+    uint32_t reserved;
+  };
+
+  struct WaterfallHistoryRow {
+    int64_t  timestamp; // Microseconds since the epoch
+    int64_t  fc;        // Center frequency (Hz)
+    uint32_t rate;      // Sample rate (sps)
+    uint32_t reserved;
+
+    // Followed by `width' bins of quantized dB, DC centered. In reduced
+    // levels these are the block maxima, followed by the block means.
+    const uint8_t *
+    getData(void) const
+    {
+      return reinterpret_cast<const uint8_t *>(this + 1);
+    }
+  };
+
+  struct WaterfallHistoryLevel {
+    size_t offset;      // Of the first slot, from the start of the file
+    size_t rowSize;
+    uint64_t capacity;
+    unsigned int width;
+  };
+
+  class WaterfallHistory;
+
+  //
+  // Full resolution rows [begin, end) of a history, as they were when the
+  // snapshot was taken, readable from any thread. Nothing is copied up
+  // front: rows are read from the ring until the history is about to
+  // overwrite them, or goes away, and only then are they copied into the
+  // snapshot. It must be destroyed in the thread that appends rows.
+  //
+  class WaterfallHistorySnapshot {
+      std::mutex mutex;
+      WaterfallHistory *history; // Null once detached
+      uint64_t begin;
+      uint64_t end;
+      unsigned int width;
+      float dbMin;
+      float dbMax;
+      std::map<uint64_t, std::vector<uint8_t>> saved;
+
+      // With the history about to overwrite it
+      void keep(uint64_t seq, const WaterfallHistoryRow *row);
+      void detach(void);
+
+      WaterfallHistorySnapshot(
+          WaterfallHistory *history,
+          uint64_t begin,
+          uint64_t end);
+
+      friend class WaterfallHistory;
+
+    public:
+      ~WaterfallHistorySnapshot();
+
+      // Row `seq' in dB (`width' floats) and its metadata. False if the
+      // row is outside the snapshot.
+      bool read(uint64_t seq, float *db, WaterfallHistoryRow &info);
+
+      uint64_t
+      getBegin(void) const
+      {
+        return this->begin;
+      }
+
+      uint64_t
+      getEnd(void) const
+      {
+        return this->end;
+      }
+
+      unsigned int
+      getWidth(void) const
+      {
+        return this->width;
+      }
+  };
+
+  //
+  // Ring of quantized waterfall rows in a memory-mapped file. Rows are
+  // addressed by their sequence number, which keeps growing across
+  // sessions; only the last `capacity' of them are kept. Reading a row
+  // only touches the pages it lives in, so the history can be much larger
+  // than the available RAM.
+  //
+  // Next to the full resolution ring, the file keeps a pyramid of reduced
+  // levels, each one with its own ring. Row m of level k holds the max and
+  // mean of rows [m * 2^k, (m + 1) * 2^k) in blocks of 2^k bins, and is
+  // built from two rows of level k - 1 as soon as the second one arrives.
+  // Painting any time span then reads at most as many rows as there are
+  // pixels, from the level that fits it.
+  //
+  class WaterfallHistory {
+      int fd = -1;
+      uint8_t *map = nullptr;
+      size_t mapSize = 0;
+      WaterfallHistoryHeader *header = nullptr;
+      std::atomic<uint64_t> written{0}; // Published copy of header->written
+      std::vector<float> line;
+      std::vector<WaterfallHistoryLevel> levels;
+      std::vector<WaterfallHistorySnapshot *> snapshots;
+
+      static size_t layout(
+          uint64_t capacity,
+          std::vector<WaterfallHistoryLevel> &levels);
+
+      bool attach(uint64_t capacity);
+      void format(uint64_t capacity);
+
+      WaterfallHistoryRow *
+      slot(unsigned int level, uint64_t seq) const
+      {
+        WaterfallHistoryLevel const &l = this->levels[level];
+        return reinterpret_cast<WaterfallHistoryRow *>(
+              this->map + l.offset + (seq % l.capacity) * l.rowSize);
+      }
+
+      void reduce(unsigned int level, uint64_t seq);
+
+      friend class WaterfallHistorySnapshot;
+
+    public:
+      WaterfallHistory(std::string const &path, uint64_t capacity);
+      ~WaterfallHistory();
+
+      static uint64_t capacityFor(uint64_t bytes);
+
+      void append(
+          const float *psd,
+          size_t size,
+          int64_t fc,
+          unsigned int rate,
+          int64_t timestamp);
+
+      // Oldest row still available
+      uint64_t
+      getFirst(unsigned int level = 0) const
+      {
+        uint64_t end = this->getEnd(level);
+        uint64_t capacity = this->levels[level].capacity;
+
+        return end > capacity ? end - capacity : 0;
+      }
+
+      // One past the newest row. A reduced row exists once its whole
+      // block of full resolution rows has been written.
+      uint64_t
+      getEnd(unsigned int level = 0) const
+      {
+        return this->written.load(std::memory_order_acquire) >> level;
+      }
+
+      unsigned int
+      getWidth(unsigned int level = 0) const
+      {
+        return this->levels[level].width;
+      }
+
+      unsigned int
+      getLevels(void) const
+      {
+        return static_cast<unsigned int>(this->levels.size());
+      }
+
+      const uint8_t *
+      getMean(unsigned int level, const WaterfallHistoryRow *row) const
+      {
+        return level == 0
+            ? row->getData()
+            : row->getData() + this->levels[level].width;
+      }
+
+      float
+      getDbMin(void) const
+      {
+        return this->header->dbMin;
+      }
+
+      float
+      getDbMax(void) const
+      {
+        return this->header->dbMax;
+      }
+
+      // Returns nullptr if the row is not (or no longer) in the ring. Only
+      // for the thread that appends rows.
+      const WaterfallHistoryRow *getRow(
+          uint64_t seq,
+          unsigned int level = 0) const;
+
+      // Copies row `seq' of `level' (header and getRowSize() bytes of data)
+      // from any other thread. The oldest row of a level is the next one to
+      // be overwritten, so rows are checked again once copied and false is
+      // returned if they might have been overwritten meanwhile.
+      bool readRow(
+          uint64_t seq,
+          unsigned int level,
+          WaterfallHistoryRow &info,
+          uint8_t *data) const;
+
+      // Data bytes of a row of `level' (max and mean in reduced levels)
+      size_t
+      getRowSize(unsigned int level = 0) const
+      {
+        return this->levels[level].rowSize - sizeof(WaterfallHistoryRow);
+      }
+
+      // Copy-on-write view of the full resolution rows [begin, end),
+      // clipped to the ones still in the ring
+      std::unique_ptr<WaterfallHistorySnapshot> snapshot(
+          uint64_t begin,
+          uint64_t end);
+
+      // First full resolution row no older than `timestamp', or getEnd()
+      uint64_t findRow(int64_t timestamp) const;
+  };
+}
+
+#endif // WATERFALLHISTORY_H
@@ -0,0 +1,128 @@
+//
+//    WaterfallHistoryView.h: Waterfall history viewer
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+#ifndef WATERFALLHISTORYVIEW_H
+#define WATERFALLHISTORYVIEW_H
+
+#include <QFrame>
+#include <QDialog>
+#include <QTimer>
+
+#include "WaterfallHistory.h"
+#include "Palette.h"
+#include "WaterfallTileCache.h"
+
+// Rows between time marks
+#define SIGDIGGER_HISTORY_VIEW_TICK_ROWS   64
+
+// How often the dialog picks up new rows (ms)
+#define SIGDIGGER_HISTORY_VIEW_REFRESH_MS  250
+
+namespace Ui {
+  class WaterfallHistoryDialog;
+}
+
+namespace SigDigger {
+  //
+  // Paints the rows of a WaterfallHistory, newest on top, starting from
+  // an arbitrary row. Only the rows that fit in the widget are read. At
+  // detail level k, every pixel row is a block of 2^k history rows. Rows
+  // are rasterized into tiles by a worker thread; painting only blits them.
+  //
+  class WaterfallHistoryView : public QFrame
+  {
+    Q_OBJECT
+
+    WaterfallHistory *history = nullptr; // Weak
+    Palette palette;
+    float rangeMin = -60;
+    float rangeMax = -10;
+    QRgb lut[256];
+    quint64 top = 0;
+    unsigned int level = 0;
+    bool mean = false;
+    WaterfallTileCache *tiles = nullptr;
+
+    quint64 levelTop(void) const;
+    void updateLut(void);
+
+  protected:
+    void paintEvent(QPaintEvent *) override;
+    void mouseMoveEvent(QMouseEvent *) override;
+
+  public:
+    explicit WaterfallHistoryView(QWidget *parent = nullptr);
+
+    void setHistory(WaterfallHistory *history);
+    void setColorPalette(Palette const &palette);
+    void setRange(float min, float max);
+    void setTop(quint64 seq);
+    void setLevel(unsigned int level);
+    void setMean(bool mean);
+
+    quint64
+    getTop(void) const
+    {
+      return this->top;
+    }
+
+    unsigned int
+    getLevel(void) const
+    {
+      return this->level;
+    }
+
+  signals:
+    // x is relative to the width, from 0 to 1. seq is a row of the
+    // current level.
+    void rowHovered(quint64 seq, qreal x);
+  };
+
+  class WaterfallHistoryDialog : public QDialog
+  {
+    Q_OBJECT
+
+    WaterfallHistory *history = nullptr; // Weak
+    QTimer *refreshTimer = nullptr;
+
+    void connectAll(void);
+    void refreshLevels(void);
+    void refreshScrollBar(void);
+
+  public:
+    explicit WaterfallHistoryDialog(QWidget *parent = nullptr);
+    ~WaterfallHistoryDialog() override;
+
+    void setHistory(WaterfallHistory *history);
+    void setColorPalette(Palette const &palette);
+    void setRange(float min, float max);
+
+  public slots:
+    void onRefresh(void);
+    void onScroll(int);
+    void onFollowToggled(void);
+    void onZoomChanged(void);
+    void onRowHovered(quint64 seq, qreal x);
+
+  private:
+    Ui::WaterfallHistoryDialog *ui = nullptr;
+  };
+}
+
+#endif // WATERFALLHISTORYVIEW_H
@@ -0,0 +1,142 @@
+//
+//    WaterfallTileCache.h: Threaded waterfall history rasterizer
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+#ifndef WATERFALLTILECACHE_H
+#define WATERFALLTILECACHE_H
+
+#include <QObject>
+#include <QThread>
+#include <QMutex>
+#include <QImage>
+#include <vector>
+
+#include "WaterfallHistory.h"
+
+// History rows per tile
+#define SIGDIGGER_TILE_ROWS   64
+
+// Tiles in the ring. Must exceed the tiles a view shows at once (34 for a
+// 2160 pixel high view)
+#define SIGDIGGER_TILE_COUNT  48
+
+namespace SigDigger {
+  class WaterfallTileCache;
+
+  struct WaterfallTile {
+    enum State {
+      FREE,
+      RENDERING,
+      READY
+    };
+
+    QImage image;
+    State state = FREE;
+    unsigned int level = 0;
+    quint64 index = 0;       // Covers rows [index, index + 1) * TILE_ROWS
+    unsigned int rows = 0;   // Rows of the tile that were available
+    unsigned int generation = 0;
+    quint64 lastUsed = 0;
+  };
+
+  class WaterfallTileWorker : public QObject {
+      Q_OBJECT
+
+      WaterfallTileCache *instance;
+      std::vector<uint8_t> peaks;   // Of every pixel column
+      std::vector<uint8_t> row;
+
+      void render(
+          WaterfallTile &tile,
+          const QRgb *lut,
+          bool mean,
+          unsigned int width);
+
+    public:
+      WaterfallTileWorker(WaterfallTileCache *instance);
+
+    public slots:
+      void onWake(void);
+  };
+
+  //
+  // Ring of preallocated image strips of the waterfall history, drawn
+  // by a worker thread. The GUI thread looks tiles up and blits them while
+  // holding the lock; whatever it did not find is queued and shows up in
+  // a later paint, once tileReady() is emitted. Everything that changes
+  // the pixels of a tile (width, colors, mean / peak) bumps the generation,
+  // so outdated tiles are never drawn and get reused first.
+  //
+  class WaterfallTileCache : public QObject
+  {
+      Q_OBJECT
+
+      struct Request {
+        unsigned int level;
+        quint64 index;
+        unsigned int rows;
+      };
+
+      // Protected by mutex
+      QMutex mutex;
+      std::vector<WaterfallTile> tiles;
+      std::vector<Request> queue;
+      unsigned int generation = 0;
+      unsigned int width = 0;
+      QRgb lut[256];
+      bool mean = false;
+      quint64 frame = 0;
+
+      // Held while a tile is being drawn from the history
+      QMutex renderMutex;
+      WaterfallHistory *history = nullptr; // Weak
+
+      QThread workerThread;
+      WaterfallTileWorker workerObject;
+
+      void invalidate(void);
+
+    public:
+      explicit WaterfallTileCache(QObject *parent = nullptr);
+      ~WaterfallTileCache() override;
+
+      void setHistory(WaterfallHistory *history);
+      void setLut(const QRgb *lut);
+      void setMean(bool mean);
+
+      //
+      // Called from paint. Blits the tiles of `level' that are ready, with
+      // row `top' on the first line, and queues the missing or outdated
+      // ones for the worker.
+      //
+      void draw(
+          QPainter &painter,
+          int width,
+          int height,
+          unsigned int level,
+          quint64 top);
+
+      friend class WaterfallTileWorker;
+
+    signals:
+      void wake(void);
+      void tileReady(void);
+  };
+}
+
+#endif // WATERFALLTILECACHE_H
@@ -0,0 +1,70 @@
+//
+//    ZoomSpectrum.h: High resolution spectrum of the visible span
+//    Copyright (C) 2019 Gonzalo José Carracedo Carballal
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU Lesser General Public License as
+//    published by the Free Software Foundation, either version 3 of the
+//    License, or (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful, but
+//    WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this program.  If not, see
+//    <http://www.gnu.org/licenses/>
+//
+
+#ifndef ZOOMSPECTRUM_H
+#define ZOOMSPECTRUM_H
+
+#include <vector>
+#include <cstddef>
+
+// Zoom levels below this keep using the full-span PSD
+#define SIGDIGGER_ZOOM_SPECTRUM_MIN_ZOOM 2
+
+namespace SigDigger {
+  //
+  // Spectrum of a channel centered on the tuner frequency and as wide as
+  // the visible span. The analyzer mixes it down, decimates it and takes
+  // its FFT, so the bins are spent on what is on screen only. Frames
+  // come in linear power with DC first, and are kept in dB with the
+  // lowest frequency first, like the full-span PSD.
+  //
+  class ZoomSpectrum {
+      std::vector<float> psd;
+      unsigned int rate = 0;
+
+    public:
+      // Channel bandwidth for this zoom level, 0 for the full span
+      static unsigned int getSpan(unsigned int sampleRate, unsigned int zoom);
+
+      void feed(const float *power, size_t size, unsigned int rate);
+      void reset(void);
+
+      // Valid until the next feed
+      float *
+      get(void)
+      {
+        return this->psd.data();
+      }
+
+      size_t
+      size(void) const
+      {
+        return this->psd.size();
+      }
+
+      // Width covered by the last frame (Hz)
+      unsigned int
+      getRate(void) const
+      {
+        return this->rate;
+      }
+  };
+}
+
+#endif // ZOOMSPECTRUM_H